@@ -7,6 +7,7 @@ global_flag_b_build=0
 global_flag_r_rebuild=0
 global_flag_e_execute=0
 global_flag_v_verbose=0
+global_flag_p_pgo=0
 global_value_target=""
 
 #################################################################################
@@ -28,6 +29,7 @@ function print_help()
     -r, --rebuild       [r]euild
     -e, --execute       [e]xecute
     -v, --verbose       [v]erbose
+    -p, --pgo           [p]rofile-guided build of the benchmarks, trained by the benchmarks
 
     targets:
      <target> is a positional argument. Either "app" of "test"
@@ -124,6 +126,35 @@ function func_rebuild()
 
 ################################################################################
 
+#
+# Profile-guided optimization with the CMake presets: instrumented build, training runs of the
+# benchmarks, optimized build, then the dispatch benchmarks of the LTO-only and the PGO builds
+#
+function func_pgo()
+{
+    print_banner "Building with profile-guided optimization"
+
+    rm -rf build/pgo-profiles
+    cmake --preset pgo-generate
+    cmake --build --preset pgo-generate --parallel `nproc`
+    ctest --preset pgo-train
+    if ls build/pgo-profiles/*.profraw > /dev/null 2>&1; then
+        llvm-profdata merge -o build/pgo-profiles/default.profdata build/pgo-profiles/*.profraw
+    fi
+    cmake --preset pgo-use
+    cmake --build --preset pgo-use --parallel `nproc`
+    cmake --preset release-lto
+    cmake --build --preset release-lto --parallel `nproc`
+
+    for preset in release-lto pgo-use; do
+        print_header "$preset"
+        ./build/$preset/benchHierarchy
+        ./build/$preset/benchInlineEvent
+    done
+}
+
+################################################################################
+
 #
 # Execute the binary
 #
@@ -167,6 +198,10 @@ function gather_params()
                 global_flag_v_verbose=1
                 shift
                 ;;
+            -p | --pgo)
+                global_flag_p_pgo=1
+                shift
+                ;;
             -h | --help)
                 print_help
                 exit
@@ -180,7 +215,7 @@ function gather_params()
 
     # Allow only format or static analysis without specifying <target>
     #if [ global_flag_f_format -eq 0 ] && [ global_flag_s_format -eq 0 ]; then
-    if [ "$global_flag_f_format" -eq 0 ] && [ "$global_flag_s_format" -eq 0 ]; then
+    if [ "$global_flag_f_format" -eq 0 ] && [ "$global_flag_s_format" -eq 0 ] && [ "$global_flag_p_pgo" -eq 0 ]; then
         if [[ -z "$global_value_target" ]]; then
             echo "Please, define a <target>"
             print_help
@@ -208,6 +243,9 @@ function execute_logic()
     if [[ global_flag_r_rebuild -eq 1 ]]; then
         func_rebuild "$global_value_target"
     fi
+    if [[ global_flag_p_pgo -eq 1 ]]; then
+        func_pgo
+    fi
     if [[ global_flag_e_execute -eq 1 ]]; then
         func_execute
     fi
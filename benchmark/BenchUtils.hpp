@@ -0,0 +1,47 @@
+#ifndef __BENCHUTILS_H_
+#define __BENCHUTILS_H_
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <malloc.h>
+#include <unistd.h>
+
+namespace Bench
+{
+using Clock = std::chrono::steady_clock;
+
+inline double elapsedNs(Clock::time_point since)
+{
+    return std::chrono::duration<double, std::nano>(Clock::now() - since).count();
+}
+
+// Resident and virtual memory of the whole process (from /proc/self/statm) and heap in use, in bytes
+struct Memory
+{
+    long resident{0};
+    long virt{0};
+    long heap{0};
+};
+
+inline Memory memory()
+{
+    Memory        result;
+    long          pages_virt = 0, pages_resident = 0;
+    std::ifstream statm("/proc/self/statm");
+    statm >> pages_virt >> pages_resident;
+    result.resident = pages_resident * sysconf(_SC_PAGESIZE);
+    result.virt     = pages_virt * sysconf(_SC_PAGESIZE);
+    result.heap     = static_cast<long>(mallinfo2().uordblks);
+    return result;
+}
+
+inline void report(const std::string& name, double value, const std::string& unit)
+{
+    std::printf("%-60s %14.1f %s\n", name.c_str(), value, unit.c_str());
+}
+}  // namespace Bench
+
+#endif
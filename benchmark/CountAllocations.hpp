@@ -0,0 +1,35 @@
+#ifndef __COUNTALLOCATIONS_H_
+#define __COUNTALLOCATIONS_H_
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+/**
+ * Replaces the global operator new/delete to count heap allocations.
+ * Include it in one translation unit of a benchmark executable only
+ */
+namespace Bench
+{
+inline std::atomic<long> allocations{0};
+}  // namespace Bench
+
+void* operator new(std::size_t size)
+{
+    Bench::allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+#endif
@@ -0,0 +1,115 @@
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "ActorRegistry/ActorRegistry.hpp"
+#include "BenchUtils.hpp"
+
+/**
+ * Lookup + post throughput with many registered actors and many posting threads: ActorRegistry
+ * versus the straightforward alternative, a map from id to mailbox behind a mutex.
+ * The mailboxes only count events, so the measure is dominated by addressing
+ */
+
+class Ping : public IEvent
+{
+};
+
+struct alignas(64) Counter
+{
+    std::atomic<long> value{0};
+};
+
+class MutexRegistry
+{
+   public:
+    uint64_t add(SignatureIEvent mailbox)
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        m_mailboxes[++m_next] = std::move(mailbox);
+        return m_next;
+    }
+    bool post(uint64_t id, IEvent_ptr event)
+    {
+        SignatureIEvent mailbox;
+        {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+            auto                         found = m_mailboxes.find(id);
+            if (found == m_mailboxes.end())
+                return false;
+            mailbox = found->second;
+        }
+        mailbox(std::move(event));
+        return true;
+    }
+
+   private:
+    std::mutex                                    m_mutex;
+    std::unordered_map<uint64_t, SignatureIEvent> m_mailboxes;
+    uint64_t                                      m_next{0};
+};
+
+template <class Registry, class Id>
+double throughput(Registry& registry, const std::vector<Id>& ids, int threads, long posts)
+{
+    std::atomic_bool         go{false};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++)
+    {
+        workers.emplace_back(
+            [&, t]()
+            {
+                auto                               event = std::make_shared<Ping>();
+                std::minstd_rand                   random(t + 1);
+                std::uniform_int_distribution<int> pick(0, int(ids.size()) - 1);
+                while (!go)
+                    std::this_thread::yield();
+                for (long i = 0; i < posts; i++)
+                    registry.post(ids[pick(random)], event);
+            });
+    }
+    auto begin = Bench::Clock::now();
+    go         = true;
+    for (auto& worker : workers)
+        worker.join();
+    return double(posts) * threads / (Bench::elapsedNs(begin) / 1e9);
+}
+
+int main(int argc, char** argv)
+{
+    int  actors  = (argc > 1) ? std::atoi(argv[1]) : 100000;
+    int  threads = (argc > 2) ? std::atoi(argv[2]) : 16;
+    long posts   = (argc > 3) ? std::atol(argv[3]) : 1000000;
+
+    std::vector<Counter> counters(actors);
+    {
+        ActorRegistry        registry;
+        std::vector<ActorId> ids;
+        for (int i = 0; i < actors; i++)
+        {
+            Counter* counter = &counters[i];
+            ids.push_back(registry.add([counter](IEvent_ptr)
+                                       { counter->value.fetch_add(1, std::memory_order_relaxed); }));
+        }
+        Bench::report("ActorRegistry: lookup+post throughput",
+                      throughput(registry, ids, threads, posts) / 1e6, "M/s");
+    }
+    {
+        MutexRegistry         registry;
+        std::vector<uint64_t> ids;
+        for (int i = 0; i < actors; i++)
+        {
+            Counter* counter = &counters[i];
+            ids.push_back(registry.add([counter](IEvent_ptr)
+                                       { counter->value.fetch_add(1, std::memory_order_relaxed); }));
+        }
+        Bench::report("mutex + unordered_map: lookup+post throughput",
+                      throughput(registry, ids, threads, posts) / 1e6, "M/s");
+    }
+    return 0;
+}
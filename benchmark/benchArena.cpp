@@ -0,0 +1,115 @@
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "Arena/ActorArena.hpp"
+#include "Arena/CountGlobalAllocations.hpp"
+#include "BenchUtils.hpp"
+#include "StateManager/StateManager.hpp"
+#include "ThreadSafeQueue/SpscChannel.hpp"
+
+/**
+ * Cost of creating events on one actor and releasing them on another: std::make_shared against
+ * ActorArena::make, whose blocks come back through the remote-free list. The channel between the
+ * two is a preallocated ring, so the heap allocations reported per event are those of the events
+ * alone. Also reports the heap allocations per StateManager transition, which should be zero
+ */
+
+class Reading : public IEvent
+{
+   public:
+    explicit Reading(uint64_t sensor) : sensor{sensor}
+    {
+    }
+    uint64_t sensor;
+    double   value{0};
+};
+
+template <class Make>
+void measure(const std::string& name, int events, Make make)
+{
+    SpscChannel<IEvent_ptr> channel(1024);
+    std::thread             consumer(
+        [&]()
+        {
+            IEvent_ptr event;
+            for (int i = 0; i < events; i++)
+            {
+                while (!channel.try_pop(event))
+                    std::this_thread::yield();
+                event.reset();  // The last reference, released on the consumer thread
+            }
+        });
+
+    Allocation::Span span;
+    auto             begin = Bench::Clock::now();
+    for (int i = 0; i < events; i++)
+        channel.push(make(i));
+    consumer.join();
+    double elapsed = Bench::elapsedNs(begin);
+    Bench::report(name + ": ns per event", elapsed / events, "ns");
+    Bench::report(name + ": heap allocations per event",
+                  double(span.elapsed().allocations) / events, "");
+}
+
+class NopState
+{
+   public:
+    int on_entry()
+    {
+        return 0;
+    }
+    int on_exit()
+    {
+        return 0;
+    }
+    int process_event(IEvent_ptr)
+    {
+        return -1;
+    }
+};
+using NopState_ptr = std::shared_ptr<NopState>;
+
+void measureTransitions(int transitions)
+{
+    // root -> a -> a1 -> a11, root -> b -> b1 -> b11
+    tree<NopState_ptr> states;
+    auto root = states.set_head(std::make_shared<NopState>());
+    auto a    = states.append_child(root, std::make_shared<NopState>());
+    auto a11  = states.append_child(states.append_child(a, std::make_shared<NopState>()),
+                                    std::make_shared<NopState>());
+    auto b    = states.append_child(root, std::make_shared<NopState>());
+    auto b11  = states.append_child(states.append_child(b, std::make_shared<NopState>()),
+                                    std::make_shared<NopState>());
+    StateManager<NopState_ptr> sm(std::move(states), a11);
+    sm.init();
+
+    Allocation::Span span;
+    auto             begin = Bench::Clock::now();
+    for (int i = 0; i < transitions; i += 2)
+    {
+        sm.transitionTo(b11);
+        sm.transitionTo(a11);
+    }
+    double elapsed = Bench::elapsedNs(begin);
+    Bench::report("transitionTo across 3 levels: ns per transition", elapsed / transitions, "ns");
+    Bench::report("transitionTo across 3 levels: heap allocations per transition",
+                  double(span.elapsed().allocations) / transitions, "");
+}
+
+int main(int argc, char** argv)
+{
+    int events = (argc > 1) ? std::atoi(argv[1]) : 1000000;
+
+    measure("make_shared", events, [](int i) { return std::make_shared<Reading>(i); });
+
+    ActorArena arena;
+    measure("ActorArena::make", events, [&](int i) { return arena.make<Reading>(i); });
+    auto stats = arena.stats();
+    Bench::report("ActorArena::make: blocks freed remotely", double(stats.remote_frees), "");
+    Bench::report("ActorArena::make: heap requests", double(stats.heap), "");
+
+    measureTransitions(events);
+    return 0;
+}
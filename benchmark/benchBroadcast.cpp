@@ -0,0 +1,78 @@
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "BenchUtils.hpp"
+#include "CountAllocations.hpp"
+#include "Broadcast/Broadcast.hpp"
+#include "ThreadSafeQueue/ThreadSafeQueue.hpp"
+
+/**
+ * Fan-out of one event to many actors' mailboxes: a SignalIEvent with one slot per recipient
+ * putting into its SimplestThreadSafeQueue, versus broadcast() into LockFreeMailboxes.
+ * Reports the cost of one fan-out and the number of allocations it makes
+ */
+
+class Tick : public IEvent
+{
+};
+
+template <class Fanout, class Drain>
+void measure(const char* name, int rounds, Fanout&& fanout, Drain&& drain)
+{
+    double elapsed   = 0;
+    long   allocated = 0;
+    for (int r = 0; r < rounds; r++)
+    {
+        auto event  = std::make_shared<Tick>();
+        long before = Bench::allocations.load();
+        auto begin  = Bench::Clock::now();
+        fanout(event);
+        elapsed += Bench::elapsedNs(begin);
+        allocated += Bench::allocations.load() - before;
+        drain();
+    }
+    std::string prefix(name);
+    Bench::report(prefix + ": duration of one fan-out", elapsed / rounds, "ns");
+    Bench::report(prefix + ": allocations per fan-out", double(allocated) / rounds, "");
+}
+
+int main(int argc, char** argv)
+{
+    int recipients = (argc > 1) ? std::atoi(argv[1]) : 1000;
+    int rounds     = (argc > 2) ? std::atoi(argv[2]) : 1000;
+
+    {
+        std::vector<std::unique_ptr<SimplestThreadSafeQueue<IEvent_ptr>>> queues;
+        SignalIEvent                                                      signal;
+        for (int i = 0; i < recipients; i++)
+        {
+            queues.emplace_back(std::make_unique<SimplestThreadSafeQueue<IEvent_ptr>>());
+            auto* queue = queues.back().get();
+            signal.connect([queue](IEvent_ptr event) { queue->put(event); });
+        }
+        measure(
+            "SignalIEvent + SimplestThreadSafeQueue", rounds,
+            [&](const IEvent_ptr& event) { signal(event); },
+            [&]()
+            {
+                for (auto& queue : queues)
+                    queue->wait_and_pop();
+            });
+    }
+    {
+        std::vector<LockFreeMailbox>  mailboxes(recipients);
+        std::vector<LockFreeMailbox*> pointers;
+        for (auto& mailbox : mailboxes)
+            pointers.push_back(&mailbox);
+        measure(
+            "broadcast + LockFreeMailbox", rounds,
+            [&](const IEvent_ptr& event) { broadcast(event, pointers); },
+            [&]()
+            {
+                for (auto& mailbox : mailboxes)
+                    mailbox.wait_and_pop();
+            });
+    }
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BenchUtils.hpp"
+#include "ThreadSafeQueue/PaddedThreadSafeQueue.hpp"
+#include "ThreadSafeQueue/ThreadSafeQueue.hpp"
+
+/**
+ * Many producers put() into one actor's queue while its thread pops, and an observer keeps
+ * polling size() as a load-balancing router would: SimplestThreadSafeQueue, whose mutex, size
+ * and condition variable share cache lines, versus PaddedThreadSafeQueue. Reports the time per
+ * event. Cache line transfers between cores show up as HITM records with
+ *   perf c2c record -- benchContention [producers] [events per producer]
+ *   perf c2c report --stdio
+ * (on a single core there is no false sharing to see)
+ */
+
+template <class Queue>
+void measure(const char* name, int producers, int events)
+{
+    Queue                    queue;
+    std::atomic_bool         done{false};
+    std::vector<std::thread> threads;
+
+    auto        begin = Bench::Clock::now();
+    std::thread observer(
+        [&]()
+        {
+            std::size_t longest = 0;
+            while (!done.load(std::memory_order_relaxed))
+                longest = std::max(longest, queue.size());
+            Bench::report(std::string(name) + ": longest queue seen", double(longest), "");
+        });
+    for (int p = 0; p < producers; p++)
+    {
+        threads.emplace_back(
+            [&]()
+            {
+                for (int i = 0; i < events; i++)
+                    queue.put(i);
+            });
+    }
+    for (long i = 0; i < long(producers) * events; i++)
+        queue.wait_and_pop();
+    double elapsed = Bench::elapsedNs(begin);
+    for (auto& thread : threads)
+        thread.join();
+    done = true;
+    observer.join();
+    Bench::report(std::string(name) + ": time per event", elapsed / (long(producers) * events),
+                  "ns");
+}
+
+int main(int argc, char** argv)
+{
+    int producers = (argc > 1) ? std::atoi(argv[1]) : 4;
+    int events    = (argc > 2) ? std::atoi(argv[2]) : 200000;
+
+    measure<SimplestThreadSafeQueue<int>>("SimplestThreadSafeQueue", producers, events);
+    measure<PaddedThreadSafeQueue<int>>("PaddedThreadSafeQueue", producers, events);
+    return 0;
+}
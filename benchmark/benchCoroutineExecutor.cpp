@@ -0,0 +1,249 @@
+#include <atomic>
+#include <cstdlib>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "BenchUtils.hpp"
+#include "CoroutineExecutor/CoroutineExecutor.hpp"
+#include "IState/IState.hpp"
+#include "StateManager/StateManager.hpp"
+#include "ThreadSafeQueue/ThreadSafeQueue.hpp"
+
+/**
+ * Compares the thread-per-actor model (std::thread + SimplestThreadSafeQueue::wait_and_pop()) with
+ * actors hosted as coroutines on a single EventLoop:
+ *  - event latency: average duration of one hop of a ping-pong between two actors
+ *  - memory: resident/virtual bytes per actor once every actor has processed one event
+ */
+
+class Ping : public IEvent
+{
+};
+
+template <class Actor>
+class PingState : public IState<Actor>
+{
+   public:
+    PingState(Actor* actor) : IState<Actor>(actor)
+    {
+    }
+    virtual int process_event(IEvent_ptr event) override
+    {
+        this->m_actor->onPing(event);
+        return 0;
+    }
+};
+
+/* Shared by both models: the state machine and the ping-pong bookkeeping */
+template <class Actor>
+class PingActorBase
+{
+   public:
+    using State_ptr = std::shared_ptr<PingState<Actor>>;
+
+    PingActorBase(Actor* self)
+    {
+        tree<State_ptr> tree;
+        tree.set_head(std::make_shared<PingState<Actor>>(self));
+        auto idle       = tree.append_child(tree.begin(), std::make_shared<PingState<Actor>>(self));
+        m_state_manager = std::make_shared<StateManager<State_ptr>>(std::move(tree), idle);
+    }
+
+    void onPing(IEvent_ptr event)
+    {
+        m_received++;
+        if (m_remaining > 0)
+        {
+            m_remaining--;
+            m_peer->callback_IEvent(event);
+        }
+        else if (m_done)
+        {
+            m_done->set_value();
+            m_done = nullptr;
+        }
+    }
+
+    Actor*                                   m_peer{nullptr};
+    long                                     m_remaining{0};
+    long                                     m_received{0};
+    std::promise<void>*                      m_done{nullptr};
+    std::shared_ptr<StateManager<State_ptr>> m_state_manager;
+};
+
+class ThreadActor : public PingActorBase<ThreadActor>
+{
+   public:
+    ThreadActor() : PingActorBase<ThreadActor>(this)
+    {
+    }
+    ~ThreadActor()
+    {
+        stop();
+    }
+    void start()
+    {
+        m_state_manager->init();
+        m_running = true;
+        m_thread  = std::thread(&ThreadActor::run, this);
+    }
+    void stop()
+    {
+        if (!m_running)
+            return;
+        m_running = false;
+        m_queue.put(std::make_shared<Ping>());
+        if (m_thread.joinable())
+            m_thread.join();
+    }
+    void callback_IEvent(IEvent_ptr event)
+    {
+        m_queue.put(event);
+    }
+
+   private:
+    void run()
+    {
+        do
+        {
+            IEvent_ptr current_event = m_queue.wait_and_pop();
+            m_state_manager->processEvent(current_event);
+        } while (m_running);
+    }
+
+    std::atomic_bool                    m_running{false};
+    std::thread                         m_thread;
+    SimplestThreadSafeQueue<IEvent_ptr> m_queue;
+};
+
+class CoActor : public PingActorBase<CoActor>
+{
+   public:
+    CoActor(EventLoop& loop) : PingActorBase<CoActor>(this), m_mailbox{loop}
+    {
+    }
+    void start()
+    {
+        m_task = run();
+        m_mailbox.loop().start(m_task);
+    }
+    void callback_IEvent(IEvent_ptr event)
+    {
+        m_mailbox.put(event);
+    }
+
+   private:
+    Task run()
+    {
+        m_state_manager->init();
+        while (true)
+        {
+            IEvent_ptr current_event = co_await m_mailbox.pop();
+            m_state_manager->processEvent(current_event);
+        }
+    }
+
+    Mailbox m_mailbox;
+    Task    m_task;
+};
+
+template <class Actor>
+double pingPong(Actor& a, Actor& b, long hops)
+{
+    std::promise<void> done;
+    a.m_peer      = &b;
+    b.m_peer      = &a;
+    a.m_remaining = hops / 2;
+    b.m_remaining = hops / 2;
+    a.m_done      = &done;
+    b.m_done      = &done;
+
+    auto begin = Bench::Clock::now();
+    a.callback_IEvent(std::make_shared<Ping>());
+    done.get_future().wait();
+    double result = Bench::elapsedNs(begin) / hops;
+
+    // Both actors are idle again at this point
+    a.m_done = nullptr;
+    b.m_done = nullptr;
+    return result;
+}
+
+void benchThreadModel(long hops, int actors)
+{
+    {
+        ThreadActor a, b;
+        a.start();
+        b.start();
+        Bench::report("thread-per-actor: ping-pong latency per hop", pingPong(a, b, hops), "ns");
+    }
+
+    Bench::Memory before = Bench::memory();
+    {
+        std::vector<std::unique_ptr<ThreadActor>> pool;
+        for (int i = 0; i < actors; i++)
+        {
+            pool.emplace_back(std::make_unique<ThreadActor>());
+            pool.back()->start();
+            pool.back()->callback_IEvent(std::make_shared<Ping>());
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        Bench::Memory after = Bench::memory();
+        Bench::report("thread-per-actor: heap bytes per idle actor",
+                      double(after.heap - before.heap) / actors, "B");
+        Bench::report("thread-per-actor: resident bytes per idle actor",
+                      double(after.resident - before.resident) / actors, "B");
+        Bench::report("thread-per-actor: virtual bytes per idle actor",
+                      double(after.virt - before.virt) / actors, "B");
+    }
+}
+
+void benchCoroutineModel(long hops, int actors)
+{
+    {
+        EventLoop   loop;
+        CoActor     a(loop), b(loop);
+        std::thread runner([&]() { loop.run(); });
+        a.start();
+        b.start();
+        Bench::report("coroutine executor: ping-pong latency per hop", pingPong(a, b, hops), "ns");
+        loop.stop();
+        runner.join();
+    }
+
+    Bench::Memory before = Bench::memory();
+    {
+        EventLoop   loop;
+        std::thread runner([&]() { loop.run(); });
+
+        std::vector<std::unique_ptr<CoActor>> pool;
+        for (int i = 0; i < actors; i++)
+        {
+            pool.emplace_back(std::make_unique<CoActor>(loop));
+            pool.back()->start();
+            pool.back()->callback_IEvent(std::make_shared<Ping>());
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        Bench::Memory after = Bench::memory();
+        Bench::report("coroutine executor: heap bytes per idle actor",
+                      double(after.heap - before.heap) / actors, "B");
+        Bench::report("coroutine executor: resident bytes per idle actor",
+                      double(after.resident - before.resident) / actors, "B");
+        Bench::report("coroutine executor: virtual bytes per idle actor",
+                      double(after.virt - before.virt) / actors, "B");
+        loop.stop();
+        runner.join();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    long hops   = (argc > 1) ? std::atol(argv[1]) : 100000;
+    int  actors = (argc > 2) ? std::atoi(argv[2]) : 1000;
+
+    benchThreadModel(hops, actors);
+    benchCoroutineModel(hops, actors);
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BenchUtils.hpp"
+#include "DurableMailbox/DurableMailbox.hpp"
+
+/**
+ * Durable events per second through a DurableMailbox: one producer put()s small events while the
+ * consumer pops and acknowledges them, for several durability windows. A zero window msync()s
+ * before every put() returns. The file goes to $TMPDIR (or /tmp); point it at the device to
+ * measure, e.g. TMPDIR=/mnt/nvme benchDurableMailbox
+ */
+
+class Reading : public IEvent
+{
+   public:
+    uint64_t sensor{0};
+    double   value{0};
+};
+
+Snapshot::EventCodec readingCodec()
+{
+    Snapshot::EventCodec codec;
+    codec.encode = [](const IEvent_ptr& event, std::vector<uint8_t>& blob)
+    {
+        auto& reading = static_cast<const Reading&>(*event);
+        auto* bytes   = reinterpret_cast<const uint8_t*>(&reading.sensor);
+        blob.insert(blob.end(), bytes, bytes + sizeof(reading.sensor));
+        bytes = reinterpret_cast<const uint8_t*>(&reading.value);
+        blob.insert(blob.end(), bytes, bytes + sizeof(reading.value));
+        return true;
+    };
+    codec.decode = [](const uint8_t* data, std::size_t size) -> IEvent_ptr
+    {
+        auto reading = std::make_shared<Reading>();
+        if (size != sizeof(reading->sensor) + sizeof(reading->value))
+            return nullptr;
+        std::memcpy(&reading->sensor, data, sizeof(reading->sensor));
+        std::memcpy(&reading->value, data + sizeof(reading->sensor), sizeof(reading->value));
+        return reading;
+    };
+    return codec;
+}
+
+void measure(const std::string& path, std::chrono::milliseconds window, int events)
+{
+    std::remove(path.c_str());
+    DurableMailbox mailbox(path, 64 << 20, readingCodec(), window);
+    if (!mailbox.valid())
+    {
+        std::printf("cannot map %s\n", path.c_str());
+        return;
+    }
+    auto        begin = Bench::Clock::now();
+    std::thread consumer(
+        [&]()
+        {
+            for (int i = 0; i < events; i++)
+            {
+                mailbox.wait_and_pop();
+                mailbox.acknowledge();
+            }
+        });
+    for (int i = 0; i < events; i++)
+    {
+        auto reading    = std::make_shared<Reading>();
+        reading->sensor = i;
+        mailbox.put(reading);
+    }
+    consumer.join();
+    mailbox.sync();
+    double elapsed = Bench::elapsedNs(begin);
+    Bench::report("window " + std::to_string(window.count()) + " ms: durable events per second",
+                  events / elapsed * 1e9, "");
+    std::remove(path.c_str());
+}
+
+int main(int argc, char** argv)
+{
+    int         events = (argc > 1) ? std::atoi(argv[1]) : 1000000;
+    const char* tmpdir = std::getenv("TMPDIR");
+    std::string path   = std::string(tmpdir ? tmpdir : "/tmp") + "/benchDurableMailbox.bin";
+
+    measure(path, std::chrono::milliseconds{100}, events);
+    measure(path, std::chrono::milliseconds{10}, events);
+    measure(path, std::chrono::milliseconds{1}, events);
+    measure(path, std::chrono::milliseconds{0}, events / 100);
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BenchUtils.hpp"
+#include "StateManager/StateManager.hpp"
+#include "ThreadSafeQueue/CompactThreadSafeQueue.hpp"
+#include "ThreadSafeQueue/ThreadSafeQueue.hpp"
+
+/**
+ * Bytes per idle actor, for a large number of actors that each processed a burst of events and
+ * went idle: the mailbox alone (SimplestThreadSafeQueue versus CompactThreadSafeQueue), then the
+ * mailbox together with a small state machine
+ */
+
+class Ping : public IEvent
+{
+};
+
+class Idle
+{
+   public:
+    int on_entry()
+    {
+        return 0;
+    }
+    int on_exit()
+    {
+        return 0;
+    }
+    int process_event(IEvent_ptr event)
+    {
+        (void) event;
+        return 0;
+    }
+};
+
+using Idle_ptr = std::shared_ptr<Idle>;
+
+template <class Queue>
+struct Actor
+{
+    Actor(bool with_states)
+    {
+        if (!with_states)
+            return;
+        tree<Idle_ptr> states;
+        auto           root = states.set_head(std::make_shared<Idle>());
+        auto           leaf = states.append_child(root, std::make_shared<Idle>());
+        states.append_child(root, std::make_shared<Idle>());
+        state_manager = std::make_unique<StateManager<Idle_ptr>>(std::move(states), leaf);
+    }
+
+    Queue                                   queue;
+    std::unique_ptr<StateManager<Idle_ptr>> state_manager;
+};
+
+template <class Queue>
+void measure(const std::string& name, bool with_states, int actors, int burst)
+{
+    auto                                       event  = std::make_shared<Ping>();
+    Bench::Memory                              before = Bench::memory();
+    std::vector<std::unique_ptr<Actor<Queue>>> pool;
+    pool.reserve(actors);
+    for (int i = 0; i < actors; i++)
+    {
+        pool.emplace_back(std::make_unique<Actor<Queue>>(with_states));
+        auto& actor = *pool.back();
+        for (int j = 0; j < burst; j++)
+            actor.queue.put(event);
+        while (!actor.queue.empty())
+        {
+            IEvent_ptr current_event = actor.queue.wait_and_pop();
+            if (actor.state_manager)
+                actor.state_manager->processEvent(current_event);
+        }
+    }
+    Bench::Memory after = Bench::memory();
+    Bench::report(name + ": heap bytes per idle actor", double(after.heap - before.heap) / actors,
+                  "B");
+}
+
+int main(int argc, char** argv)
+{
+    int actors = (argc > 1) ? std::atoi(argv[1]) : 50000;
+    int burst  = (argc > 2) ? std::atoi(argv[2]) : 100;
+
+    Bench::report("sizeof(SimplestThreadSafeQueue)", sizeof(SimplestThreadSafeQueue<IEvent_ptr>),
+                  "B");
+    Bench::report("sizeof(CompactThreadSafeQueue)", sizeof(CompactThreadSafeQueue<IEvent_ptr>),
+                  "B");
+    measure<SimplestThreadSafeQueue<IEvent_ptr>>("SimplestThreadSafeQueue", false, actors, burst);
+    measure<CompactThreadSafeQueue<IEvent_ptr>>("CompactThreadSafeQueue", false, actors, burst);
+    measure<SimplestThreadSafeQueue<IEvent_ptr>>("SimplestThreadSafeQueue + 3 states", true, actors,
+                                                 burst);
+    measure<CompactThreadSafeQueue<IEvent_ptr>>("CompactThreadSafeQueue + 3 states", true, actors,
+                                                burst);
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "BenchUtils.hpp"
+#include "IState/IState.hpp"
+#include "StateManager/StateManager.hpp"
+
+/**
+ * Dispatch cost of an event only handled by the root of a deep hierarchy
+ * (StateG -> StateF -> StateD -> StateA -> root, as in samples/intermediate): bubbling through
+ * every state versus jumping straight to the root once the states declared what they handle
+ */
+
+class Tick : public Event<Tick>
+{
+};
+
+class Machine;
+
+class Level : public IState<Machine>
+{
+   public:
+    Level(bool handles) : IState<Machine>(nullptr), m_handles{handles}
+    {
+    }
+    virtual int process_event(IEvent_ptr event) override
+    {
+        (void) event;
+        if (!m_handles)
+            return -1;
+        m_handled++;
+        return 0;
+    }
+
+    long m_handled{0};
+
+   private:
+    bool m_handles;
+};
+
+using Level_ptr = std::shared_ptr<Level>;
+
+std::unique_ptr<StateManager<Level_ptr>> makeMachine(bool declared)
+{
+    tree<Level_ptr> states;
+    auto            root = states.set_head(std::make_shared<Level>(true));
+    auto            leaf = root;
+    for (int depth = 0; depth < 4; depth++)
+        leaf = states.append_child(leaf, std::make_shared<Level>(false));
+
+    auto machine = std::make_unique<StateManager<Level_ptr>>(std::move(states), leaf);
+    if (declared)
+    {
+        for (std::size_t index = 1; index < machine->stateCount(); index++)
+            machine->declareHandled<>(machine->stateAt(index));
+    }
+    machine->init();
+    return machine;
+}
+
+long measure(const std::string& name, bool declared, long events)
+{
+    auto machine = makeMachine(declared);
+    auto event   = std::make_shared<Tick>();
+    auto begin   = Bench::Clock::now();
+    for (long i = 0; i < events; i++)
+        machine->processEvent(event);
+    Bench::report(name + ": dispatch to the root", Bench::elapsedNs(begin) / events, "ns");
+    return machine->stateAt(0).node->data->m_handled;
+}
+
+int main(int argc, char** argv)
+{
+    long events = (argc > 1) ? std::atol(argv[1]) : 1000000;
+
+    long handled = measure("bubbling through every state", false, events);
+    handled += measure("declared handlers", true, events);
+    return handled != 2 * events;
+}
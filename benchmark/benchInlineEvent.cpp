@@ -0,0 +1,98 @@
+#include <cstdlib>
+#include <memory>
+
+#include "BenchUtils.hpp"
+#include "CountAllocations.hpp"
+#include "IEvent/InlineEvent.hpp"
+#include "StateManager/StateManager.hpp"
+#include "ThreadSafeQueue/InlineEventQueue.hpp"
+#include "ThreadSafeQueue/ThreadSafeQueue.hpp"
+
+/**
+ * Cost of one small event from creation to dispatch (create, put, pop, processEvent), and heap
+ * allocations it makes: a heap-allocated IEvent in a SimplestThreadSafeQueue versus an
+ * InlineEvent envelope in an InlineEventQueue
+ */
+
+class DoToasting : public IEvent
+{
+   public:
+    DoToasting(uint64_t timeout) : timeout{timeout}
+    {
+    }
+    uint64_t timeout;
+};
+
+struct Toasting
+{
+    uint64_t timeout;
+};
+
+class Counter
+{
+   public:
+    int on_entry()
+    {
+        return 0;
+    }
+    int on_exit()
+    {
+        return 0;
+    }
+    int process_event(IEvent_ptr event)
+    {
+        total += std::static_pointer_cast<DoToasting>(event)->timeout;
+        return 0;
+    }
+    int process_inline(const InlineEvent& event)
+    {
+        total += event.get<Toasting>()->timeout;
+        return 0;
+    }
+
+    uint64_t total{0};
+};
+
+using Counter_ptr = std::shared_ptr<Counter>;
+
+template <class Body>
+void measure(const char* name, long events, Body&& body)
+{
+    long before = Bench::allocations.load();
+    auto begin  = Bench::Clock::now();
+    for (long i = 0; i < events; i++)
+        body(i);
+    double      elapsed   = Bench::elapsedNs(begin);
+    long        allocated = Bench::allocations.load() - before;
+    std::string prefix(name);
+    Bench::report(prefix + ": create, queue and dispatch one event", elapsed / events, "ns");
+    Bench::report(prefix + ": allocations per event", double(allocated) / events, "");
+}
+
+int main(int argc, char** argv)
+{
+    long events = (argc > 1) ? std::atol(argv[1]) : 1000000;
+
+    tree<Counter_ptr>         states;
+    auto                      counter = std::make_shared<Counter>();
+    auto                      root    = states.set_head(counter);
+    StateManager<Counter_ptr> state_manager(std::move(states), root);
+    state_manager.init();
+
+    SimplestThreadSafeQueue<IEvent_ptr> queue;
+    measure("shared_ptr<IEvent> + SimplestThreadSafeQueue", events,
+            [&](long i)
+            {
+                queue.put(std::make_shared<DoToasting>(i));
+                state_manager.processEvent(queue.wait_and_pop());
+            });
+
+    InlineEventQueue inline_queue;
+    measure("InlineEvent + InlineEventQueue", events,
+            [&](long i)
+            {
+                inline_queue.put(InlineEvent(Toasting{uint64_t(i)}));
+                state_manager.processEvent(inline_queue.wait_and_pop());
+            });
+    return counter->total == 0;
+}
@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "BenchUtils.hpp"
+#include "MachineArray/MachineArray.hpp"
+#include "StateManager/StateManager.hpp"
+#include "ThreadSafeQueue/ThreadSafeQueue.hpp"
+
+/**
+ * Events per second through a fleet of identical machines (idle <-> busy, under a root): one
+ * actor per instance, with its thread, queue and StateManager, against a MachineArray holding
+ * every instance, with one worker per core
+ */
+
+class Start : public IEvent
+{
+};
+class Stop : public IEvent
+{
+};
+
+// Counts the entries of its state in the instance being processed, if any
+class CountingState
+{
+   public:
+    explicit CountingState(std::vector<uint64_t>* entries = nullptr) : m_entries{entries}
+    {
+    }
+    int on_entry()
+    {
+        if (m_entries)
+            (*m_entries)[MachineArray<std::shared_ptr<CountingState>>::instance()]++;
+        return 0;
+    }
+    int on_exit()
+    {
+        return 0;
+    }
+    int process_event(IEvent_ptr)
+    {
+        return -1;
+    }
+
+   private:
+    std::vector<uint64_t>* m_entries;
+};
+using CountingState_ptr = std::shared_ptr<CountingState>;
+
+// root -> idle, busy: Start and Stop toggle between them
+template <class Machine>
+std::unique_ptr<Machine> build(std::vector<uint64_t>* entries, std::size_t instances = 0,
+                               std::size_t workers = 0)
+{
+    tree<CountingState_ptr> states;
+    auto root = states.set_head(std::make_shared<CountingState>());
+    auto idle = states.append_child(root, std::make_shared<CountingState>());
+    auto busy = states.append_child(root, std::make_shared<CountingState>(entries));
+    std::unique_ptr<Machine> machine;
+    if constexpr (std::is_same_v<Machine, StateManager<CountingState_ptr>>)
+        machine = std::make_unique<Machine>(std::move(states), idle);
+    else
+        machine = std::make_unique<Machine>(std::move(states), idle, instances, workers);
+    machine->template addTransition<Start>(idle, busy);
+    machine->template addTransition<Stop>(busy, idle);
+    machine->init();
+    return machine;
+}
+
+class DeviceActor
+{
+   public:
+    explicit DeviceActor(std::atomic<long>& done)
+        : m_machine{build<StateManager<CountingState_ptr>>(nullptr)}, m_done{done}
+    {
+        m_thread = std::thread(&DeviceActor::run, this);
+    }
+    ~DeviceActor()
+    {
+        m_queue.put(nullptr);
+        m_thread.join();
+    }
+    void callback_IEvent(IEvent_ptr event)
+    {
+        m_queue.put(event);
+    }
+
+   private:
+    void run()
+    {
+        while (IEvent_ptr event = m_queue.wait_and_pop())
+        {
+            m_machine->processEvent(event);
+            m_done.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    std::unique_ptr<StateManager<CountingState_ptr>> m_machine;
+    std::atomic<long>&                               m_done;
+    SimplestThreadSafeQueue<IEvent_ptr>              m_queue;
+    std::thread                                      m_thread;
+};
+
+void threadPerInstance(std::size_t instances, int rounds)
+{
+    std::atomic<long>                         done{0};
+    std::vector<std::unique_ptr<DeviceActor>> actors;
+    for (std::size_t i = 0; i < instances; i++)
+        actors.push_back(std::make_unique<DeviceActor>(done));
+    IEvent_ptr start = std::make_shared<Start>();
+    IEvent_ptr stop  = std::make_shared<Stop>();
+
+    auto begin = Bench::Clock::now();
+    for (int round = 0; round < rounds; round++)
+    {
+        for (auto& actor : actors)
+        {
+            actor->callback_IEvent(start);
+            actor->callback_IEvent(stop);
+        }
+    }
+    long events = 2 * long(instances) * rounds;
+    while (done.load(std::memory_order_relaxed) < events)
+        std::this_thread::yield();
+    Bench::report(std::to_string(instances) + " actors: events per second",
+                  events / Bench::elapsedNs(begin) * 1e9, "");
+}
+
+void machineArray(std::size_t instances, int rounds, std::size_t workers)
+{
+    std::vector<uint64_t> entries(instances, 0);
+    auto       machines = build<MachineArray<CountingState_ptr>>(&entries, instances, workers);
+    IEvent_ptr start    = std::make_shared<Start>();
+    IEvent_ptr stop     = std::make_shared<Stop>();
+
+    long events = 0;
+    auto begin  = Bench::Clock::now();
+    for (int round = 0; round < rounds; round++)
+    {
+        machines->broadcast(start);
+        machines->broadcast(stop);
+        events += machines->process();
+    }
+    Bench::report(std::to_string(instances) + " instances, " + std::to_string(workers)
+                      + " workers: events per second",
+                  events / Bench::elapsedNs(begin) * 1e9, "");
+}
+
+int main(int argc, char** argv)
+{
+    int         rounds  = (argc > 1) ? std::atoi(argv[1]) : 20;
+    std::size_t workers = std::max(1u, std::thread::hardware_concurrency());
+
+    threadPerInstance(1000, rounds);
+    machineArray(1000, rounds * 10, workers);
+    machineArray(100000, rounds, workers);
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include <atomic>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BenchUtils.hpp"
+#include "ThreadSafeQueue/PaddedThreadSafeQueue.hpp"
+#include "ThreadSafeQueue/PerSenderQueue.hpp"
+#include "ThreadSafeQueue/ThreadSafeQueue.hpp"
+
+/**
+ * Fan-in to one actor: many producers, 32 by default, put() into its queue while its thread
+ * pops. SimplestThreadSafeQueue and PaddedThreadSafeQueue order every event behind a single lock,
+ * PerSenderQueue gives each producer a lane of its own and only keeps each producer's order,
+ * which is checked here. Reports the events per second, producers started to last event popped
+ */
+
+template <class Queue>
+void measure(const char* name, int producers, int events)
+{
+    Queue                    queue;
+    std::atomic_bool         go{false};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++)
+    {
+        threads.emplace_back(
+            [&, p]()
+            {
+                while (!go.load(std::memory_order_acquire))
+                    std::this_thread::yield();
+                for (int i = 0; i < events; i++)
+                    queue.put(long(p) * events + i);
+            });
+    }
+
+    std::vector<int> next(producers, 0);
+    bool             ordered = true;
+    auto             begin   = Bench::Clock::now();
+    go.store(true, std::memory_order_release);
+    for (long i = 0; i < long(producers) * events; i++)
+    {
+        long value = queue.wait_and_pop();
+        ordered &= (next[value / events]++ == value % events);
+    }
+    double elapsed = Bench::elapsedNs(begin);
+    for (auto& thread : threads)
+        thread.join();
+    Bench::report(std::string(name) + ": events per second",
+                  long(producers) * events / elapsed * 1e9, "");
+    Bench::report(std::string(name) + ": each producer's order kept", ordered ? 1 : 0, "");
+}
+
+int main(int argc, char** argv)
+{
+    int producers = (argc > 1) ? std::atoi(argv[1]) : 32;
+    int events    = (argc > 2) ? std::atoi(argv[2]) : 50000;
+
+    measure<SimplestThreadSafeQueue<long>>("SimplestThreadSafeQueue", producers, events);
+    measure<PaddedThreadSafeQueue<long>>("PaddedThreadSafeQueue", producers, events);
+    measure<PerSenderQueue<long>>("PerSenderQueue", producers, events);
+    return 0;
+}
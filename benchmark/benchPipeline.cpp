@@ -0,0 +1,135 @@
+#include <atomic>
+#include <cstdlib>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BenchUtils.hpp"
+#include "IEvent/IEvent.hpp"
+#include "ThreadSafeQueue/SpscChannel.hpp"
+#include "ThreadSafeQueue/ThreadSafeQueue.hpp"
+
+/**
+ * Per-hop cost through a 5-stage actor pipeline closed in a ring (stage 4 feeds stage 0), each
+ * stage an actor with its own thread: every hop through SimplestThreadSafeQueue mailboxes versus
+ * through declared SPSC channels into each stage's Inbox. Measured with a single event in flight
+ * (latency) and with many (throughput)
+ */
+
+constexpr int STAGES = 5;
+
+class Token : public IEvent
+{
+};
+
+// Forwards every event to the next stage until 'hops' hops were made in total
+template <class Stage>
+void runStage(Stage& stage, std::atomic<long>& hops, std::promise<void>& done)
+{
+    while (true)
+    {
+        IEvent_ptr event = stage.pop();
+        if (!event)
+            return;
+        long hop = hops.fetch_sub(1, std::memory_order_relaxed);
+        if (hop == 1)
+            done.set_value();
+        if (hop >= 1)
+            stage.forward(std::move(event));
+    }
+}
+
+struct MailboxStage
+{
+    IEvent_ptr pop()
+    {
+        return mailbox.wait_and_pop();
+    }
+    void forward(IEvent_ptr event)
+    {
+        next->mailbox.put(std::move(event));
+    }
+    void stop()
+    {
+        mailbox.put(nullptr);
+    }
+    SimplestThreadSafeQueue<IEvent_ptr> mailbox;
+    MailboxStage*                       next{nullptr};
+};
+
+struct ChannelStage
+{
+    IEvent_ptr pop()
+    {
+        return inbox.wait_and_pop();
+    }
+    void forward(IEvent_ptr event)
+    {
+        link->push(std::move(event));
+    }
+    void stop()
+    {
+        inbox.put(nullptr);
+    }
+    Inbox<IEvent_ptr>        inbox;
+    SpscChannel<IEvent_ptr>* link{nullptr};  // Into the next stage's inbox
+};
+
+template <class Stage, class Inject>
+double measure(std::vector<std::unique_ptr<Stage>>& stages, long hops, int in_flight, Inject inject)
+{
+    std::atomic<long>        remaining{hops};
+    std::promise<void>       done;
+    std::vector<std::thread> threads;
+    for (auto& stage : stages)
+        threads.emplace_back([&]() { runStage(*stage, remaining, done); });
+
+    auto begin = Bench::Clock::now();
+    for (int i = 0; i < in_flight; i++)
+        inject(std::make_shared<Token>());
+    done.get_future().wait();
+    double elapsed = Bench::elapsedNs(begin);
+
+    for (auto& stage : stages)
+        stage->stop();
+    for (auto& thread : threads)
+        thread.join();
+    return elapsed / hops;
+}
+
+void benchMailboxes(const std::string& name, long hops, int in_flight)
+{
+    std::vector<std::unique_ptr<MailboxStage>> stages;
+    for (int i = 0; i < STAGES; i++)
+        stages.push_back(std::make_unique<MailboxStage>());
+    for (int i = 0; i < STAGES; i++)
+        stages[i]->next = stages[(i + 1) % STAGES].get();
+    double per_hop = measure(stages, hops, in_flight,
+                             [&](IEvent_ptr event) { stages[0]->mailbox.put(std::move(event)); });
+    Bench::report("SimplestThreadSafeQueue: " + name, per_hop, "ns");
+}
+
+void benchChannels(const std::string& name, long hops, int in_flight)
+{
+    std::vector<std::unique_ptr<ChannelStage>> stages;
+    for (int i = 0; i < STAGES; i++)
+        stages.push_back(std::make_unique<ChannelStage>());
+    for (int i = 0; i < STAGES; i++)
+        stages[i]->link = &stages[(i + 1) % STAGES]->inbox.connect(256);
+    double per_hop = measure(stages, hops, in_flight,
+                             [&](IEvent_ptr event) { stages[0]->inbox.put(std::move(event)); });
+    Bench::report("SpscChannel: " + name, per_hop, "ns");
+}
+
+int main(int argc, char** argv)
+{
+    long hops = (argc > 1) ? std::atol(argv[1]) : 200000;
+
+    benchMailboxes("per-hop latency, 1 event in flight", hops, 1);
+    benchChannels("per-hop latency, 1 event in flight", hops, 1);
+    benchMailboxes("per-hop cost, 64 events in flight", hops, 64);
+    benchChannels("per-hop cost, 64 events in flight", hops, 64);
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BenchUtils.hpp"
+#include "Router/Router.hpp"
+#include "ThreadSafeQueue/ThreadSafeQueue.hpp"
+
+/**
+ * Throughput of a pool of thread-per-actor workers behind a Router, for pool sizes from 1 up to
+ * the number of cores. Every event costs a fixed amount of CPU time to its worker, so the
+ * throughput is expected to grow linearly with the pool size until the cores are exhausted
+ */
+
+class Job : public IEvent
+{
+   public:
+    Job(uint64_t key) : key{key}
+    {
+    }
+    uint64_t key;
+};
+
+class Worker
+{
+   public:
+    Worker(long work_ns, std::atomic<long>& done) : m_work_ns{work_ns}, m_done{done}
+    {
+        m_thread = std::thread(&Worker::run, this);
+    }
+    ~Worker()
+    {
+        m_queue.put(nullptr);
+        m_thread.join();
+    }
+    void callback_IEvent(IEvent_ptr event)
+    {
+        m_queue.put(event);
+    }
+    std::size_t queueDepth()
+    {
+        return m_queue.size();
+    }
+
+   private:
+    void run()
+    {
+        while (IEvent_ptr event = m_queue.wait_and_pop())
+        {
+            auto begin = Bench::Clock::now();
+            while (Bench::elapsedNs(begin) < m_work_ns)
+            {
+            }
+            m_done.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    long                                m_work_ns;
+    std::atomic<long>&                  m_done;
+    SimplestThreadSafeQueue<IEvent_ptr> m_queue;
+    std::thread                         m_thread;
+};
+
+double throughput(int pool_size, RoutingPolicy policy, long events, long work_ns)
+{
+    std::atomic<long>                    done{0};
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<Worker*>                 pool;
+    for (int i = 0; i < pool_size; i++)
+    {
+        workers.emplace_back(std::make_unique<Worker>(work_ns, done));
+        pool.push_back(workers.back().get());
+    }
+    Router<Worker> router(pool, policy,
+                          [](const IEvent_ptr& event)
+                          { return std::static_pointer_cast<Job>(event)->key; });
+
+    std::vector<IEvent_ptr> jobs;
+    for (long i = 0; i < events; i++)
+        jobs.push_back(std::make_shared<Job>(i));
+
+    auto begin = Bench::Clock::now();
+    for (auto& job : jobs)
+        router.callback_IEvent(job);
+    while (done.load(std::memory_order_relaxed) < events)
+        std::this_thread::yield();
+    return events / (Bench::elapsedNs(begin) / 1e9);
+}
+
+int main(int argc, char** argv)
+{
+    long events  = (argc > 1) ? std::atol(argv[1]) : 200000;
+    long work_ns = (argc > 2) ? std::atol(argv[2]) : 5000;
+    int  cores   = std::max(1u, std::thread::hardware_concurrency());
+
+    const std::pair<RoutingPolicy, const char*> policies[] = {
+        {RoutingPolicy::RoundRobin, "round-robin"},
+        {RoutingPolicy::LeastLoaded, "least-loaded"},
+        {RoutingPolicy::ConsistentHash, "consistent-hash"}};
+    for (auto& [policy, name] : policies)
+    {
+        for (int pool_size = 1; pool_size <= cores; pool_size *= 2)
+        {
+            Bench::report(std::string(name) + ": pool of " + std::to_string(pool_size),
+                          throughput(pool_size, policy, events, work_ns) / 1e3, "k/s");
+        }
+    }
+    return 0;
+}
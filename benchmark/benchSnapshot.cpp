@@ -0,0 +1,122 @@
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "BenchUtils.hpp"
+#include "IState/IState.hpp"
+#include "Snapshot/Snapshot.hpp"
+#include "StateManager/StateManager.hpp"
+
+/**
+ * Warm restart of many actors: rebuilding each state machine from its checkpoint (no entry
+ * action executed) versus a cold start, i.e. init() and a replay of the traffic that led it to
+ * the same configuration
+ */
+
+class Next : public IEvent
+{
+};
+
+class Actor;
+
+class Stage : public IState<Actor>
+{
+   public:
+    Stage(Actor* actor) : IState<Actor>(actor)
+    {
+    }
+    virtual int on_entry() override
+    {
+        m_entries++;
+        return 0;
+    }
+
+    long m_entries{0};
+};
+
+/**
+ *  root
+ *  ├── Idle
+ *  └── Busy
+ *      ├── Stage1 <-> Stage2 <-> Stage3
+ */
+class Actor
+{
+   public:
+    using Stage_ptr = std::shared_ptr<Stage>;
+
+    Actor()
+    {
+        tree<Stage_ptr> tree;
+        auto            root = tree.set_head(std::make_shared<Stage>(this));
+        auto            idle = tree.append_child(root, std::make_shared<Stage>(this));
+        auto            busy = tree.append_child(root, std::make_shared<Stage>(this));
+        std::vector<decltype(root)> stages;
+        for (int i = 0; i < 3; i++)
+            stages.push_back(tree.append_child(busy, std::make_shared<Stage>(this)));
+
+        m_state_manager = std::make_unique<StateManager<Stage_ptr>>(std::move(tree), idle);
+        m_state_manager->addTransition<Next>(idle, stages[0]);
+        for (int i = 0; i < 3; i++)
+            m_state_manager->addTransition<Next>(stages[i], stages[(i + 1) % 3]);
+    }
+
+    std::unique_ptr<StateManager<Stage_ptr>> m_state_manager;
+};
+
+Snapshot::EventCodec nextCodec()
+{
+    Snapshot::EventCodec codec;
+    codec.encode = [](const IEvent_ptr&, std::vector<uint8_t>&) { return true; };
+    codec.decode = [](const uint8_t*, std::size_t) -> IEvent_ptr { return std::make_shared<Next>(); };
+    return codec;
+}
+
+int main(int argc, char** argv)
+{
+    int actors  = (argc > 1) ? std::atoi(argv[1]) : 10000;
+    int history = (argc > 2) ? std::atoi(argv[2]) : 100;
+
+    auto                              codec = nextCodec();
+    auto                              next  = std::make_shared<Next>();
+    std::vector<std::vector<uint8_t>> blobs;
+    std::size_t                       bytes = 0;
+
+    auto begin = Bench::Clock::now();
+    {
+        std::vector<std::unique_ptr<Actor>> pool;
+        for (int i = 0; i < actors; i++)
+        {
+            pool.emplace_back(std::make_unique<Actor>());
+            pool.back()->m_state_manager->init();
+            for (int e = 0; e < history; e++)
+                pool.back()->m_state_manager->processEvent(next);
+        }
+        Bench::report("cold start: init() and replay of the traffic, all actors",
+                      Bench::elapsedNs(begin) / 1e6, "ms");
+
+        for (auto& actor : pool)
+        {
+            blobs.push_back(Snapshot::checkpoint(*actor->m_state_manager, {next, next}, codec));
+            bytes += blobs.back().size();
+        }
+        Bench::report("checkpoint size per actor", double(bytes) / actors, "B");
+    }
+
+    begin = Bench::Clock::now();
+    {
+        std::vector<std::unique_ptr<Actor>> pool;
+        std::vector<IEvent_ptr>             pending;
+        for (auto& blob : blobs)
+        {
+            pool.emplace_back(std::make_unique<Actor>());
+            if (!Snapshot::restore(*pool.back()->m_state_manager, blob.data(), blob.size(), codec,
+                                   pending))
+                return 1;
+            pending.clear();
+        }
+        Bench::report("warm restart: restore from checkpoint, all actors",
+                      Bench::elapsedNs(begin) / 1e6, "ms");
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+// Restarts are logged as warnings, which would dominate the measure
+#define SYSTEM_LOG_LEVEL LEVEL_ERROR
+
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "BenchUtils.hpp"
+#include "StateManager/StateManager.hpp"
+#include "Supervisor/Supervisor.hpp"
+
+/**
+ * Cost of supervision: a step run through Supervisor::Child::step() against a plain
+ * processEvent(), and the latency of a failed step including the in-place restart of the
+ * StateManager, against recreating the StateManager and the actor's thread
+ */
+
+class Tick : public IEvent
+{
+};
+class Boom : public IEvent
+{
+};
+
+class BenchState
+{
+   public:
+    int on_entry()
+    {
+        return 0;
+    }
+    int on_exit()
+    {
+        return 0;
+    }
+    int process_event(IEvent_ptr event)
+    {
+        if (typeid(*event) == typeid(Boom))
+            throw std::runtime_error("boom");
+        return 0;
+    }
+};
+using BenchState_ptr = std::shared_ptr<BenchState>;
+
+struct Machine
+{
+    Machine()
+    {
+        tree<BenchState_ptr> states;
+        auto                 root = states.set_head(std::make_shared<BenchState>());
+        initial = states.append_child(root, std::make_shared<BenchState>());
+        sm      = std::make_unique<StateManager<BenchState_ptr>>(std::move(states), initial);
+        sm->init();
+    }
+
+    tree<BenchState_ptr>::iterator                initial;
+    std::unique_ptr<StateManager<BenchState_ptr>> sm;
+};
+
+int main(int argc, char** argv)
+{
+    int        steps = (argc > 1) ? std::atoi(argv[1]) : 1000000;
+    IEvent_ptr tick  = std::make_shared<Tick>();
+    IEvent_ptr boom  = std::make_shared<Boom>();
+
+    Machine    machine;
+    Supervisor supervisor(Supervisor::Strategy::OneForOne,
+                          {std::numeric_limits<std::size_t>::max(), std::chrono::seconds{1}});
+    auto*      child =
+        supervisor.supervise("bench", [&]() { machine.sm->restart(machine.initial); });
+
+    auto begin = Bench::Clock::now();
+    for (int i = 0; i < steps; i++)
+        machine.sm->processEvent(tick);
+    Bench::report("plain step: ns per step", Bench::elapsedNs(begin) / steps, "ns");
+
+    begin = Bench::Clock::now();
+    for (int i = 0; i < steps; i++)
+        child->step(*tick, [&]() { machine.sm->processEvent(tick); });
+    Bench::report("supervised step: ns per step", Bench::elapsedNs(begin) / steps, "ns");
+
+    int failures = steps / 100;
+    begin        = Bench::Clock::now();
+    for (int i = 0; i < failures; i++)
+        child->step(*boom, [&]() { machine.sm->processEvent(boom); });
+    Bench::report("failed step and in-place restart: ns per failure",
+                  Bench::elapsedNs(begin) / failures, "ns");
+
+    begin = Bench::Clock::now();
+    for (int i = 0; i < failures; i++)
+    {
+        auto        fresh = std::make_unique<Machine>();
+        std::thread run_loop([&]() { fresh->sm->processEvent(tick); });
+        run_loop.join();
+    }
+    Bench::report("recreated StateManager and thread: ns per restart",
+                  Bench::elapsedNs(begin) / failures, "ns");
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BenchUtils.hpp"
+#include "StateManager/StateManager.hpp"
+#include "ThreadSafeQueue/ThreadSafeQueue.hpp"
+#include "Topic/Topic.hpp"
+
+/**
+ * Events of KINDS types published to actors that each handle a single one of them: through a
+ * SignalIEvent every actor enqueues every event, pops it and bubbles it up its three-level state
+ * tree to be discarded, while a Topic only delivers it to the actors whose filter accepts it.
+ * Reports the cost of one published event, its processing by the actors included
+ */
+
+constexpr uint32_t KINDS = 8;
+
+template <uint32_t N>
+class Kind : public Event<Kind<N>>
+{
+};
+
+class KindState
+{
+   public:
+    explicit KindState(uint32_t id) : m_id{id}
+    {
+    }
+    int on_entry()
+    {
+        return 0;
+    }
+    int on_exit()
+    {
+        return 0;
+    }
+    int process_event(IEvent_ptr event)
+    {
+        return (m_id != 0 && event->getEventId() == m_id) ? 0 : -1;
+    }
+
+   private:
+    uint32_t m_id;
+};
+using KindState_ptr = std::shared_ptr<KindState>;
+
+// Only the leaf handles anything: events of type 'id'
+struct Actor
+{
+    explicit Actor(uint32_t id) : id{id}
+    {
+        tree<KindState_ptr> states;
+        auto                root   = states.set_head(std::make_shared<KindState>(0));
+        auto                middle = states.append_child(root, std::make_shared<KindState>(0));
+        auto                leaf   = states.append_child(middle, std::make_shared<KindState>(id));
+        manager = std::make_unique<StateManager<KindState_ptr>>(std::move(states), leaf);
+        manager->init();
+    }
+
+    void drain()
+    {
+        while (!queue.empty())
+            manager->processEvent(queue.wait_and_pop());
+    }
+
+    uint32_t                                     id;
+    SimplestThreadSafeQueue<IEvent_ptr>          queue;
+    std::unique_ptr<StateManager<KindState_ptr>> manager;
+};
+
+template <uint32_t... N>
+std::vector<IEvent_ptr> oneOfEachKind(std::integer_sequence<uint32_t, N...>)
+{
+    return {std::make_shared<Kind<N>>()...};
+}
+
+template <class Publish>
+void measure(const char* name, int rounds, std::vector<std::unique_ptr<Actor>>& actors,
+             Publish&& publish)
+{
+    auto events = oneOfEachKind(std::make_integer_sequence<uint32_t, KINDS>{});
+    auto begin  = Bench::Clock::now();
+    for (int r = 0; r < rounds; r++)
+    {
+        publish(events[r % KINDS]);
+        for (auto& actor : actors)
+            actor->drain();
+    }
+    Bench::report(std::string(name) + ": one published event", Bench::elapsedNs(begin) / rounds,
+                  "ns");
+}
+
+int main(int argc, char** argv)
+{
+    int actors_count = (argc > 1) ? std::atoi(argv[1]) : 64;
+    int rounds       = (argc > 2) ? std::atoi(argv[2]) : 100000;
+
+    auto kinds = oneOfEachKind(std::make_integer_sequence<uint32_t, KINDS>{});
+    std::vector<std::unique_ptr<Actor>> actors;
+    for (int i = 0; i < actors_count; i++)
+        actors.push_back(std::make_unique<Actor>(kinds[i % KINDS]->getEventId()));
+
+    {
+        SignalIEvent signal;
+        for (auto& actor : actors)
+        {
+            auto* queue = &actor->queue;
+            signal.connect([queue](IEvent_ptr event) { queue->put(event); });
+        }
+        measure("SignalIEvent", rounds, actors, [&](const IEvent_ptr& event) { signal(event); });
+    }
+    {
+        Topic topic;
+        for (auto& actor : actors)
+        {
+            auto*       queue = &actor->queue;
+            EventFilter filter;
+            filter.add(actor->id);
+            topic.subscribe([queue](IEvent_ptr event) { queue->put(event); }, filter);
+        }
+        measure("Topic", rounds, actors, [&](const IEvent_ptr& event) { topic.publish(event); });
+        Bench::report("Topic: deliveries filtered out per published event",
+                      double(topic.filtered()) / rounds, "");
+    }
+    return 0;
+}
@@ -0,0 +1,261 @@
+#ifndef __ACTORREGISTRY_H_
+#define __ACTORREGISTRY_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "IEvent/IEvent.hpp"
+
+/**
+ * Compact address of an actor: index of its slot in the ActorRegistry plus the generation of the
+ * slot when the actor was added. Once the actor is removed its id never resolves again, even if
+ * the slot is reused
+ */
+class ActorId
+{
+   public:
+    ActorId() = default;
+    ActorId(uint32_t index, uint32_t generation)
+        : m_value{(uint64_t(generation) << 32) | index}
+    {
+    }
+
+    uint32_t index() const
+    {
+        return uint32_t(m_value);
+    }
+
+    uint32_t generation() const
+    {
+        return uint32_t(m_value >> 32);
+    }
+
+    bool valid() const
+    {
+        return generation() != 0;
+    }
+
+    uint64_t value() const
+    {
+        return m_value;
+    }
+
+    bool operator==(const ActorId& other) const
+    {
+        return m_value == other.m_value;
+    }
+
+    bool operator!=(const ActorId& other) const
+    {
+        return m_value != other.m_value;
+    }
+
+   private:
+    uint64_t m_value{0};
+};
+
+/**
+ * Resolves ActorIds to the actors' mailboxes (whatever posts into them, e.g. a bound
+ * callback_IEvent), so that actors can address each other without holding pointers to one another.
+ *  - post() takes no lock: the slot is found by index in pages that never move, and the actor is
+ *    pinned by a CAS on the slot's state word for as long as the post lasts
+ *  - add() and remove() are sharded by the calling thread: each shard takes whole pages of
+ *    contiguous indices, one at a time, and keeps its own free list, so there is no global lock
+ *    and the actors added by one thread sit next to each other
+ *  - Events posted to a removed actor are dropped (and counted), never delivered to whichever
+ *    actor reuses the slot
+ */
+class ActorRegistry
+{
+   public:
+    static constexpr uint32_t    SHARDS    = 16;
+    static constexpr uint32_t    PAGE_SIZE = 4096;
+    static constexpr uint32_t    MAX_PAGES = 4096;
+    static constexpr std::size_t CAPACITY  = std::size_t(PAGE_SIZE) * MAX_PAGES;
+    static_assert(SHARDS <= 256, "a page's shard is kept in a byte");
+
+    ActorRegistry() = default;
+
+    ~ActorRegistry()
+    {
+        for (auto& page : m_pages)
+            delete[] page.load(std::memory_order_relaxed);
+    }
+
+    ActorRegistry(const ActorRegistry&)            = delete;
+    ActorRegistry& operator=(const ActorRegistry&) = delete;
+
+    // Returns an invalid ActorId if the registry is full
+    ActorId add(SignatureIEvent mailbox)
+    {
+        uint32_t shard_id = std::hash<std::thread::id>{}(std::this_thread::get_id()) % SHARDS;
+        Shard&   shard    = m_shards[shard_id];
+        uint32_t index;
+        {
+            std::scoped_lock<std::mutex> lock(shard.mutex);
+            if (!shard.free.empty())
+            {
+                index = shard.free.back();
+                shard.free.pop_back();
+            }
+            else
+            {
+                if (shard.next == shard.end && !claimPage(shard, shard_id))
+                    return ActorId{};
+                index = shard.next++;
+            }
+        }
+
+        Slot&    slot       = *find(index);
+        uint64_t state      = slot.state.load(std::memory_order_relaxed);
+        uint32_t generation = uint32_t(state >> 32);
+        slot.mailbox        = std::move(mailbox);
+        // Publishes the mailbox along with the ALIVE bit
+        slot.state.store(state | ALIVE, std::memory_order_release);
+        m_size.fetch_add(1, std::memory_order_relaxed);
+        return ActorId{index, generation};
+    }
+
+    /**
+     * Returns once no post() to the actor is in progress anymore, so the actor may be destroyed
+     * right after. Must not be called from within a post() to the same actor
+     */
+    bool remove(ActorId id)
+    {
+        Slot* slot = find(id.index());
+        if (!slot)
+            return false;
+
+        uint64_t state = slot->state.load(std::memory_order_acquire);
+        do
+        {
+            if (!matches(state, id))
+                return false;
+        } while (!slot->state.compare_exchange_weak(state, state & ~ALIVE,
+                                                    std::memory_order_acq_rel));
+
+        while (slot->state.load(std::memory_order_acquire) & PINS)
+            std::this_thread::yield();
+
+        slot->mailbox = nullptr;
+        // Next generation, skipping 0 which marks invalid ids
+        uint32_t generation = id.generation() + 1;
+        slot->state.store(uint64_t(generation ? generation : 1) << 32, std::memory_order_release);
+        m_size.fetch_sub(1, std::memory_order_relaxed);
+
+        // Back to the shard owning the page, so its indices stay together
+        Shard& shard = m_shards[m_page_shard[id.index() / PAGE_SIZE]];
+        std::scoped_lock<std::mutex> lock(shard.mutex);
+        shard.free.push_back(id.index());
+        return true;
+    }
+
+    // Returns false, dropping the event, if 'id' does not refer to a live actor
+    bool post(ActorId id, IEvent_ptr event)
+    {
+        Slot* slot = find(id.index());
+        if (slot && pin(*slot, id))
+        {
+            slot->mailbox(std::move(event));
+            slot->state.fetch_sub(1, std::memory_order_release);
+            return true;
+        }
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    bool alive(ActorId id) const
+    {
+        const Slot* slot = find(id.index());
+        return slot && matches(slot->state.load(std::memory_order_acquire), id);
+    }
+
+    std::size_t size() const
+    {
+        return m_size.load(std::memory_order_relaxed);
+    }
+
+    // Number of events dropped because they were addressed to a dead actor
+    std::size_t dropped() const
+    {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+   private:
+    // Slot state word: [generation:32][ALIVE:1][pins:31]
+    static constexpr uint64_t ALIVE = uint64_t(1) << 31;
+    static constexpr uint64_t PINS  = ALIVE - 1;
+
+    struct Slot
+    {
+        std::atomic<uint64_t> state{uint64_t(1) << 32};
+        SignatureIEvent       mailbox;
+    };
+
+    struct Shard
+    {
+        std::mutex            mutex;
+        std::vector<uint32_t> free;
+        uint32_t              next{0};  // Never used indices of the last claimed page: [next, end)
+        uint32_t              end{0};
+    };
+
+    static bool matches(uint64_t state, ActorId id)
+    {
+        return (state & ALIVE) && uint32_t(state >> 32) == id.generation();
+    }
+
+    static bool pin(Slot& slot, ActorId id)
+    {
+        uint64_t state = slot.state.load(std::memory_order_acquire);
+        do
+        {
+            if (!matches(state, id))
+                return false;
+        } while (!slot.state.compare_exchange_weak(state, state + 1, std::memory_order_acquire));
+        return true;
+    }
+
+    Slot* find(uint32_t index) const
+    {
+        if (index / PAGE_SIZE >= MAX_PAGES)
+            return nullptr;
+        Slot* page = m_pages[index / PAGE_SIZE].load(std::memory_order_acquire);
+        return page ? &page[index % PAGE_SIZE] : nullptr;
+    }
+
+    /**
+     * Gives the next page to 'shard', with its mutex held. Pages are allocated when claimed and
+     * never freed nor moved until the registry is destroyed
+     */
+    bool claimPage(Shard& shard, uint32_t shard_id)
+    {
+        uint32_t page = m_next_page.fetch_add(1, std::memory_order_relaxed);
+        if (page >= MAX_PAGES)
+        {
+            m_next_page.store(MAX_PAGES, std::memory_order_relaxed);
+            return false;
+        }
+        // Read by remove(), after the ALIVE bit of a slot of the page was published
+        m_page_shard[page] = uint8_t(shard_id);
+        m_pages[page].store(new Slot[PAGE_SIZE], std::memory_order_release);
+        shard.next = page * PAGE_SIZE;
+        shard.end  = shard.next + PAGE_SIZE;
+        return true;
+    }
+
+    std::array<std::atomic<Slot*>, MAX_PAGES> m_pages{};
+    std::array<uint8_t, MAX_PAGES>            m_page_shard{};
+    std::atomic<uint32_t>                     m_next_page{0};
+    std::array<Shard, SHARDS>                 m_shards;
+    std::atomic<std::size_t>                  m_size{0};
+    std::atomic<std::size_t>                  m_dropped{0};
+};
+
+#endif
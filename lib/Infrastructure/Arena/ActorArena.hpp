@@ -0,0 +1,240 @@
+#ifndef __ACTORARENA_H_
+#define __ACTORARENA_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Pool allocator owned by one actor, for the events it creates and the data it keeps. Blocks
+ * come in a few size classes carved from 64 KiB chunks, and freed blocks are reused for the same
+ * class, so that a steady state makes no heap allocation at all.
+ * Only the owner thread allocates. Any thread may free: the owner puts the block straight back
+ * on its free list, other threads (typically the actors the event was sent to) push it on a
+ * lock-free remote-free list, which the owner takes back in one exchange when a free list runs
+ * dry. The arena must outlive every block allocated from it
+ */
+class ActorArena
+{
+   public:
+    static constexpr std::size_t CLASSES     = 5;    // Blocks of 32, 64, 128, 256, 512 bytes
+    static constexpr std::size_t LARGEST     = 512;  // Larger ones go to the global heap
+    static constexpr std::size_t CHUNK_SIZE  = 64 * 1024;
+    static constexpr std::size_t HEADER_SIZE = 16;  // Keeps payloads 16-byte aligned
+
+    struct Stats
+    {
+        uint64_t allocations{0};   // Blocks handed out
+        uint64_t remote_frees{0};  // Blocks freed by other threads, taken back by the owner
+        uint64_t heap{0};          // Chunks and large blocks requested from the global heap
+    };
+
+    // Owned by the calling thread until bind() is called
+    ActorArena() : m_owner{std::this_thread::get_id()}
+    {
+    }
+
+    ~ActorArena()
+    {
+        for (void* chunk : m_chunks)
+            ::operator delete(chunk);
+    }
+
+    ActorArena(const ActorArena&)            = delete;
+    ActorArena& operator=(const ActorArena&) = delete;
+
+    // Makes the calling thread the owner, e.g. first thing in the actor's run loop
+    void bind()
+    {
+        m_owner.store(std::this_thread::get_id(), std::memory_order_release);
+    }
+
+    // Owner thread only
+    void* allocate(std::size_t size)
+    {
+        m_stats.allocations++;
+        std::size_t size_class = classOf(size);
+        if (size_class == LARGE)
+        {
+            m_stats.heap++;
+            auto* header = static_cast<Header*>(::operator new(HEADER_SIZE + size));
+            header->arena      = this;
+            header->size_class = LARGE;
+            return payload(header);
+        }
+        Header* header = m_free[size_class];
+        if (!header)
+        {
+            takeRemoteFrees();
+            header = m_free[size_class];
+            if (!header)
+                header = carve(size_class);
+        }
+        m_free[size_class] = header->next;
+        header->arena      = this;
+        return payload(header);
+    }
+
+    // Any thread, for a block of any ActorArena
+    static void deallocate(void* memory)
+    {
+        Header*     header = reinterpret_cast<Header*>(static_cast<char*>(memory) - HEADER_SIZE);
+        ActorArena* arena  = header->arena;
+        if (header->size_class == LARGE)
+        {
+            ::operator delete(header);
+            return;
+        }
+        if (std::this_thread::get_id() == arena->m_owner.load(std::memory_order_acquire))
+        {
+            header->next                      = arena->m_free[header->size_class];
+            arena->m_free[header->size_class] = header;
+            return;
+        }
+        Header* head = arena->m_remote.load(std::memory_order_relaxed);
+        do
+        {
+            header->next = head;
+        } while (!arena->m_remote.compare_exchange_weak(head, header, std::memory_order_release,
+                                                         std::memory_order_relaxed));
+    }
+
+    /**
+     * Standard allocator drawing from an arena, e.g. for the containers of the actor's data. Its
+     * rebound copies share the arena, so allocate_shared() puts the control block there too
+     */
+    template <class T>
+    class Allocator
+    {
+       public:
+        using value_type = T;
+
+        explicit Allocator(ActorArena& arena) : m_arena{&arena}
+        {
+        }
+        template <class U>
+        Allocator(const Allocator<U>& other) : m_arena{other.arena()}
+        {
+        }
+
+        T* allocate(std::size_t count)
+        {
+            static_assert(alignof(T) <= HEADER_SIZE, "over-aligned types are not supported");
+            return static_cast<T*>(m_arena->allocate(count * sizeof(T)));
+        }
+        void deallocate(T* memory, std::size_t)
+        {
+            ActorArena::deallocate(memory);
+        }
+
+        ActorArena* arena() const
+        {
+            return m_arena;
+        }
+        template <class U>
+        bool operator==(const Allocator<U>& other) const
+        {
+            return m_arena == other.arena();
+        }
+
+       private:
+        ActorArena* m_arena;
+    };
+
+    // Owner thread only: the event and its control block in one arena block
+    template <class E, class... Args>
+    std::shared_ptr<E> make(Args&&... args)
+    {
+        return std::allocate_shared<E>(Allocator<E>(*this), std::forward<Args>(args)...);
+    }
+
+    // Owner thread only
+    Stats stats() const
+    {
+        return m_stats;
+    }
+
+   private:
+    static constexpr uint32_t LARGE = 0xFFFFFFFF;
+
+    struct Header
+    {
+        union
+        {
+            ActorArena* arena;  // While allocated
+            Header*     next;   // While on a free list
+        };
+        uint32_t size_class;
+    };
+    static_assert(sizeof(Header) <= HEADER_SIZE);
+
+    static std::size_t classOf(std::size_t size)
+    {
+        std::size_t block = 32;
+        for (std::size_t size_class = 0; size_class < CLASSES; size_class++, block *= 2)
+        {
+            if (size <= block)
+                return size_class;
+        }
+        return LARGE;
+    }
+
+    static void* payload(Header* header)
+    {
+        return reinterpret_cast<char*>(header) + HEADER_SIZE;
+    }
+
+    // Pushes the blocks freed by other threads back on the free lists
+    void takeRemoteFrees()
+    {
+        Header* header = m_remote.exchange(nullptr, std::memory_order_acquire);
+        while (header)
+        {
+            Header* next               = header->next;
+            header->next               = m_free[header->size_class];
+            m_free[header->size_class] = header;
+            header                     = next;
+            m_stats.remote_frees++;
+        }
+    }
+
+    // Cuts the rest of the current chunk (or a new one) into blocks of 'size_class'
+    Header* carve(std::size_t size_class)
+    {
+        const std::size_t block = HEADER_SIZE + (std::size_t(32) << size_class);
+        if (m_chunk_left < block)
+        {
+            m_stats.heap++;
+            m_chunks.push_back(::operator new(CHUNK_SIZE));
+            m_chunk_next = static_cast<char*>(m_chunks.back());
+            m_chunk_left = CHUNK_SIZE;
+        }
+        // A handful of blocks at a time, so that a class used once does not take a whole chunk
+        for (std::size_t i = 0; i < 8 && m_chunk_left >= block; i++)
+        {
+            auto* header       = reinterpret_cast<Header*>(m_chunk_next);
+            header->size_class = uint32_t(size_class);
+            header->next       = m_free[size_class];
+            m_free[size_class] = header;
+            m_chunk_next += block;
+            m_chunk_left -= block;
+        }
+        return m_free[size_class];
+    }
+
+    std::atomic<std::thread::id>     m_owner;  // bind() may race with a remote deallocate()
+    std::array<Header*, CLASSES>     m_free{};
+    std::vector<void*>               m_chunks;
+    char*                            m_chunk_next{nullptr};
+    std::size_t                      m_chunk_left{0};
+    Stats                            m_stats;
+    alignas(64) std::atomic<Header*> m_remote{nullptr};  // Written by the other threads
+};
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef __ALLOCATIONPROFILE_H_
+#define __ALLOCATIONPROFILE_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#include <boost/core/demangle.hpp>
+
+/**
+ * Heap allocations of the calling thread. They are only counted in programs including
+ * CountGlobalAllocations.hpp (in a single translation unit), and stay at zero otherwise
+ */
+namespace Allocation
+{
+struct Counters
+{
+    uint64_t allocations{0};
+    uint64_t bytes{0};
+};
+
+inline thread_local Counters t_counters{};
+
+inline Counters threadCounters()
+{
+    return t_counters;
+}
+
+inline Counters operator-(const Counters& a, const Counters& b)
+{
+    return Counters{a.allocations - b.allocations, a.bytes - b.bytes};
+}
+
+inline Counters& operator+=(Counters& a, const Counters& b)
+{
+    a.allocations += b.allocations;
+    a.bytes += b.bytes;
+    return a;
+}
+
+// Heap allocations made by the calling thread since the Span was created
+class Span
+{
+   public:
+    Span() : m_start{t_counters}
+    {
+    }
+    Counters elapsed() const
+    {
+        return t_counters - m_start;
+    }
+
+   private:
+    Counters m_start;
+};
+}  // namespace Allocation
+
+/**
+ * Heap allocations of one actor, per type of the event being processed. Its run loop wraps every
+ * step in a Step (a nullptr profile counts nothing):
+ *   AllocationProfile::Step step(m_profile, *event);
+ *   m_state_manager->processEvent(event);
+ * which tells which handler allocates, and lets a benchmark assert it does not. Only read and
+ * written on the actor's thread
+ */
+class AllocationProfile
+{
+   public:
+    class Step
+    {
+       public:
+        template <class Event>
+        Step(AllocationProfile* profile, const Event& event)
+            : m_profile{profile}, m_event{profile ? &typeid(event) : nullptr}
+        {
+        }
+        ~Step()
+        {
+            if (m_profile)
+                m_profile->add(*m_event, m_span.elapsed());
+        }
+        Step(const Step&)            = delete;
+        Step& operator=(const Step&) = delete;
+
+       private:
+        AllocationProfile*    m_profile;
+        const std::type_info* m_event;
+        Allocation::Span      m_span;
+    };
+
+    struct Entry
+    {
+        std::string          event;  // Demangled type name
+        uint64_t             steps;
+        Allocation::Counters heap;
+    };
+
+    void add(const std::type_info& event, const Allocation::Counters& heap)
+    {
+        auto& entry = m_by_type[std::type_index(event)];
+        entry.first++;
+        entry.second += heap;
+        m_total += heap;
+    }
+
+    Allocation::Counters total() const
+    {
+        return m_total;
+    }
+
+    // Allocations while processing events of type E
+    template <class E>
+    Allocation::Counters of() const
+    {
+        auto found = m_by_type.find(std::type_index(typeid(E)));
+        return found == m_by_type.end() ? Allocation::Counters{} : found->second.second;
+    }
+
+    // Most allocating event types first
+    std::vector<Entry> byEventType() const
+    {
+        std::vector<Entry> result;
+        for (auto& [type, entry] : m_by_type)
+            result.push_back({boost::core::demangle(type.name()), entry.first, entry.second});
+        std::sort(result.begin(), result.end(), [](const Entry& a, const Entry& b)
+                  { return a.heap.allocations > b.heap.allocations; });
+        return result;
+    }
+
+   private:
+    std::map<std::type_index, std::pair<uint64_t, Allocation::Counters>> m_by_type;
+    Allocation::Counters                                                 m_total;
+};
+
+#endif
@@ -0,0 +1,249 @@
+#ifndef __ASK_H_
+#define __ASK_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include "IEvent/IEvent.hpp"
+#include "BoostDeadlineTimer/BoostDeadlineTimer.hpp"
+
+enum class AskStatus
+{
+    pending,
+    ready,
+    timeout
+};
+
+template <typename Reply>
+class Future;
+
+template <typename R, typename Post>
+Future<typename R::t_reply> ask(Post&& post, std::shared_ptr<R> request,
+                                std::chrono::milliseconds timeout = std::chrono::milliseconds{0});
+
+template <typename R, typename Post>
+Future<typename R::t_reply> ask(Clock& clock, Post&& post, std::shared_ptr<R> request,
+                                std::chrono::milliseconds timeout);
+
+/**
+ * Base class of every event that expects a reply.
+ * The reply slot lives inside the request itself, so asking costs exactly the allocation of the
+ * request event (the same as any fire-and-forget event) and the future only shares ownership of it
+ */
+template <typename Reply>
+class Request : public IEvent, public std::enable_shared_from_this<Request<Reply>>
+{
+   public:
+    using t_reply        = Reply;
+    using t_continuation = std::function<void(Future<Reply>)>;
+
+    virtual ~Request() = default;
+
+    uint64_t correlationId() const
+    {
+        return m_correlation_id;
+    }
+
+    /**
+     * Called by the target actor. Returns false if the request was already completed (i.e. it
+     * timed out or was answered before), in which case the value is discarded
+     */
+    bool reply(Reply value)
+    {
+        return complete(AskStatus::ready, std::move(value));
+    }
+
+   protected:
+    Request() : m_correlation_id{nextCorrelationId()}
+    {
+    }
+
+   private:
+    friend class Future<Reply>;
+
+    template <typename R, typename Post>
+    friend Future<typename R::t_reply> ask(Clock& clock, Post&& post, std::shared_ptr<R> request,
+                                           std::chrono::milliseconds timeout);
+
+    static uint64_t nextCorrelationId()
+    {
+        static std::atomic<uint64_t> counter{0};
+        return ++counter;
+    }
+
+    bool complete(AskStatus status, std::optional<Reply> value)
+    {
+        AskStatus expected = AskStatus::pending;
+        if (!m_claimed.compare_exchange_strong(expected, status))
+            return false;
+
+        t_continuation continuation;
+        {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+            m_reply  = std::move(value);
+            m_status = status;
+            std::swap(continuation, m_continuation);
+        }
+        m_cv.notify_all();
+
+        // A fired or not yet recorded timer is simply not found by the clock
+        if (uint64_t timer = m_timer.exchange(0))
+            m_clock->cancel(timer);
+
+        if (continuation)
+            continuation(Future<Reply>(this->shared_from_this()));
+        return true;
+    }
+
+    void armTimeout(Clock& clock, std::chrono::milliseconds timeout)
+    {
+        m_clock = &clock;
+        m_timer = clock.schedule(clock.now() + timeout,
+                                 [self = this->shared_from_this()]()
+                                 { self->complete(AskStatus::timeout, std::nullopt); });
+    }
+
+    const uint64_t                           m_correlation_id;
+    std::atomic<AskStatus>                   m_claimed{AskStatus::pending};
+    AskStatus                                m_status{AskStatus::pending};
+    std::optional<Reply>                     m_reply;
+    t_continuation                           m_continuation;
+    std::mutex                               m_mutex;
+    std::condition_variable                  m_cv;
+    Clock*                                   m_clock{nullptr};
+    std::atomic<uint64_t>                    m_timer{0};  // Clock timer id, 0 if none
+};
+
+/**
+ * Lightweight handle to the reply of a Request. It only holds a reference to the request event
+ */
+template <typename Reply>
+class Future
+{
+   public:
+    Future() = default;
+    explicit Future(std::shared_ptr<Request<Reply>> request) : m_request{std::move(request)}
+    {
+    }
+
+    bool valid() const
+    {
+        return m_request != nullptr;
+    }
+
+    uint64_t correlationId() const
+    {
+        return m_request->correlationId();
+    }
+
+    AskStatus status() const
+    {
+        std::scoped_lock<std::mutex> lock(m_request->m_mutex);
+        return m_request->m_status;
+    }
+
+    bool ready() const
+    {
+        return status() != AskStatus::pending;
+    }
+
+    // Blocks until the request is replied or timed out. Empty on timeout
+    std::optional<Reply> get() const
+    {
+        std::unique_lock<std::mutex> lock(m_request->m_mutex);
+        m_request->m_cv.wait(lock, [&]() { return m_request->m_status != AskStatus::pending; });
+        return m_request->m_reply;
+    }
+
+    // Same as get(), but gives up waiting after 'timeout' (the request itself stays pending)
+    std::optional<Reply> get_for(const std::chrono::milliseconds& timeout) const
+    {
+        std::unique_lock<std::mutex> lock(m_request->m_mutex);
+        m_request->m_cv.wait_for(lock, timeout,
+                                 [&]() { return m_request->m_status != AskStatus::pending; });
+        return m_request->m_reply;
+    }
+
+    /**
+     * Registers an asynchronous continuation. It runs on the thread that completes the request
+     * (the replier's thread, or the clock's thread on timeout), or right away if already complete.
+     * Use then_post() to have the continuation executed by the asking actor instead
+     */
+    void then(typename Request<Reply>::t_continuation continuation)
+    {
+        {
+            std::scoped_lock<std::mutex> lock(m_request->m_mutex);
+            if (m_request->m_status == AskStatus::pending)
+            {
+                m_request->m_continuation = std::move(continuation);
+                return;
+            }
+        }
+        continuation(*this);
+    }
+
+    /**
+     * Once completed, the request event itself is posted back through 'post' (e.g. the asking
+     * actor's callback_IEvent). The asker's states handle it like any other event and match it
+     * by its correlationId(), without keeping a correlation map
+     */
+    template <typename Post>
+    void then_post(Post&& post)
+    {
+        then([post = std::forward<Post>(post)](Future<Reply> future)
+             { post(std::static_pointer_cast<IEvent>(future.m_request)); });
+    }
+
+    const std::shared_ptr<Request<Reply>>& request() const
+    {
+        return m_request;
+    }
+
+   private:
+    std::shared_ptr<Request<Reply>> m_request;
+};
+
+/**
+ * Posts 'request' through 'post' (anything callable with an IEvent_ptr, e.g. a SignatureIEvent or
+ * a bound callback_IEvent) and returns the future of its reply.
+ * A non-zero 'timeout' is armed on the SteadyClock and completes the request with
+ * AskStatus::timeout if the target does not reply in time
+ */
+template <typename R, typename Post>
+Future<typename R::t_reply> ask(Post&& post, std::shared_ptr<R> request,
+                                std::chrono::milliseconds timeout)
+{
+    if (timeout.count() > 0)
+        return ask(SteadyClock::instance(), std::forward<Post>(post), std::move(request), timeout);
+
+    post(std::static_pointer_cast<IEvent>(request));
+    return Future<typename R::t_reply>(std::move(request));
+}
+
+/**
+ * Same as above, with the timeout armed on 'clock', e.g. the VirtualClock of a Simulation
+ */
+template <typename R, typename Post>
+Future<typename R::t_reply> ask(Clock& clock, Post&& post, std::shared_ptr<R> request,
+                                std::chrono::milliseconds timeout)
+{
+    using Reply = typename R::t_reply;
+    std::shared_ptr<Request<Reply>> base = request;
+
+    if (timeout.count() > 0)
+    {
+        // Armed before posting, so that the timer exists before anyone can reply
+        base->armTimeout(clock, timeout);
+    }
+
+    post(std::static_pointer_cast<IEvent>(request));
+    return Future<Reply>(std::move(base));
+}
+
+#endif
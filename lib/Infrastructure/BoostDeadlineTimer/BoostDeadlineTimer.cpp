@@ -0,0 +1,83 @@
+#include "BoostDeadlineTimer/BoostDeadlineTimer.hpp"
+
+TimerService& TimerService::instance()
+{
+    static TimerService service;
+    return service;
+}
+
+TimerService::TimerService()
+    : m_work{boost::asio::make_work_guard(m_context)}, m_clock{new SteadyClock(m_context)}
+{
+    LOG_TMR(LEVEL_DEBUG) << __PRETTY_FUNCTION__ << std::endl;
+    m_thread = std::thread([this]() { m_context.run(); });
+}
+
+// The thread is joined before the clock, then the context, are destroyed
+TimerService::~TimerService()
+{
+    m_work.reset();
+    m_context.stop();
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+SteadyClock& SteadyClock::instance()
+{
+    return TimerService::instance().clock();
+}
+
+SteadyClock::SteadyClock(boost::asio::io_context& context) : m_context{context}
+{
+}
+
+Clock::t_time SteadyClock::now() const
+{
+    return std::chrono::steady_clock::now().time_since_epoch();
+}
+
+uint64_t SteadyClock::schedule(t_time deadline, t_callback callback)
+{
+    auto     timer = std::make_shared<boost::asio::steady_timer>(m_context);
+    uint64_t id;
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        id = ++m_last_id;
+        m_timers.emplace(id, timer);
+    }
+
+    // The asio timer is only ever touched from the service thread
+    boost::asio::post(m_context,
+                      [this, timer, deadline, id, callback = std::move(callback)]() mutable
+                      {
+                          timer->expires_at(std::chrono::steady_clock::time_point(
+                              std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                  deadline)));
+                          timer->async_wait(
+                              [this, id, callback = std::move(callback)](
+                                  const boost::system::error_code& ec)
+                              {
+                                  {
+                                      std::scoped_lock<std::mutex> lock(m_mutex);
+                                      m_timers.erase(id);
+                                  }
+                                  if (ec != boost::asio::error::operation_aborted)
+                                      callback();
+                              });
+                      });
+    return id;
+}
+
+void SteadyClock::cancel(uint64_t id)
+{
+    std::shared_ptr<boost::asio::steady_timer> timer;
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        auto                         found = m_timers.find(id);
+        if (found == m_timers.end())
+            return;
+        timer = std::move(found->second);
+        m_timers.erase(found);
+    }
+    boost::asio::post(m_context, [timer]() { timer->cancel(); });
+}
@@ -0,0 +1,214 @@
+#ifndef __BOOSTDEADLINETIMER_H_
+#define __BOOSTDEADLINETIMER_H_
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include <boost/asio.hpp>
+#include <boost/bind/bind.hpp>
+
+#include "BoostDeadlineTimer/Clock.hpp"
+#include "Logger/Logger.hpp"
+
+#define LOG_TMR(lvl) (LOG("BoostDeadlineTimer.hpp", lvl))
+
+class SteadyClock;
+
+/**
+ * Centralized timer infrastructure: a single io_context serviced by a single thread.
+ * Every DeadlineTimer (and every timed-out request) is armed on this context, so objects never
+ * need to block their own threads with std::this_thread::sleep_for().
+ * Owns the SteadyClock, whose handlers refer to it, so that the clock outlives the thread
+ */
+class TimerService
+{
+   public:
+    static TimerService& instance();
+
+    boost::asio::io_context& context()
+    {
+        return m_context;
+    }
+
+    SteadyClock& clock()
+    {
+        return *m_clock;
+    }
+
+    ~TimerService();
+
+   private:
+    TimerService();
+
+    boost::asio::io_context                                                  m_context;
+    std::optional<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> m_work;
+    std::unique_ptr<SteadyClock>                                             m_clock;
+    std::thread                                                              m_thread;
+};
+
+/**
+ * Wall-clock Clock: std::chrono::steady_clock time, timers armed on the TimerService
+ */
+class SteadyClock : public Clock
+{
+   public:
+    static SteadyClock& instance();
+
+    virtual t_time   now() const override;
+    virtual uint64_t schedule(t_time deadline, t_callback callback) override;
+    virtual void     cancel(uint64_t id) override;
+
+   private:
+    friend class TimerService;
+
+    explicit SteadyClock(boost::asio::io_context& context);
+
+    boost::asio::io_context&                                                m_context;
+    std::mutex                                                              m_mutex;
+    uint64_t                                                                m_last_id{0};
+    std::unordered_map<uint64_t, std::shared_ptr<boost::asio::steady_timer>> m_timers;
+};
+
+/**
+ * One-shot or cyclic timer calling 'callback' from the thread of its Clock: the TimerService
+ * thread by default, the simulation thread on a VirtualClock
+ */
+class DeadlineTimer
+{
+   public:
+    enum class Status
+    {
+        stopped,
+        running
+    };
+
+    DeadlineTimer(long period, std::function<void()> callback, bool cyclic = false)
+        : DeadlineTimer(SteadyClock::instance(), period, std::move(callback), cyclic)
+    {
+    }
+
+    DeadlineTimer(Clock& clock, long period, std::function<void()> callback, bool cyclic = false)
+        : m_state{std::make_shared<State>(clock, period, std::move(callback), cyclic)}
+    {
+    }
+
+    ~DeadlineTimer()
+    {
+        stop();
+    }
+
+    DeadlineTimer(const DeadlineTimer&)            = delete;
+    DeadlineTimer& operator=(const DeadlineTimer&) = delete;
+
+    // (Re)start with the period and cyclic configuration currently stored
+    void start()
+    {
+        std::scoped_lock<std::recursive_mutex> lock(m_state->mutex);
+        arm(m_state);
+    }
+
+    // (Re)start with a new period, keeping the cyclic configuration
+    void start(long period)
+    {
+        std::scoped_lock<std::recursive_mutex> lock(m_state->mutex);
+        m_state->period = period;
+        arm(m_state);
+    }
+
+    // (Re)start with a new period and cyclic configuration
+    void start(long period, bool cyclic)
+    {
+        std::scoped_lock<std::recursive_mutex> lock(m_state->mutex);
+        m_state->period = period;
+        m_state->cyclic = cyclic;
+        arm(m_state);
+    }
+
+    void stop()
+    {
+        std::scoped_lock<std::recursive_mutex> lock(m_state->mutex);
+        m_state->generation++;
+        m_state->status = Status::stopped;
+        cancelPending(*m_state);
+    }
+
+    Status status() const
+    {
+        return m_state->status;
+    }
+
+   private:
+    /* Shared with the pending callbacks so that they never outlive the data they refer to */
+    struct State
+    {
+        State(Clock& clk, long p, std::function<void()> cb, bool c)
+            : clock{clk}, period{p}, cyclic{c}, callback{std::move(cb)}
+        {
+        }
+
+        Clock&                clock;
+        long                  period;
+        bool                  cyclic;
+        std::function<void()> callback;
+        std::atomic<Status>   status{Status::stopped};
+        unsigned long         generation{0};
+        Clock::t_time         deadline{0};
+        uint64_t              pending{0};  // Id of the scheduled clock timer, 0 if none
+        std::recursive_mutex  mutex;
+    };
+
+    /* Must be called with state->mutex held */
+    static void arm(const std::shared_ptr<State>& state)
+    {
+        cancelPending(*state);
+        unsigned long generation = ++state->generation;
+        state->status            = Status::running;
+        state->deadline          = state->clock.now() + std::chrono::milliseconds(state->period);
+        wait(state, generation);
+    }
+
+    /* Must be called with state->mutex held */
+    static void wait(const std::shared_ptr<State>& state, unsigned long generation)
+    {
+        state->pending = state->clock.schedule(
+            state->deadline,
+            [state, generation]()
+            {
+                std::scoped_lock<std::recursive_mutex> lock(state->mutex);
+                if (generation != state->generation)
+                    return;  // restarted or stopped in the meantime
+
+                state->pending = 0;
+                if (state->cyclic)
+                {
+                    // From the previous deadline, so that the period does not drift
+                    state->deadline += std::chrono::milliseconds(state->period);
+                    wait(state, generation);
+                }
+                else
+                {
+                    state->status = Status::stopped;
+                }
+                state->callback();
+            });
+    }
+
+    /* Must be called with state.mutex held */
+    static void cancelPending(State& state)
+    {
+        if (state.pending != 0)
+            state.clock.cancel(state.pending);
+        state.pending = 0;
+    }
+
+    std::shared_ptr<State> m_state;
+};
+
+#endif
@@ -0,0 +1,131 @@
+#ifndef __CLOCK_H_
+#define __CLOCK_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * Source of time and one-shot timers for the actor runtime. The wall-clock implementation is
+ * SteadyClock (BoostDeadlineTimer.hpp); VirtualClock only moves when told to, so that a
+ * simulation can jump straight to the next due timer
+ */
+class Clock
+{
+   public:
+    using t_time     = std::chrono::nanoseconds;  // Since the clock's epoch
+    using t_callback = std::function<void()>;
+
+    virtual ~Clock() = default;
+
+    virtual t_time now() const = 0;
+
+    /**
+     * Calls 'callback' once the clock reaches 'deadline', unless cancel()led first. Returns the
+     * (non-zero) id to cancel it with. Callbacks run on the clock's own thread: the timer service
+     * thread for SteadyClock, the thread advancing a VirtualClock
+     */
+    virtual uint64_t schedule(t_time deadline, t_callback callback) = 0;
+
+    virtual void cancel(uint64_t id) = 0;
+};
+
+/**
+ * Clock for discrete-event simulation: time starts at 0 and stands still until advanced, firing
+ * the due timers in deadline order (then scheduling order). Timers scheduled in the past are due
+ * right away
+ */
+class VirtualClock : public Clock
+{
+   public:
+    static constexpr t_time NEVER = t_time{std::numeric_limits<t_time::rep>::max()};
+
+    virtual t_time now() const override
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        return m_now;
+    }
+
+    virtual uint64_t schedule(t_time deadline, t_callback callback) override
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        uint64_t                     id = ++m_last_id;
+        m_due.emplace(std::make_pair(deadline, id), std::move(callback));
+        m_deadline.emplace(id, deadline);
+        return id;
+    }
+
+    virtual void cancel(uint64_t id) override
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        auto                         found = m_deadline.find(id);
+        if (found == m_deadline.end())
+            return;
+        m_due.erase(std::make_pair(found->second, id));
+        m_deadline.erase(found);
+    }
+
+    // Deadline of the earliest pending timer, NEVER if there is none
+    t_time nextDeadline() const
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        return m_due.empty() ? NEVER : std::max(m_due.begin()->first.first, m_now);
+    }
+
+    /**
+     * Moves the clock to the earliest pending timer, if due no later than 'limit', and fires it.
+     * Returns false (leaving the clock untouched) if there is no such timer
+     */
+    bool fireNext(t_time limit = NEVER)
+    {
+        t_callback callback;
+        {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+            if (m_due.empty() || m_due.begin()->first.first > limit)
+                return false;
+            auto first = m_due.begin();
+            m_now      = std::max(m_now, first->first.first);
+            callback   = std::move(first->second);
+            m_deadline.erase(first->first.second);
+            m_due.erase(first);
+        }
+        callback();
+        return true;
+    }
+
+    // Fires every timer due up to 'time', then moves the clock to 'time'
+    void advanceTo(t_time time)
+    {
+        while (fireNext(time))
+        {
+        }
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        m_now = std::max(m_now, time);
+    }
+
+    void advanceBy(t_time duration)
+    {
+        advanceTo(now() + duration);
+    }
+
+    std::size_t pending() const
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        return m_due.size();
+    }
+
+   private:
+    mutable std::mutex                                m_mutex;
+    t_time                                            m_now{0};
+    uint64_t                                          m_last_id{0};
+    std::map<std::pair<t_time, uint64_t>, t_callback> m_due;
+    std::unordered_map<uint64_t, t_time>              m_deadline;
+};
+
+#endif
@@ -0,0 +1,266 @@
+#ifndef __BROADCAST_H_
+#define __BROADCAST_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "IEvent/IEvent.hpp"
+
+class LockFreeMailbox;
+
+/**
+ * Wake-up word of the thread serving one or more LockFreeMailboxes. A thread owning several
+ * mailboxes binds them to one worker, reads ticket(), checks every mailbox and then waits on
+ * that ticket; producers, and broadcast() once per worker, bump it when a mailbox turns non-empty
+ */
+class MailboxWorker
+{
+   public:
+    uint32_t ticket() const
+    {
+        return m_ticket.load(std::memory_order_acquire);
+    }
+
+    // Returns once the ticket moved past 'seen'
+    void wait(uint32_t seen) const
+    {
+        m_ticket.wait(seen, std::memory_order_acquire);
+    }
+
+   private:
+    friend class LockFreeMailbox;
+    friend void broadcast(IEvent_ptr event, LockFreeMailbox* const* recipients, std::size_t count);
+
+    void wake()
+    {
+        m_ticket.fetch_add(1, std::memory_order_release);
+        m_ticket.notify_one();
+    }
+
+    std::atomic<uint32_t> m_ticket{0};
+};
+
+/**
+ * Lock-free multi-producer single-consumer mailbox (intrusive queue with a stub node, after
+ * D. Vyukov). Producers enqueue with one atomic exchange; the owning actor's thread is the only
+ * one allowed to pop.
+ * Queue nodes live in blocks shared by every recipient of the same event: broadcast() makes one
+ * allocation holding the event and one node per recipient, released by the last recipient that
+ * pops it
+ */
+class LockFreeMailbox
+{
+   public:
+    LockFreeMailbox() : LockFreeMailbox(nullptr)
+    {
+    }
+
+    // Mailboxes sharing 'worker' are served by one thread, woken through it
+    explicit LockFreeMailbox(MailboxWorker* worker)
+        : m_head{&m_stub}, m_tail{&m_stub}, m_worker{worker ? worker : &m_own}
+    {
+    }
+
+    ~LockFreeMailbox()
+    {
+        while (Node* node = take())
+            release(node);
+    }
+
+    LockFreeMailbox(const LockFreeMailbox&)            = delete;
+    LockFreeMailbox& operator=(const LockFreeMailbox&) = delete;
+
+    // May be called from any thread
+    void put(IEvent_ptr event)
+    {
+        Block* block = Block::make(std::move(event), 1);
+        push(&block->nodes()[0]);
+    }
+
+    // Owner thread only. Blocks until an event is available
+    IEvent_ptr wait_and_pop()
+    {
+        for (;;)
+        {
+            uint32_t seen = m_worker->ticket();
+            if (m_count.load(std::memory_order_acquire) != 0)
+                return pop();
+            m_worker->wait(seen);
+        }
+    }
+
+    // Owner thread only. nullptr if the mailbox is empty
+    IEvent_ptr try_pop()
+    {
+        if (m_count.load(std::memory_order_acquire) == 0)
+            return nullptr;
+        return pop();
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    // Number of queued events, may be read from any thread
+    std::size_t size() const
+    {
+        return m_count.load(std::memory_order_relaxed);
+    }
+
+   private:
+    friend void broadcast(IEvent_ptr event, LockFreeMailbox* const* recipients, std::size_t count);
+
+    struct Block;
+
+    struct Node
+    {
+        std::atomic<Node*> next{nullptr};
+        Block*             block{nullptr};
+    };
+
+    // One allocation: the header followed by 'count' nodes
+    struct Block
+    {
+        std::atomic<uint32_t> refs;
+        uint32_t              count;
+        IEvent_ptr            event;
+
+        Node* nodes()
+        {
+            return reinterpret_cast<Node*>(this + 1);
+        }
+
+        static Block* make(IEvent_ptr&& event, uint32_t count)
+        {
+            static_assert(sizeof(Block) % alignof(Node) == 0);
+            void*  memory = ::operator new(sizeof(Block) + count * sizeof(Node));
+            Block* block  = new (memory) Block{{count}, count, std::move(event)};
+            for (uint32_t i = 0; i < count; i++)
+                new (&block->nodes()[i]) Node{{nullptr}, block};
+            return block;
+        }
+
+        static void release(Block* block)
+        {
+            if (block->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                return;
+            for (uint32_t i = 0; i < block->count; i++)
+                block->nodes()[i].~Node();
+            block->~Block();
+            ::operator delete(block);
+        }
+    };
+
+    void push(Node* node)
+    {
+        if (enqueue(node))
+            m_worker->wake();
+    }
+
+    // Links 'node' without waking anyone; true if the mailbox was empty
+    bool enqueue(Node* node)
+    {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node* previous = m_head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+        return m_count.fetch_add(1, std::memory_order_release) == 0;
+    }
+
+    IEvent_ptr pop()
+    {
+        Node* node;
+        // A producer may be between its exchange and its link, the node shows up right after
+        while (!(node = take()))
+            std::this_thread::yield();
+        m_count.fetch_sub(1, std::memory_order_relaxed);
+        IEvent_ptr event = node->block->event;
+        release(node);
+        return event;
+    }
+
+    Node* take()
+    {
+        Node* tail = m_tail;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (tail == &m_stub)
+        {
+            if (!next)
+                return nullptr;
+            m_tail = next;
+            tail   = next;
+            next   = next->next.load(std::memory_order_acquire);
+        }
+        if (next)
+        {
+            m_tail = next;
+            return tail;
+        }
+        if (tail != m_head.load(std::memory_order_acquire))
+            return nullptr;
+
+        // 'tail' is the last node: the stub goes behind it, so that it can be unlinked
+        m_stub.next.store(nullptr, std::memory_order_relaxed);
+        Node* previous = m_head.exchange(&m_stub, std::memory_order_acq_rel);
+        previous->next.store(&m_stub, std::memory_order_release);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next)
+        {
+            m_tail = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
+    static void release(Node* node)
+    {
+        Block::release(node->block);
+    }
+
+    std::atomic<Node*>    m_head;
+    Node*                 m_tail;
+    Node                  m_stub;
+    std::atomic<uint32_t> m_count{0};
+    MailboxWorker         m_own;
+    MailboxWorker*        m_worker;
+};
+
+/**
+ * Delivers 'event' to every recipient with a single allocation: the event is stored once, with
+ * one reference per recipient, and each recipient gets its own node of the block, enqueued
+ * without any lock. Recipients are grouped by worker, so that a worker serving several of them
+ * is woken once
+ */
+inline void broadcast(IEvent_ptr event, LockFreeMailbox* const* recipients, std::size_t count)
+{
+    if (count == 0)
+        return;
+    auto* block = LockFreeMailbox::Block::make(std::move(event), uint32_t(count));
+
+    std::vector<LockFreeMailbox*> sorted(recipients, recipients + count);
+    std::sort(sorted.begin(), sorted.end(),
+              [](LockFreeMailbox* a, LockFreeMailbox* b)
+              { return std::less<MailboxWorker*>{}(a->m_worker, b->m_worker); });
+    for (std::size_t i = 0; i < count;)
+    {
+        MailboxWorker* worker = sorted[i]->m_worker;
+        bool           woken  = false;
+        for (; i < count && sorted[i]->m_worker == worker; i++)
+            woken |= sorted[i]->enqueue(&block->nodes()[i]);
+        if (woken)
+            worker->wake();
+    }
+}
+
+inline void broadcast(IEvent_ptr event, const std::vector<LockFreeMailbox*>& recipients)
+{
+    broadcast(std::move(event), recipients.data(), recipients.size());
+}
+
+#endif
@@ -0,0 +1,147 @@
+#include "CoroutineExecutor/CoroutineExecutor.hpp"
+
+#include <algorithm>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+EventLoop::EventLoop()
+{
+    m_epoll  = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    epoll_event ev{};
+    ev.events  = EPOLLIN;
+    ev.data.fd = m_wakeup;
+    epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeup, &ev);
+}
+
+EventLoop::~EventLoop()
+{
+    close(m_wakeup);
+    close(m_epoll);
+}
+
+void EventLoop::run()
+{
+    m_thread_id = std::this_thread::get_id();
+    m_running   = true;
+    while (m_running)
+    {
+        drainRemote();
+        while (!m_ready.empty())
+        {
+            std::coroutine_handle<> handle = m_ready.front();
+            m_ready.pop_front();
+            handle.resume();
+        }
+        drainRemote();
+        if (!m_ready.empty() || !m_running)
+            continue;
+
+        m_sleeping = true;
+        {
+            std::scoped_lock<std::mutex> lock(m_remote_mutex);
+            if (!m_remote.empty() || !m_running)
+            {
+                m_sleeping = false;
+                continue;
+            }
+        }
+        epoll_event ev;
+        if (epoll_wait(m_epoll, &ev, 1, -1) > 0)
+        {
+            uint64_t value;
+            (void) !read(m_wakeup, &value, sizeof(value));
+        }
+        m_sleeping = false;
+    }
+    m_thread_id = std::thread::id{};
+}
+
+void EventLoop::runUntilIdle()
+{
+    m_thread_id = std::this_thread::get_id();
+    do
+    {
+        drainRemote();
+        while (!m_ready.empty())
+        {
+            std::coroutine_handle<> handle = m_ready.front();
+            m_ready.pop_front();
+            handle.resume();
+        }
+        drainRemote();
+    } while (!m_ready.empty());
+    m_thread_id = std::thread::id{};
+}
+
+void EventLoop::stop()
+{
+    m_running = false;
+    wake();
+}
+
+void EventLoop::postRemote(Remote&& remote)
+{
+    {
+        std::scoped_lock<std::mutex> lock(m_remote_mutex);
+        m_remote.push_back(std::move(remote));
+    }
+    wake();
+}
+
+void EventLoop::wake()
+{
+    if (m_sleeping.exchange(false))
+    {
+        uint64_t one = 1;
+        (void) !write(m_wakeup, &one, sizeof(one));
+    }
+}
+
+void EventLoop::drainRemote()
+{
+    {
+        std::scoped_lock<std::mutex> lock(m_remote_mutex);
+        if (m_remote.empty())
+            return;
+        std::swap(m_remote, m_remote_swap);
+    }
+    for (Remote& remote : m_remote_swap)
+    {
+        if (remote.mailbox)
+            remote.mailbox->deliver(std::move(remote.event));
+        else
+            m_ready.push_back(remote.handle);
+    }
+    m_remote_swap.clear();
+}
+
+void broadcast(const IEvent_ptr& event, std::vector<Mailbox*> recipients)
+{
+    std::sort(recipients.begin(), recipients.end(),
+              [](Mailbox* a, Mailbox* b) { return &a->m_loop < &b->m_loop; });
+    for (auto first = recipients.begin(); first != recipients.end();)
+    {
+        EventLoop& loop = (*first)->m_loop;
+        auto       last = std::find_if(first, recipients.end(),
+                                       [&](Mailbox* mailbox) { return &mailbox->m_loop != &loop; });
+        if (loop.inLoopThread())
+        {
+            for (auto it = first; it != last; ++it)
+                (*it)->deliver(IEvent_ptr(event));
+        }
+        else
+        {
+            {
+                std::scoped_lock<std::mutex> lock(loop.m_remote_mutex);
+                for (auto it = first; it != last; ++it)
+                    loop.m_remote.push_back(EventLoop::Remote{*it, event, nullptr});
+            }
+            loop.wake();
+        }
+        first = last;
+    }
+}
@@ -0,0 +1,273 @@
+#ifndef __COROUTINEEXECUTOR_H_
+#define __COROUTINEEXECUTOR_H_
+
+#include <atomic>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "IEvent/IEvent.hpp"
+#include "Logger/Logger.hpp"
+
+#define LOG_COE(lvl) (LOG("CoroutineExecutor.hpp", lvl))
+
+/**
+ * Coroutine returned by an actor's run loop. It is created suspended, handed to an EventLoop to
+ * be started, and destroyed together with the actor that owns it
+ */
+class Task
+{
+   public:
+    struct promise_type
+    {
+        Task get_return_object()
+        {
+            return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+        std::suspend_always final_suspend() noexcept
+        {
+            return {};
+        }
+        void return_void()
+        {
+        }
+        void unhandled_exception()
+        {
+            // Same outcome as an exception escaping the run loop of a thread-per-actor object
+            std::terminate();
+        }
+    };
+
+    Task() = default;
+    explicit Task(std::coroutine_handle<promise_type> handle) : m_handle{handle}
+    {
+    }
+    Task(Task&& other) noexcept : m_handle{std::exchange(other.m_handle, nullptr)}
+    {
+    }
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (m_handle)
+                m_handle.destroy();
+            m_handle = std::exchange(other.m_handle, nullptr);
+        }
+        return *this;
+    }
+    ~Task()
+    {
+        if (m_handle)
+            m_handle.destroy();
+    }
+
+    std::coroutine_handle<> handle() const
+    {
+        return m_handle;
+    }
+
+    bool done() const
+    {
+        return !m_handle || m_handle.done();
+    }
+
+   private:
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+class Mailbox;
+
+/**
+ * Single-threaded scheduler for many actors. Every coroutine scheduled on the loop is resumed on
+ * the thread that calls run(), one at a time, so each resumption is a run-to-completion step.
+ * Other threads only ever touch the remote inbox, and wake the loop through an eventfd watched
+ * by epoll when (and only when) it is sleeping
+ */
+class EventLoop
+{
+   public:
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&)            = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // Blocks the calling thread, which becomes the loop thread, until stop() is called
+    void run();
+
+    /**
+     * Resumes ready coroutines on the calling thread until none is ready, instead of run(), for a
+     * caller driving the loop itself (e.g. a Simulation). Must not be mixed with run()
+     */
+    void runUntilIdle();
+
+    // May be called from any thread
+    void stop();
+
+    bool inLoopThread() const
+    {
+        return m_thread_id == std::this_thread::get_id();
+    }
+
+    // Resumes 'handle' on the loop thread. May be called from any thread
+    void schedule(std::coroutine_handle<> handle)
+    {
+        if (inLoopThread())
+            m_ready.push_back(handle);
+        else
+            postRemote(Remote{nullptr, nullptr, handle});
+    }
+
+    void start(Task& task)
+    {
+        schedule(task.handle());
+    }
+
+   private:
+    friend class Mailbox;
+    friend void broadcast(const IEvent_ptr& event, std::vector<Mailbox*> recipients);
+
+    struct Remote
+    {
+        Mailbox*                mailbox;
+        IEvent_ptr              event;
+        std::coroutine_handle<> handle;
+    };
+
+    void postRemote(Remote&& remote);
+    void wake();
+    void drainRemote();
+
+    int                                 m_epoll;
+    int                                 m_wakeup;
+    std::atomic_bool                    m_running{false};
+    std::atomic_bool                    m_sleeping{false};
+    std::atomic<std::thread::id>        m_thread_id{};
+    std::deque<std::coroutine_handle<>> m_ready;
+    std::mutex                          m_remote_mutex;
+    std::vector<Remote>                 m_remote;
+    std::vector<Remote>                 m_remote_swap;
+};
+
+/**
+ * Per-actor event queue for actors hosted on an EventLoop. Only the loop thread touches the
+ * queue itself, so it needs no mutex nor condition variable; puts from other threads go through
+ * the loop's remote inbox
+ */
+class Mailbox
+{
+   public:
+    // Number of events an actor may process in a row before yielding to the other actors
+    static constexpr unsigned int BUDGET = 16;
+
+    explicit Mailbox(EventLoop& loop) : m_loop{loop}
+    {
+    }
+
+    // May be called from any thread
+    void put(IEvent_ptr event)
+    {
+        if (m_loop.inLoopThread())
+            deliver(std::move(event));
+        else
+            m_loop.postRemote(EventLoop::Remote{this, std::move(event), nullptr});
+    }
+
+    // Loop thread only
+    bool empty() const
+    {
+        return m_queue.empty();
+    }
+
+    // Events delivered and not popped yet. May be called from any thread, e.g. by a Router
+    std::size_t size() const
+    {
+        return m_depth.load(std::memory_order_relaxed);
+    }
+
+    // Copy of the queued events, front first. Loop thread only
+    std::vector<IEvent_ptr> snapshot() const
+    {
+        return std::vector<IEvent_ptr>(m_queue.begin(), m_queue.end());
+    }
+
+    EventLoop& loop()
+    {
+        return m_loop;
+    }
+
+    class PopAwaiter
+    {
+       public:
+        explicit PopAwaiter(Mailbox& mailbox) : m_mailbox{mailbox}
+        {
+        }
+        bool await_ready()
+        {
+            if (m_mailbox.m_queue.empty() || m_mailbox.m_budget == 0)
+                return false;
+            m_mailbox.m_budget--;
+            return true;
+        }
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            m_mailbox.m_budget = BUDGET;
+            if (m_mailbox.m_queue.empty())
+                m_mailbox.m_waiter = handle;
+            else
+                m_mailbox.m_loop.schedule(handle);  // yield, there is more work queued
+        }
+        IEvent_ptr await_resume()
+        {
+            IEvent_ptr event = std::move(m_mailbox.m_queue.front());
+            m_mailbox.m_queue.pop_front();
+            m_mailbox.m_depth.fetch_sub(1, std::memory_order_relaxed);
+            return event;
+        }
+
+       private:
+        Mailbox& m_mailbox;
+    };
+
+    // co_await mailbox.pop() suspends the actor until an event is available
+    PopAwaiter pop()
+    {
+        return PopAwaiter{*this};
+    }
+
+   private:
+    friend class EventLoop;
+    friend void broadcast(const IEvent_ptr& event, std::vector<Mailbox*> recipients);
+
+    void deliver(IEvent_ptr&& event)
+    {
+        m_queue.push_back(std::move(event));
+        m_depth.fetch_add(1, std::memory_order_relaxed);
+        if (m_waiter)
+        {
+            m_loop.m_ready.push_back(std::exchange(m_waiter, nullptr));
+        }
+    }
+
+    EventLoop&               m_loop;
+    std::deque<IEvent_ptr>   m_queue;
+    std::atomic<std::size_t> m_depth{0};  // m_queue.size(), readable from other threads
+    std::coroutine_handle<>  m_waiter;
+    unsigned int             m_budget{BUDGET};
+};
+
+/**
+ * Delivers 'event' to every mailbox, grouped by the loop hosting them: the remote inbox of each
+ * loop is locked once for all of its recipients, and the loop woken up once
+ */
+void broadcast(const IEvent_ptr& event, std::vector<Mailbox*> recipients);
+
+#endif
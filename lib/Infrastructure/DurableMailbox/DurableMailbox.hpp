@@ -0,0 +1,457 @@
+#ifndef __DURABLEMAILBOX_H_
+#define __DURABLEMAILBOX_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "IEvent/IEvent.hpp"
+#include "Snapshot/Snapshot.hpp"
+
+/**
+ * Mailbox giving at-least-once processing across crashes. Every put() event is also appended to a
+ * ring of records in a memory-mapped file, and stays there until the consumer acknowledge()s it,
+ * i.e. once processEvent() returned:
+ *   IEvent_ptr event = mailbox.wait_and_pop();
+ *   state_manager.processEvent(event);
+ *   mailbox.acknowledge();
+ * Records reach the page cache with a memcpy, so they survive a crash of the process right away.
+ * Against a crash of the machine they are msync()ed in groups: every 'window' by a flusher thread,
+ * or by put() itself before it returns when the window is zero (concurrent producers then share
+ * one msync). On restart, the unacknowledged events are decoded and queued again, first
+ *
+ * File: a header page, then the ring. A record is [size][checksum][sequence][bytes], 8-byte
+ * aligned, and never wraps: a WRAP size sends the reader back to the start of the ring. Recovery
+ * reads from the acknowledged position while checksums and sequence numbers follow on, which
+ * stops it at the first torn or stale record without relying on a persisted write position. The
+ * acknowledged ring offset and the sequence number expected there share one 8-byte header word,
+ * stored at once, so a crash cannot leave one updated without the other; hence a capacity below
+ * 4 GiB
+ */
+class DurableMailbox
+{
+   public:
+    static constexpr uint32_t MAGIC   = 0x4d424458;  // "XDBM"
+    static constexpr uint32_t VERSION = 2;
+
+    DurableMailbox(const std::string& path, std::size_t capacity, Snapshot::EventCodec codec,
+                   std::chrono::milliseconds window = std::chrono::milliseconds{10})
+        : m_codec{std::move(codec)}, m_capacity{(capacity + 7) / 8 * 8}, m_window{window}
+    {
+        if (m_capacity > MAX_CAPACITY)
+            return;
+        m_fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (m_fd < 0)
+            return;
+        // A second mailbox on the same file, in this process or another one, is not valid
+        if (flock(m_fd, LOCK_EX | LOCK_NB) != 0)
+        {
+            close(std::exchange(m_fd, -1));
+            return;
+        }
+        std::size_t size = HEADER_SIZE + m_capacity;
+        struct stat info;
+        if (fstat(m_fd, &info) != 0)
+            return;
+        // Only a new, empty file gets a header. An existing one is never truncated nor extended
+        const bool created = (info.st_size == 0);
+        if (created ? ftruncate(m_fd, size) != 0 : std::size_t(info.st_size) < size)
+            return;
+        void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+        if (address == MAP_FAILED)
+            return;
+        m_map    = static_cast<uint8_t*>(address);
+        m_header = reinterpret_cast<Header*>(m_map);
+        m_ring   = m_map + HEADER_SIZE;
+
+        // A zero magic is a file whose header never made it to the disk, so it has no record yet
+        if (created || m_header->magic == 0)
+        {
+            *m_header = Header{MAGIC, VERSION, m_capacity, 0};
+            storeSize(0, WRAP);
+            msync(m_map, HEADER_SIZE + RECORD_HEADER, MS_SYNC);
+        }
+        else if (m_header->magic != MAGIC || m_header->version != VERSION
+                 || m_header->capacity != m_capacity || !recover())
+        {
+            // Unacknowledged events may be in there: the file is left as it is, for an operator
+            // (or a mailbox of the right capacity, with a codec that knows the events) to handle
+            munmap(m_map, size);
+            m_map    = nullptr;
+            m_header = nullptr;
+            m_ring   = nullptr;
+            return;
+        }
+        m_synced = m_written;
+        if (m_window.count() > 0)
+            m_flusher = std::thread(&DurableMailbox::flush, this);
+    }
+
+    ~DurableMailbox()
+    {
+        {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+            m_running = false;
+        }
+        m_flush_cv.notify_all();
+        m_space_cv.notify_all();
+        m_pop_cv.notify_all();
+        if (m_flusher.joinable())
+            m_flusher.join();
+        if (m_map)
+        {
+            sync();
+            munmap(m_map, HEADER_SIZE + m_capacity);
+        }
+        if (m_fd >= 0)
+            close(m_fd);
+    }
+
+    DurableMailbox(const DurableMailbox&)            = delete;
+    DurableMailbox& operator=(const DurableMailbox&) = delete;
+
+    /**
+     * False if the file could not be opened, locked or mapped, or if it holds a ring of another
+     * capacity or a record the codec cannot decode. The file is then left untouched
+     */
+    bool valid() const
+    {
+        return m_map != nullptr;
+    }
+
+    // Unacknowledged events found in the file when it was opened, queued first
+    std::size_t recovered() const
+    {
+        return m_recovered;
+    }
+
+    /**
+     * May be called from any thread. Waits while the ring is full of unacknowledged events.
+     * Returns false if the event was not queued: the codec refused it, or it is larger than the
+     * ring
+     */
+    bool put(const IEvent_ptr& event)
+    {
+        thread_local std::vector<uint8_t> payload;
+        payload.clear();
+        if (!m_map || !m_codec.encode(event, payload))
+            return false;
+        const std::size_t length = RECORD_HEADER + (payload.size() + 7) / 8 * 8;
+        if (length > m_capacity)
+            return false;
+        const uint32_t hash = checksum(payload.data(), payload.size());
+
+        uint64_t end;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_space_cv.wait(lock, [&]() { return room(length) || !m_running; });
+            if (!m_running)
+                return false;
+            uint64_t position = m_written;
+            if (position % m_capacity + length > m_capacity)
+            {
+                // Not enough room before the end of the ring
+                storeSize(position % m_capacity, WRAP);
+                position += m_capacity - position % m_capacity;
+            }
+            uint8_t* record = m_ring + position % m_capacity;
+            uint32_t size   = uint32_t(payload.size());
+            uint32_t sum    = hash ^ mix(m_sequence);
+            std::memcpy(record, &size, sizeof(size));
+            std::memcpy(record + 4, &sum, sizeof(sum));
+            std::memcpy(record + 8, &m_sequence, sizeof(m_sequence));
+            std::memcpy(record + RECORD_HEADER, payload.data(), payload.size());
+            m_sequence++;
+            m_written = end = position + length;
+            m_queue.push_back({event, end});
+        }
+        m_pop_cv.notify_one();
+        if (m_window.count() == 0)
+            syncUpTo(end);
+        return true;
+    }
+
+    // Consumer side. Blocks until an event is available; nullptr once the mailbox is destroyed
+    IEvent_ptr wait_and_pop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_pop_cv.wait(lock, [&]() { return !m_queue.empty() || !m_running; });
+        if (m_queue.empty())
+            return nullptr;
+        return pop();
+    }
+
+    // nullptr on timeout
+    IEvent_ptr wait_and_pop_for(const std::chrono::milliseconds& timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_pop_cv.wait_for(lock, timeout, [&]() { return !m_queue.empty(); }))
+            return nullptr;
+        return pop();
+    }
+
+    // Marks the oldest popped event as processed: it will not be delivered again after a restart
+    void acknowledge()
+    {
+        {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+            if (m_unacknowledged.empty())
+                return;
+            m_head = m_unacknowledged.front();
+            m_head_sequence++;
+            m_unacknowledged.pop_front();
+            std::atomic_ref<uint64_t>(m_header->acknowledged)
+                .store(pack(m_head % m_capacity, m_head_sequence), std::memory_order_release);
+        }
+        m_space_cv.notify_all();
+    }
+
+    // Events queued and not popped yet
+    std::size_t size()
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        return m_queue.size();
+    }
+
+    /**
+     * Makes every record written so far, and the acknowledgements, durable. Producers calling it
+     * at the same time share a single msync()
+     */
+    void sync()
+    {
+        uint64_t end;
+        {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+            end = m_written;
+        }
+        syncUpTo(end, true);
+    }
+
+   private:
+    static constexpr std::size_t HEADER_SIZE   = 4096;
+    static constexpr std::size_t RECORD_HEADER = 16;
+    static constexpr uint32_t    WRAP          = 0xFFFFFFFF;
+    static constexpr std::size_t MAX_CAPACITY  = std::size_t(1) << 32;
+
+    // Positions count bytes written since the file was opened, ring offset = position % capacity
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t capacity;
+        uint64_t acknowledged;  // pack() of the oldest unacknowledged record, or the next one
+    };
+
+    // [low 32 bits of the sequence number:32][ring offset:32]
+    static uint64_t pack(uint64_t offset, uint32_t sequence)
+    {
+        return (uint64_t(sequence) << 32) | offset;
+    }
+
+    struct Queued
+    {
+        IEvent_ptr event;
+        uint64_t   end;  // Position right after its record
+    };
+
+    static uint32_t checksum(const uint8_t* data, std::size_t size)
+    {
+        uint32_t hash = 2166136261u;  // FNV-1a
+        for (std::size_t i = 0; i < size; i++)
+            hash = (hash ^ data[i]) * 16777619u;
+        return hash;
+    }
+
+    // Binds a record to its sequence number, so that a stale record with the same bytes fails
+    static uint32_t mix(uint64_t sequence)
+    {
+        sequence *= 0x9E3779B97F4A7C15ull;
+        return uint32_t(sequence >> 32);
+    }
+
+    void storeSize(std::size_t offset, uint32_t size)
+    {
+        std::memcpy(m_ring + offset, &size, sizeof(size));
+    }
+
+    // Called with the lock held
+    bool room(std::size_t length) const
+    {
+        std::size_t padding = (m_written % m_capacity + length > m_capacity)
+                                  ? m_capacity - m_written % m_capacity
+                                  : 0;
+        return m_written + padding + length - m_head <= m_capacity;
+    }
+
+    // Called with the lock held
+    IEvent_ptr pop()
+    {
+        Queued queued = std::move(m_queue.front());
+        m_queue.pop_front();
+        m_unacknowledged.push_back(queued.end);
+        return queued.event;
+    }
+
+    // Decodes the records from the acknowledged position on. False if a record cannot be decoded
+    bool recover()
+    {
+        uint64_t acknowledged =
+            std::atomic_ref<uint64_t>(m_header->acknowledged).load(std::memory_order_acquire);
+        uint64_t position = uint32_t(acknowledged);
+        uint64_t sequence = acknowledged >> 32;
+        if (position >= m_capacity)
+            return false;
+        m_head          = position;
+        m_head_sequence = uint32_t(sequence);
+        while (true)
+        {
+            std::size_t offset = position % m_capacity;
+            uint32_t    size, sum;
+            uint64_t    record_sequence;
+            std::memcpy(&size, m_ring + offset, sizeof(size));
+            if (size == WRAP)
+            {
+                position += m_capacity - offset;
+                offset = 0;
+                std::memcpy(&size, m_ring, sizeof(size));
+            }
+            std::size_t length = RECORD_HEADER + (std::size_t(size) + 7) / 8 * 8;
+            if (size == WRAP || offset + length > m_capacity)
+                break;
+            std::memcpy(&sum, m_ring + offset + 4, sizeof(sum));
+            std::memcpy(&record_sequence, m_ring + offset + 8, sizeof(record_sequence));
+            const uint8_t* payload = m_ring + offset + RECORD_HEADER;
+            // Only the low half of the expected sequence number is persisted
+            if (uint32_t(record_sequence) != uint32_t(sequence)
+                || sum != (checksum(payload, size) ^ mix(record_sequence)))
+                break;
+            IEvent_ptr event = m_codec.decode(payload, size);
+            if (!event)
+            {
+                m_queue.clear();
+                return false;
+            }
+            position += length;
+            sequence = record_sequence + 1;
+            m_queue.push_back({event, position});
+        }
+        m_written   = position;
+        m_sequence  = sequence;
+        m_recovered = m_queue.size();
+        return true;
+    }
+
+    /**
+     * msync()s the ring up to 'end', then the header page, unless another call did it meanwhile.
+     * With 'header', the header page is msync()ed in any case
+     */
+    void syncUpTo(uint64_t end, bool header = false)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            if (m_synced >= end && !header)
+                return;
+            if (!m_syncing)
+                break;
+            m_synced_cv.wait(lock);
+        }
+        m_syncing      = true;
+        uint64_t begin = m_synced;
+        lock.unlock();
+
+        if (end > begin)
+            syncRange(begin, end);
+        msync(m_map, HEADER_SIZE, MS_SYNC);
+
+        lock.lock();
+        m_synced  = std::max(m_synced, end);
+        m_syncing = false;
+        lock.unlock();
+        m_synced_cv.notify_all();
+    }
+
+    void syncRange(uint64_t begin, uint64_t end)
+    {
+        if (end - begin >= m_capacity)
+        {
+            msync(m_ring, m_capacity, MS_SYNC);
+            return;
+        }
+        std::size_t from = begin % m_capacity;
+        std::size_t to   = end % m_capacity;
+        if (from < to || to == 0)
+        {
+            syncPages(from, (to == 0) ? m_capacity : to);
+        }
+        else
+        {
+            syncPages(from, m_capacity);
+            syncPages(0, to);
+        }
+    }
+
+    // msync() wants a page-aligned address
+    void syncPages(std::size_t from, std::size_t to)
+    {
+        const std::size_t page  = std::size_t(sysconf(_SC_PAGESIZE));
+        std::size_t       first = (HEADER_SIZE + from) / page * page;
+        msync(m_map + first, HEADER_SIZE + to - first, MS_SYNC);
+    }
+
+    void flush()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (m_running)
+        {
+            m_flush_cv.wait_for(lock, m_window);
+            if (!m_running)
+                break;
+            lock.unlock();
+            sync();
+            lock.lock();
+        }
+    }
+
+    Snapshot::EventCodec      m_codec;
+    const std::size_t         m_capacity;
+    std::chrono::milliseconds m_window;
+    int                       m_fd{-1};
+    uint8_t*                  m_map{nullptr};
+    Header*                   m_header{nullptr};
+    uint8_t*                  m_ring{nullptr};
+    std::size_t               m_recovered{0};
+
+    std::mutex              m_mutex;
+    std::condition_variable m_pop_cv;
+    std::condition_variable m_space_cv;
+    std::condition_variable m_synced_cv;
+    std::condition_variable m_flush_cv;
+    bool                    m_running{true};
+    bool                    m_syncing{false};
+    uint64_t                m_written{0};   // Position after the last record
+    uint64_t                m_sequence{0};  // Of the next record
+    uint64_t                m_head{0};      // Position of the oldest unacknowledged record
+    uint32_t                m_head_sequence{0};
+    uint64_t                m_synced{0};    // Position up to which the ring was msync()ed
+    std::deque<Queued>      m_queue;
+    std::deque<uint64_t>    m_unacknowledged;  // End positions of the popped events, oldest first
+    std::thread             m_flusher;
+};
+
+#endif
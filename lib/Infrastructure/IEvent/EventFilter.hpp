@@ -0,0 +1,103 @@
+#ifndef __EVENTFILTER_H_
+#define __EVENTFILTER_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "IEvent/EventId.hpp"
+
+/**
+ * Set of event types, as a bitset over dense event ids (see eventId<E>()). Events without a dense
+ * id (0) and ids beyond CAPACITY are always accepted, so a filter never drops an event it cannot
+ * tell apart. Bits are relaxed atomics: the owner may change the set while publishers test it
+ */
+class EventFilter
+{
+   public:
+    static constexpr std::size_t CAPACITY = 256;
+
+    // Accepts only the events it cannot filter
+    EventFilter() = default;
+
+    EventFilter(const EventFilter& other)
+    {
+        assign(other);
+    }
+
+    EventFilter& operator=(const EventFilter& other)
+    {
+        assign(other);
+        return *this;
+    }
+
+    template <class... E>
+    static EventFilter of()
+    {
+        EventFilter filter;
+        (filter.add(eventId<E>()), ...);
+        return filter;
+    }
+
+    static EventFilter all()
+    {
+        EventFilter filter;
+        for (auto& word : filter.m_words)
+            word.store(~uint64_t(0), std::memory_order_relaxed);
+        return filter;
+    }
+
+    bool accepts(uint32_t id) const
+    {
+        if (id == 0 || id >= CAPACITY)
+            return true;
+        return m_words[id / 64].load(std::memory_order_relaxed) & bit(id);
+    }
+
+    template <class E>
+    bool accepts() const
+    {
+        return accepts(eventId<E>());
+    }
+
+    void add(uint32_t id)
+    {
+        if (id != 0 && id < CAPACITY)
+            m_words[id / 64].fetch_or(bit(id), std::memory_order_relaxed);
+    }
+
+    void remove(uint32_t id)
+    {
+        if (id != 0 && id < CAPACITY)
+            m_words[id / 64].fetch_and(~bit(id), std::memory_order_relaxed);
+    }
+
+    // Union with 'other'
+    void merge(const EventFilter& other)
+    {
+        for (std::size_t i = 0; i < WORDS; i++)
+            m_words[i].fetch_or(other.m_words[i].load(std::memory_order_relaxed),
+                                std::memory_order_relaxed);
+    }
+
+    // Word by word: a concurrent accepts() may see part of the old set and part of the new one
+    void assign(const EventFilter& other)
+    {
+        for (std::size_t i = 0; i < WORDS; i++)
+            m_words[i].store(other.m_words[i].load(std::memory_order_relaxed),
+                             std::memory_order_relaxed);
+    }
+
+   private:
+    static constexpr std::size_t WORDS = CAPACITY / 64;
+
+    static uint64_t bit(uint32_t id)
+    {
+        return uint64_t(1) << (id % 64);
+    }
+
+    std::array<std::atomic<uint64_t>, WORDS> m_words{};
+};
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef __EVENTID_H_
+#define __EVENTID_H_
+
+#include <atomic>
+#include <cstdint>
+
+namespace detail
+{
+inline uint32_t nextEventId()
+{
+    static std::atomic<uint32_t> counter{0};
+    return ++counter;
+}
+}  // namespace detail
+
+/**
+ * Dense id of the event (payload) type P, assigned on first use: 1, 2, 3...
+ * Small enough to index per-event tables, unlike typeid(P).hash_code(). 0 means "no id"
+ */
+template <class P>
+uint32_t eventId()
+{
+    static const uint32_t id = detail::nextEventId();
+    return id;
+}
+
+#endif
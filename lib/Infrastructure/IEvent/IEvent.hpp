@@ -8,6 +8,8 @@
 
 #include <boost/signals2.hpp>
 
+#include "IEvent/EventId.hpp"
+
 class IEvent
 {
    public:
@@ -16,6 +18,11 @@ class IEvent
     {
         return typeid(*this).hash_code();
     }
+    // Dense eventId<E>() of events deriving from Event<E>, 0 for the others
+    virtual uint32_t getEventId() const
+    {
+        return 0;
+    }
 
    protected:
     IEvent()
@@ -23,6 +30,20 @@ class IEvent
     }
 };
 
+/**
+ * Optional base of an event class E (class E : public Event<E>) giving it a dense id, which lets
+ * StateManager route it straight to the states that handle it
+ */
+template <class E>
+class Event : public IEvent
+{
+   public:
+    virtual uint32_t getEventId() const override
+    {
+        return eventId<E>();
+    }
+};
+
 using IEvent_ptr      = std::shared_ptr<IEvent>;
 using SignatureIEvent = std::function<void(IEvent_ptr)>;
 using SignalIEvent    = boost::signals2::signal<void(IEvent_ptr)>;
@@ -0,0 +1,192 @@
+#ifndef __INLINEEVENT_H_
+#define __INLINEEVENT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+#include "IEvent/EventId.hpp"
+
+/**
+ * Fixed-size (64 bytes) event envelope, an alternative to a heap-allocated IEvent behind a
+ * shared_ptr for events carrying small payloads.
+ * The payload is any copyable type P (typically a plain struct, no IEvent base needed). It is
+ * stored inline when it fits in CAPACITY bytes and is nothrow movable, and owned on the heap
+ * otherwise, transparently. The envelope is a value: it is copied into mailbox slots, and
+ * dispatch reads its id and payload without following any pointer (inline case)
+ */
+class InlineEvent
+{
+   public:
+    static constexpr std::size_t SIZE     = 64;
+    static constexpr std::size_t CAPACITY = SIZE - sizeof(void*) - 2 * sizeof(uint32_t);
+
+    template <class P>
+    static constexpr bool fits_inline = sizeof(P) <= CAPACITY && alignof(P) <= alignof(void*)
+                                        && std::is_nothrow_move_constructible_v<P>;
+
+    InlineEvent() = default;
+
+    template <class P, class = std::enable_if_t<!std::is_same_v<std::decay_t<P>, InlineEvent>>>
+    explicit InlineEvent(P&& payload)
+    {
+        emplace<std::decay_t<P>>(std::forward<P>(payload));
+    }
+
+    // m_ops is only set once the payload is constructed, a throwing copy leaves nothing to destroy
+    InlineEvent(const InlineEvent& other)
+    {
+        if (other.m_ops)
+        {
+            other.m_ops->copy(m_storage, other.m_storage);
+            m_ops = other.m_ops;
+            m_id  = other.m_id;
+        }
+    }
+
+    InlineEvent(InlineEvent&& other) noexcept
+    {
+        take(other);
+    }
+
+    InlineEvent& operator=(const InlineEvent& other)
+    {
+        if (this != &other)
+        {
+            InlineEvent copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    InlineEvent& operator=(InlineEvent&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            take(other);
+        }
+        return *this;
+    }
+
+    ~InlineEvent()
+    {
+        reset();
+    }
+
+    template <class P, class... Args>
+    void emplace(Args&&... args)
+    {
+        reset();
+        if constexpr (fits_inline<P>)
+            new (m_storage) P(std::forward<Args>(args)...);
+        else
+            new (m_storage) P*(new P(std::forward<Args>(args)...));
+        m_ops = &s_ops<P>;
+        m_id  = eventId<P>();
+    }
+
+    // eventId<P>() of the payload, 0 if empty
+    uint32_t id() const
+    {
+        return m_id;
+    }
+
+    // typeid(P).hash_code() of the payload, the same key IEvent::getTypeHash() gives for P
+    std::size_t typeHash() const
+    {
+        return m_ops ? m_ops->type_hash : 0;
+    }
+
+    bool empty() const
+    {
+        return m_ops == nullptr;
+    }
+
+    template <class P>
+    bool is() const
+    {
+        return m_ops == &s_ops<P>;
+    }
+
+    // nullptr if the payload is not a P
+    template <class P>
+    const P* get() const
+    {
+        if (!is<P>())
+            return nullptr;
+        if constexpr (fits_inline<P>)
+            return std::launder(reinterpret_cast<const P*>(m_storage));
+        else
+            return *std::launder(reinterpret_cast<P* const*>(m_storage));
+    }
+
+    void reset()
+    {
+        if (m_ops)
+        {
+            m_ops->destroy(m_storage);
+            m_ops = nullptr;
+            m_id  = 0;
+        }
+    }
+
+   private:
+    // With no payload here
+    void take(InlineEvent& other) noexcept
+    {
+        if (other.m_ops)
+        {
+            other.m_ops->move(m_storage, other.m_storage);
+            m_ops = other.m_ops;
+            m_id  = other.m_id;
+            other.reset();
+        }
+    }
+
+    struct Ops
+    {
+        std::size_t type_hash;
+        void (*copy)(void* to, const void* from);
+        void (*move)(void* to, void* from);
+        void (*destroy)(void* storage);
+    };
+
+    template <class P>
+    static const Ops makeOps()
+    {
+        if constexpr (fits_inline<P>)
+        {
+            return {typeid(P).hash_code(),
+                    [](void* to, const void* from) { new (to) P(*static_cast<const P*>(from)); },
+                    [](void* to, void* from) { new (to) P(std::move(*static_cast<P*>(from))); },
+                    [](void* storage) { static_cast<P*>(storage)->~P(); }};
+        }
+        else
+        {
+            return {typeid(P).hash_code(),
+                    [](void* to, const void* from) { new (to) P*(new P(**static_cast<P* const*>(from))); },
+                    [](void* to, void* from)
+                    {
+                        new (to) P*(*static_cast<P**>(from));
+                        *static_cast<P**>(from) = nullptr;
+                    },
+                    [](void* storage) { delete *static_cast<P**>(storage); }};
+        }
+    }
+
+    template <class P>
+    inline static const Ops s_ops = makeOps<P>();
+
+    const Ops* m_ops{nullptr};
+    uint32_t   m_id{0};
+    uint32_t   m_padding{0};
+    alignas(void*) unsigned char m_storage[CAPACITY];
+};
+
+static_assert(sizeof(InlineEvent) == InlineEvent::SIZE);
+
+#endif
@@ -2,6 +2,7 @@
 #define __ISTATE_H_
 
 #include "IEvent/IEvent.hpp"
+#include "IEvent/InlineEvent.hpp"
 
 template <class Actor>
 class IState
@@ -33,6 +34,15 @@ class IState
         return -1;  // Unhandled event
     }
 
+    /**
+     * Counterpart of process_event() for events delivered as InlineEvent envelopes
+     */
+    virtual int process_inline(const InlineEvent& event)
+    {
+        (void) event;
+        return -1;  // Unhandled event
+    }
+
    protected:
     Actor* m_actor;
 };
@@ -0,0 +1,20 @@
+#include "Logger/Logger.hpp"
+
+#include <atomic>
+
+NullStream nullStream;
+
+namespace
+{
+std::atomic<std::ostream*> sink{&std::cout};
+}
+
+std::ostream& logSink()
+{
+    return *sink.load(std::memory_order_acquire);
+}
+
+void setLogSink(std::ostream& stream)
+{
+    sink.store(&stream, std::memory_order_release);
+}
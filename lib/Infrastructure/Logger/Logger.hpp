@@ -13,7 +13,12 @@ class NullStream : public std::ostream
     }
 };
 
-NullStream nullStream;
+// Defined once, in Logger.cpp
+extern NullStream nullStream;
+
+// Stream the enabled LOG() lines go to, std::cout unless redirected by setLogSink()
+std::ostream& logSink();
+void          setLogSink(std::ostream& stream);
 
 constexpr const unsigned int LEVEL_UNKNOWN = 0;
 constexpr const unsigned int LEVEL_DEBUG   = 1;
@@ -25,6 +30,6 @@ constexpr const unsigned int LEVEL_ERROR   = 4;
 #define SYSTEM_LOG_LEVEL LEVEL_INFO
 #endif
 
-#define LOG(mod, level) level >= SYSTEM_LOG_LEVEL ? std::cout << "[" << mod << "] " : nullStream
+#define LOG(mod, level) level >= SYSTEM_LOG_LEVEL ? logSink() << "[" << mod << "] " : nullStream
 
 #endif
\ No newline at end of file
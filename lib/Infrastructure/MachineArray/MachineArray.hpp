@@ -0,0 +1,482 @@
+#ifndef __MACHINEARRAY_H_
+#define __MACHINEARRAY_H_
+
+#include <condition_variable>
+#include <exception>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "tree/tree.h"
+#include "IEvent/IEvent.hpp"
+#include "StateManager/StateManager.hpp"
+#include "StateManager/StateTopology.hpp"
+
+/**
+ * Many instances of one hierarchical state machine, for fleets of small identical devices where
+ * an actor (a thread and a queue) per instance costs far more than the machine itself. The state
+ * tree is built once, as for a StateManager, and its states are shared by every instance: the
+ * actor their handlers point to keeps the per-instance data in arrays indexed by instance(), the
+ * instance being processed on the calling thread. Per instance, the MachineArray itself only
+ * stores the index of the current state and the history of the composite states.
+ * Events posted to the instances are grouped by type, and process() dispatches every group in a
+ * tight loop, spread over 'workers' threads (the calling one included). An instance always goes
+ * to the same worker, so handlers run concurrently for different instances only and must not
+ * touch the data of other instances. The events of an instance keep their order within a type;
+ * the types are processed one after the other, in the order they were first posted.
+ * Single region only: no orthogonal states, no continuations. A step requests one transition at
+ * most, the last request wins
+ */
+template <typename T>
+class MachineArray
+{
+   public:
+    using t_iterator = typename tree<T>::iterator;
+    using t_action   = std::function<void(const IEvent_ptr&)>;
+    using t_guard    = std::function<bool(const IEvent_ptr&)>;
+
+    MachineArray(tree<T>&& state_tree, t_iterator initial_state, std::size_t instances,
+                 std::size_t workers = 1)
+        : m_tree(std::move(state_tree)),
+          m_topology(m_tree),
+          m_instances{instances},
+          m_workers{workers ? workers : 1}
+    {
+        for (std::size_t index = 0; index < m_topology.size(); index++)
+        {
+            // Composite states get a slot of history per instance
+            m_slot.push_back(m_topology.state(index).node->first_child ? uint32_t(m_composites++)
+                                                                       : NO_STATE);
+        }
+        m_table.resize(m_topology.size());
+        m_current.assign(m_instances, uint32_t(stateIndex(initial_state)));
+        m_shallow_history.assign(m_composites * m_instances, NO_STATE);
+        m_deep_history.assign(m_composites * m_instances, NO_STATE);
+        m_lanes.resize(m_workers);
+        for (std::size_t worker = 1; worker < m_workers; worker++)
+            m_threads.emplace_back(&MachineArray::work, this, worker);
+    }
+
+    ~MachineArray()
+    {
+        {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_start.notify_all();
+        for (auto& thread : m_threads)
+            thread.join();
+    }
+
+    MachineArray(const MachineArray&)            = delete;
+    MachineArray& operator=(const MachineArray&) = delete;
+
+    std::size_t size() const
+    {
+        return m_instances;
+    }
+
+    // Throws std::out_of_range for a state of another tree
+    std::size_t stateIndex(t_iterator state) const
+    {
+        return m_topology.index(state);
+    }
+
+    // Same as StateManager::addTransition(), for every instance
+    template <class E>
+    void addTransition(t_iterator source, t_iterator target_state, t_action action = nullptr,
+                       t_guard guard = nullptr)
+    {
+        std::size_t index = stateIndex(source);
+        m_table[index].push_back({typeid(E).hash_code(), uint32_t(stateIndex(target_state)),
+                                  std::move(action), std::move(guard)});
+        m_topology.markHandled(index, eventId<E>());
+    }
+
+    // Same as StateManager::declareHandled(): events with a dense id skip the states not handling
+    // them while bubbling up
+    template <class... E>
+    void declareHandled(t_iterator state)
+    {
+        std::size_t index = stateIndex(state);
+        m_topology.declare(index);
+        (m_topology.markHandled(index, eventId<E>()), ...);
+    }
+
+    // Enters the initial state of every instance
+    void init()
+    {
+        run(
+            [this](std::size_t worker)
+            {
+                Dispatch dispatch;
+                t_dispatch = &dispatch;
+                for (std::size_t instance = worker; instance < m_instances; instance += m_workers)
+                {
+                    dispatch.instance = instance;
+                    m_topology.state(m_current[instance]).node->data->on_entry();
+                    applyPending(dispatch);
+                }
+                t_dispatch = nullptr;
+            });
+    }
+
+    // Queues 'event' for 'instance', until the next process(). Not thread-safe
+    void post(std::size_t instance, IEvent_ptr event)
+    {
+        auto& lane = m_lanes[instance % m_workers];
+        lane.batch(event->getTypeHash(), event->getEventId())
+            .push_back({uint32_t(instance), std::move(event)});
+        m_posted++;
+    }
+
+    // Queues the same 'event' for every instance
+    void broadcast(const IEvent_ptr& event)
+    {
+        for (std::size_t instance = 0; instance < m_instances; instance++)
+            post(instance, event);
+    }
+
+    /**
+     * Processes every queued event to completion, returns their number. If a handler throws, the
+     * exception is rethrown once every worker is done, and the events left are dropped
+     */
+    std::size_t process()
+    {
+        std::size_t processed = m_posted;
+        m_posted              = 0;
+        // The workers then share the routes without writing them
+        m_ids.clear();
+        for (auto& lane : m_lanes)
+        {
+            for (auto& batch : lane.batches)
+                m_ids.push_back(batch.id);
+        }
+        m_topology.resolveRoutes(m_ids);
+        try
+        {
+            run(
+                [this](std::size_t worker)
+                {
+                    Dispatch dispatch;
+                    t_dispatch = &dispatch;
+                    for (auto& batch : m_lanes[worker].batches)
+                    {
+                        for (auto& [instance, event] : batch.events)
+                        {
+                            dispatch.instance = instance;
+                            dispatch.event    = &event;
+                            step(dispatch, batch.id, event);
+                        }
+                        batch.events.clear();
+                    }
+                    t_dispatch = nullptr;
+                });
+        }
+        catch (...)
+        {
+            t_dispatch = nullptr;
+            for (auto& lane : m_lanes)
+            {
+                for (auto& batch : lane.batches)
+                    batch.events.clear();
+            }
+            throw;
+        }
+        return processed;
+    }
+
+    t_iterator currentState(std::size_t instance) const
+    {
+        return m_topology.state(m_current[instance]);
+    }
+
+    /**
+     * Last active child (Shallow) or innermost state (Deep) of 'composite_state' in 'instance',
+     * 'composite_state' itself if there is no history yet
+     */
+    t_iterator history(std::size_t instance, t_iterator composite_state,
+                       History kind = History::Shallow) const
+    {
+        uint32_t composite = uint32_t(stateIndex(composite_state));
+        return m_topology.state(historyIndex(instance, composite, kind));
+    }
+
+    // Instance whose handler or action runs on the calling thread
+    static std::size_t instance()
+    {
+        return t_dispatch->instance;
+    }
+
+    /**
+     * Same as StateManager::requestTransition(), for instance(): executed once the handler
+     * returns. Returns 0 (handled)
+     */
+    int requestTransition(t_iterator target_state, t_action action = nullptr)
+    {
+        return requestTransition(stateIndex(target_state), std::move(action));
+    }
+
+    // Same as above for the state numbered 'target' (see stateIndex()), without any lookup
+    int requestTransition(std::size_t target, t_action action = nullptr)
+    {
+        t_dispatch->request(uint32_t(target), History::None, std::move(action));
+        return 0;
+    }
+
+    int requestTransitionToHistory(t_iterator composite_state, History kind = History::Shallow,
+                                   t_action action = nullptr)
+    {
+        return requestTransitionToHistory(stateIndex(composite_state), kind, std::move(action));
+    }
+
+    int requestTransitionToHistory(std::size_t composite, History kind = History::Shallow,
+                                   t_action action = nullptr)
+    {
+        t_dispatch->request(uint32_t(composite), kind, std::move(action));
+        return 0;
+    }
+
+   private:
+    static constexpr uint32_t NO_STATE = StateTopology<T>::NO_STATE;
+
+    struct TransitionRow
+    {
+        std::size_t event_type;
+        uint32_t    target;
+        t_action    action;
+        t_guard     guard;
+    };
+
+    // Transition requested by the step running on one worker
+    struct Dispatch
+    {
+        void request(uint32_t state, History kind, t_action next_action)
+        {
+            target  = state;
+            history = kind;
+            action  = std::move(next_action);
+        }
+
+        std::size_t       instance{0};
+        const IEvent_ptr* event{&no_event};
+        uint32_t          target{NO_STATE};
+        History           history{History::None};
+        t_action          action;
+        IEvent_ptr        no_event;
+    };
+
+    struct Batch
+    {
+        std::size_t                                  type;
+        uint32_t                                     id;  // Dense event id, 0 if none
+        std::vector<std::pair<uint32_t, IEvent_ptr>> events;
+    };
+
+    // Events of the instances of one worker, grouped by type
+    struct Lane
+    {
+        std::vector<std::pair<uint32_t, IEvent_ptr>>& batch(std::size_t type, uint32_t id)
+        {
+            auto found = index.find(type);
+            if (found != index.end())
+                return batches[found->second].events;
+            index.emplace(type, batches.size());
+            batches.push_back({type, id, {}});
+            return batches.back().events;
+        }
+
+        std::vector<Batch>                           batches;
+        std::unordered_map<std::size_t, std::size_t> index;  // Type to position in 'batches'
+    };
+
+    // Bubbles up as in StateManager::step(), jumping over the states declared not to handle 'id'
+    void step(Dispatch& dispatch, uint32_t id, const IEvent_ptr& event)
+    {
+        const std::size_t type  = event->getTypeHash();
+        uint32_t          index = m_topology.firstHandler(m_current[dispatch.instance], id);
+        while (index != NO_STATE && dispatchTo(dispatch, index, type, event) != 0)
+        {
+            index = m_topology.isRoot(index)
+                        ? NO_STATE
+                        : m_topology.firstHandler(m_topology.parent(index), id);
+        }
+        applyPending(dispatch);
+    }
+
+    // Declared transitions of the state first, then the state's own handler
+    int dispatchTo(Dispatch& dispatch, uint32_t index, std::size_t type, const IEvent_ptr& event)
+    {
+        for (const auto& row : m_table[index])
+        {
+            if (row.event_type == type && (!row.guard || row.guard(event)))
+            {
+                dispatch.request(row.target, History::None, row.action);
+                return 0;
+            }
+        }
+        return m_topology.state(index).node->data->process_event(event);
+    }
+
+    // Transitions requested from entry actions are applied in turn
+    void applyPending(Dispatch& dispatch)
+    {
+        while (dispatch.target != NO_STATE)
+        {
+            uint32_t target = dispatch.target;
+            History  kind   = dispatch.history;
+            t_action action = std::move(dispatch.action);
+            dispatch.target = NO_STATE;
+            if (kind != History::None)
+                target = historyIndex(dispatch.instance, target, kind);
+            transition(dispatch, target, action);
+        }
+        dispatch.event = &dispatch.no_event;
+    }
+
+    // Same sequence as the single-region StateManager::transitionTo()
+    void transition(Dispatch& dispatch, uint32_t target, const t_action& action)
+    {
+        const std::size_t instance = dispatch.instance;
+        const uint32_t    source   = m_current[instance];
+        m_topology.transition(
+            source, target,
+            [&](std::size_t exited)
+            {
+                recordExit(instance, exited, source);
+                m_topology.state(exited).node->data->on_exit();
+            },
+            [&]()
+            {
+                if (action)
+                    action(*dispatch.event);
+            },
+            [&](std::size_t entered) { m_topology.state(entered).node->data->on_entry(); });
+        m_current[instance] = target;
+    }
+
+    uint32_t historyIndex(std::size_t instance, uint32_t composite, History kind) const
+    {
+        uint32_t slot = m_slot[composite];
+        if (slot == NO_STATE)
+            return composite;
+        const auto& history = (kind == History::Deep) ? m_deep_history : m_shallow_history;
+        uint32_t    target  = history[slot * m_instances + instance];
+        return (target == NO_STATE) ? composite : target;
+    }
+
+    // History of the composite states only: the others have no slot
+    void recordExit(std::size_t instance, std::size_t state, std::size_t leaf)
+    {
+        m_topology.recordExit(state, leaf,
+                              [&](std::size_t composite, uint32_t shallow, uint32_t deep)
+                              {
+                                  const uint32_t slot = m_slot[composite];
+                                  if (slot == NO_STATE)
+                                      return;
+                                  m_shallow_history[slot * m_instances + instance] = shallow;
+                                  m_deep_history[slot * m_instances + instance]    = deep;
+                              });
+    }
+
+    /**
+     * Runs 'job(worker)' for every worker, the calling thread being worker 0, and waits for all,
+     * even if one throws. Rethrows the exception of worker 0, else the first of another worker
+     */
+    template <class Job>
+    void run(Job&& job)
+    {
+        if (m_workers == 1)
+        {
+            job(0);
+            return;
+        }
+        {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+            m_job       = job;
+            m_remaining = m_workers - 1;
+            m_error     = nullptr;
+            m_generation++;
+        }
+        m_start.notify_all();
+        std::exception_ptr error;
+        try
+        {
+            job(0);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this]() { return m_remaining == 0; });
+        m_job = nullptr;
+        if (!error)
+            error = std::exchange(m_error, nullptr);
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    void work(std::size_t worker)
+    {
+        uint64_t                     generation = 0;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            m_start.wait(lock, [&]() { return m_stopping || m_generation != generation; });
+            if (m_stopping)
+                return;
+            generation = m_generation;
+            lock.unlock();
+            std::exception_ptr error;
+            try
+            {
+                m_job(worker);
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+            lock.lock();
+            if (error && !m_error)
+                m_error = error;
+            if (--m_remaining == 0)
+                m_done.notify_one();
+        }
+    }
+
+    static inline thread_local Dispatch* t_dispatch{nullptr};
+
+    tree<T>                                 m_tree;
+    StateTopology<T>                        m_topology;
+    std::vector<uint32_t>                   m_slot;  // History slot of composite states
+    std::size_t                             m_composites{0};
+    std::vector<std::vector<TransitionRow>> m_table;
+
+    // Per instance: [instance] and [slot * m_instances + instance]
+    const std::size_t     m_instances;
+    std::vector<uint32_t> m_current;
+    std::vector<uint32_t> m_shallow_history;
+    std::vector<uint32_t> m_deep_history;
+
+    const std::size_t                m_workers;
+    std::vector<Lane>                m_lanes;  // [worker]
+    std::vector<uint32_t>            m_ids;    // Event ids of the batches being processed
+    std::size_t                      m_posted{0};
+    std::vector<std::thread>         m_threads;
+    std::mutex                       m_mutex;
+    std::condition_variable          m_start;
+    std::condition_variable          m_done;
+    std::function<void(std::size_t)> m_job;
+    std::size_t                      m_remaining{0};
+    std::exception_ptr               m_error;  // First exception of a worker other than 0
+    uint64_t                         m_generation{0};
+    bool                             m_stopping{false};
+};
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef __ROUTER_H_
+#define __ROUTER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "IEvent/IEvent.hpp"
+
+enum class RoutingPolicy
+{
+    RoundRobin,
+    LeastLoaded,     // shortest mailbox at the time of routing, ties broken round-robin
+    ConsistentHash   // events with the same key always reach the same routee
+};
+
+/**
+ * Fronts a pool of identical actors and forwards each event to one of them. The pool and the
+ * hash ring are fixed at construction, so routing takes no lock: round-robin is one relaxed
+ * fetch_add, least-loaded reads the mailbox depths the queues maintain atomically.
+ * Actor must provide callback_IEvent(IEvent_ptr) and queueDepth()
+ */
+template <class Actor>
+class Router
+{
+   public:
+    using t_key = std::function<uint64_t(const IEvent_ptr&)>;
+
+    // Virtual nodes per routee on the hash ring
+    static constexpr int REPLICAS = 64;
+
+    // Throws std::invalid_argument without routees, or without 'key' for ConsistentHash
+    Router(std::vector<Actor*> routees, RoutingPolicy policy, t_key key = nullptr)
+        : m_routees{std::move(routees)}, m_policy{policy}, m_key{std::move(key)}
+    {
+        if (m_routees.empty())
+            throw std::invalid_argument("Router needs at least one routee");
+        if (m_policy == RoutingPolicy::ConsistentHash && !m_key)
+            throw std::invalid_argument("Router with RoutingPolicy::ConsistentHash needs a key");
+        if (m_policy != RoutingPolicy::ConsistentHash)
+            return;
+        for (uint32_t i = 0; i < m_routees.size(); i++)
+        {
+            for (uint64_t replica = 0; replica < REPLICAS; replica++)
+                m_ring.push_back({mix((uint64_t(i) << 32) | replica), i});
+        }
+        std::sort(m_ring.begin(), m_ring.end());
+    }
+
+    // Same signature as an actor's, so a router can be connected wherever an actor can
+    void callback_IEvent(IEvent_ptr event)
+    {
+        m_routees[select(event)]->callback_IEvent(std::move(event));
+    }
+
+    // Index of the routee 'event' would be forwarded to
+    std::size_t select(const IEvent_ptr& event)
+    {
+        switch (m_policy)
+        {
+            case RoutingPolicy::LeastLoaded:
+                return leastLoaded();
+            case RoutingPolicy::ConsistentHash:
+                return onRing(m_key(event));
+            default:
+                return m_next.fetch_add(1, std::memory_order_relaxed) % m_routees.size();
+        }
+    }
+
+    std::size_t size() const
+    {
+        return m_routees.size();
+    }
+
+   private:
+    std::size_t leastLoaded()
+    {
+        std::size_t count = m_routees.size();
+        std::size_t start = m_next.fetch_add(1, std::memory_order_relaxed) % count;
+        std::size_t best  = start;
+        std::size_t depth = m_routees[start]->queueDepth();
+        for (std::size_t i = 1; i < count && depth > 0; i++)
+        {
+            std::size_t candidate = (start + i) % count;
+            std::size_t other     = m_routees[candidate]->queueDepth();
+            if (other < depth)
+            {
+                best  = candidate;
+                depth = other;
+            }
+        }
+        return best;
+    }
+
+    std::size_t onRing(uint64_t key) const
+    {
+        uint64_t hash  = mix(key);
+        auto     point = std::lower_bound(m_ring.begin(), m_ring.end(),
+                                          std::pair<uint64_t, uint32_t>{hash, 0});
+        return (point == m_ring.end()) ? m_ring.front().second : point->second;
+    }
+
+    // splitmix64 finalizer, spreads consecutive keys and replicas over the ring
+    static uint64_t mix(uint64_t value)
+    {
+        value += 0x9e3779b97f4a7c15ULL;
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+        return value ^ (value >> 31);
+    }
+
+    std::vector<Actor*>                        m_routees;
+    RoutingPolicy                              m_policy;
+    t_key                                      m_key;
+    std::vector<std::pair<uint64_t, uint32_t>> m_ring;
+    std::atomic<std::size_t>                   m_next{0};
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef __SIMULATION_H_
+#define __SIMULATION_H_
+
+#include <chrono>
+#include <cstddef>
+
+#include "BoostDeadlineTimer/BoostDeadlineTimer.hpp"
+#include "CoroutineExecutor/CoroutineExecutor.hpp"
+
+/**
+ * Discrete-event simulation of actors hosted on an EventLoop, with their timers armed on a
+ * VirtualClock (DeadlineTimer timer(simulation.clock(), ...)). Everything runs single-threaded
+ * on the caller's thread: the actors run until every mailbox is empty, then the clock jumps
+ * straight to the next due timer, so hours of timeouts take microseconds and every run of a
+ * scenario processes the same events in the same order
+ */
+class Simulation
+{
+   public:
+    VirtualClock& clock()
+    {
+        return m_clock;
+    }
+
+    EventLoop& loop()
+    {
+        return m_loop;
+    }
+
+    /**
+     * Runs until no timer is left due up to 'until', then moves the clock to 'until' (if not
+     * NEVER). Returns the number of timers fired
+     */
+    std::size_t run(Clock::t_time until = VirtualClock::NEVER)
+    {
+        std::size_t fired = 0;
+        m_loop.runUntilIdle();
+        while (m_clock.fireNext(until))
+        {
+            fired++;
+            m_loop.runUntilIdle();
+        }
+        if (until != VirtualClock::NEVER)
+            m_clock.advanceTo(until);
+        return fired;
+    }
+
+    template <class Rep, class Period>
+    std::size_t runFor(std::chrono::duration<Rep, Period> duration)
+    {
+        return run(m_clock.now() + std::chrono::duration_cast<Clock::t_time>(duration));
+    }
+
+   private:
+    VirtualClock m_clock;
+    EventLoop    m_loop;
+};
+
+#endif
@@ -0,0 +1,216 @@
+#ifndef __SNAPSHOT_H_
+#define __SNAPSHOT_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "IEvent/IEvent.hpp"
+#include "StateManager/StateManager.hpp"
+
+/**
+ * Checkpoint of an actor: configuration of its state machine plus the events still waiting in its
+ * queue, in one flat binary blob of native-endian uint32_t fields
+ *  [MAGIC][VERSION][StateManager configuration][event count]([event size][event bytes])...
+ * Restoring it puts the state machine back where it was without executing any entry action, so a
+ * warm restart costs one pass over the blob rather than a replay of the traffic that led there
+ */
+namespace Snapshot
+{
+constexpr uint32_t MAGIC   = 0x4f534e41;  // "ANSO"
+constexpr uint32_t VERSION = 1;
+
+// Application events are opaque to the infrastructure, each actor supplies their serialization
+struct EventCodec
+{
+    // Appends 'event' (including whatever identifies its type) to 'blob'. False to leave it out
+    std::function<bool(const IEvent_ptr& event, std::vector<uint8_t>& blob)> encode;
+    // Rebuilds an event from the bytes written by encode(). nullptr if they cannot be decoded
+    std::function<IEvent_ptr(const uint8_t* data, std::size_t size)> decode;
+};
+
+namespace detail
+{
+inline void put(std::vector<uint8_t>& blob, uint32_t value)
+{
+    std::size_t offset = blob.size();
+    blob.resize(offset + sizeof(value));
+    std::memcpy(blob.data() + offset, &value, sizeof(value));
+}
+
+inline bool get(const uint8_t* data, std::size_t size, std::size_t& offset, uint32_t& value)
+{
+    if (size - offset < sizeof(value))
+        return false;
+    std::memcpy(&value, data + offset, sizeof(value));
+    offset += sizeof(value);
+    return true;
+}
+}  // namespace detail
+
+/* 'pending' is typically the actor's queue, see SimplestThreadSafeQueue::snapshot() */
+template <typename T>
+std::vector<uint8_t> checkpoint(const StateManager<T>& state_manager,
+                                const std::vector<IEvent_ptr>& pending, const EventCodec& codec)
+{
+    std::vector<uint8_t> blob;
+    detail::put(blob, MAGIC);
+    detail::put(blob, VERSION);
+    state_manager.saveConfiguration(blob);
+
+    std::size_t count_at = blob.size();
+    uint32_t    count    = 0;
+    detail::put(blob, count);
+    for (auto& event : pending)
+    {
+        std::size_t size_at = blob.size();
+        detail::put(blob, 0);
+        if (!codec.encode(event, blob))
+        {
+            blob.resize(size_at);
+            continue;
+        }
+        uint32_t size = uint32_t(blob.size() - size_at - sizeof(uint32_t));
+        std::memcpy(blob.data() + size_at, &size, sizeof(size));
+        count++;
+    }
+    std::memcpy(blob.data() + count_at, &count, sizeof(count));
+    return blob;
+}
+
+/**
+ * Use instead of StateManager::init(). The decoded events are appended to 'pending', to be put
+ * back in the actor's queue. Returns false, leaving both untouched, if the blob is invalid or was
+ * taken from a different state tree
+ */
+template <typename T>
+bool restore(StateManager<T>& state_manager, const uint8_t* data, std::size_t size,
+             const EventCodec& codec, std::vector<IEvent_ptr>& pending)
+{
+    std::size_t offset = 0;
+    uint32_t    magic, version, state_count, active_count;
+    if (!detail::get(data, size, offset, magic) || magic != MAGIC
+        || !detail::get(data, size, offset, version) || version != VERSION)
+        return false;
+
+    // Events are decoded before anything is modified, they follow the configuration
+    std::size_t configuration = offset;
+    if (!detail::get(data, size, offset, state_count) || !detail::get(data, size, offset, active_count))
+        return false;
+    uint64_t skip = (uint64_t(active_count) + 2 * uint64_t(state_count)) * sizeof(uint32_t);
+    if (size - offset < skip)
+        return false;
+    offset += skip;
+
+    uint32_t count;
+    if (!detail::get(data, size, offset, count))
+        return false;
+    std::vector<IEvent_ptr> events;
+    for (uint32_t i = 0, event_size; i < count; i++)
+    {
+        if (!detail::get(data, size, offset, event_size) || size - offset < event_size)
+            return false;
+        IEvent_ptr event = codec.decode(data + offset, event_size);
+        if (!event)
+            return false;
+        events.push_back(std::move(event));
+        offset += event_size;
+    }
+
+    if (state_manager.restoreConfiguration(data + configuration, size - configuration) == 0)
+        return false;
+    pending.insert(pending.end(), events.begin(), events.end());
+    return true;
+}
+
+/**
+ * Written next to 'path' first, synced, renamed, then the directory synced, so a crash leaves
+ * either the previous checkpoint or the complete new one, never a truncated one. Returns false
+ * if any step failed, including the last sync, after which 'path' may be either checkpoint
+ */
+inline bool writeFile(const std::string& path, const std::vector<uint8_t>& blob)
+{
+    std::string tmp  = path + ".tmp";
+    FILE*       file = std::fopen(tmp.c_str(), "wb");
+    if (!file)
+        return false;
+    bool written = std::fwrite(blob.data(), 1, blob.size(), file) == blob.size();
+    written      = written && std::fflush(file) == 0 && fsync(fileno(file)) == 0;
+    written      = (std::fclose(file) == 0) && written;
+    if (!written || std::rename(tmp.c_str(), path.c_str()) != 0)
+        return false;
+
+    std::size_t slash     = path.rfind('/');
+    std::string directory = (slash == std::string::npos) ? "." : path.substr(0, slash + 1);
+    int         fd        = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    bool synced = fsync(fd) == 0;
+    close(fd);
+    return synced;
+}
+
+/**
+ * Read-only mapping of a checkpoint file, restore() reads it in place
+ */
+class MappedFile
+{
+   public:
+    explicit MappedFile(const std::string& path)
+    {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            void* address = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address != MAP_FAILED)
+            {
+                m_data = static_cast<const uint8_t*>(address);
+                m_size = info.st_size;
+            }
+        }
+        close(fd);
+    }
+
+    ~MappedFile()
+    {
+        if (m_data)
+            munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool valid() const
+    {
+        return m_data != nullptr;
+    }
+
+    const uint8_t* data() const
+    {
+        return m_data;
+    }
+
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+   private:
+    const uint8_t* m_data{nullptr};
+    std::size_t    m_size{0};
+};
+}  // namespace Snapshot
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef __CONTINUATION_H_
+#define __CONTINUATION_H_
+
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <utility>
+
+#include "IEvent/IEvent.hpp"
+
+/**
+ * Stackless coroutine a state handler hands to StateManager::spawn() to split slow work across
+ * several run-to-completion steps of its actor:
+ *   Continuation StateA::work()
+ *   {
+ *       firstHalf();
+ *       co_await m_state_manager->yield();  // events queued meanwhile are processed first
+ *       secondHalf();
+ *   }
+ * The continuation belongs to the state that spawned it, runs on the actor's thread only, and is
+ * destroyed (cancelled) as soon as that state is exited
+ */
+class Continuation
+{
+   public:
+    struct promise_type
+    {
+        Continuation get_return_object()
+        {
+            return Continuation{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        // Started by spawn(), once the StateManager owns it
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+        std::suspend_always final_suspend() noexcept
+        {
+            return {};
+        }
+        void return_void()
+        {
+        }
+        void unhandled_exception()
+        {
+            // Same outcome as an exception escaping a state handler: thrown out of the step
+            throw;
+        }
+
+        std::size_t owner{0};         // Index of the state that spawned it
+        uint64_t    ticket{0};        // Of the ContinuationResume it waits for, 0 if none
+        std::size_t awaited_type{0};  // Type hash of the event it waits for, 0 if none
+        IEvent_ptr  event;            // That event, once received
+        bool        running{false};
+        bool        cancelled{false};
+    };
+    using t_handle = std::coroutine_handle<promise_type>;
+
+    explicit Continuation(t_handle handle) : m_handle{handle}
+    {
+    }
+    Continuation(Continuation&& other) noexcept : m_handle{std::exchange(other.m_handle, nullptr)}
+    {
+    }
+    Continuation& operator=(Continuation&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (m_handle)
+                m_handle.destroy();
+            m_handle = std::exchange(other.m_handle, nullptr);
+        }
+        return *this;
+    }
+    ~Continuation()
+    {
+        if (m_handle)
+            m_handle.destroy();
+    }
+
+    // Hands the coroutine frame over to its new owner
+    t_handle release()
+    {
+        return std::exchange(m_handle, nullptr);
+    }
+
+   private:
+    t_handle m_handle;
+};
+
+/**
+ * Event scheduling a suspended Continuation back onto its actor: posted to the actor's own
+ * mailbox, and processed by the StateManager instead of being dispatched to the states
+ */
+class ContinuationResume : public Event<ContinuationResume>
+{
+   public:
+    explicit ContinuationResume(uint64_t ticket) : ticket{ticket}
+    {
+    }
+    uint64_t ticket;
+};
+
+#endif
@@ -1,108 +1,1168 @@
 #ifndef __STATEMANAGER_H_
 #define __STATEMANAGER_H_
 
+#include <algorithm>
+#include <coroutine>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include "tree/tree.h"
+#include "IEvent/EventFilter.hpp"
 #include "IEvent/IEvent.hpp"
+#include "IEvent/InlineEvent.hpp"
+#include "StateManager/Continuation.hpp"
+#include "StateManager/StateTopology.hpp"
+
+enum class History
+{
+    None,
+    Shallow,  // re-enters the direct child of the composite state that was last active
+    Deep      // re-enters the innermost state(s) that were last active below the composite state
+};
 
 template <typename T>
 class StateManager
 {
    public:
     using t_iterator = typename tree<T>::iterator;
+    // Transition action, run once the source states are exited and before the target is entered.
+    // It gets the event that triggered the transition (nullptr if requested outside processEvent)
+    using t_action = std::function<void(const IEvent_ptr&)>;
+    using t_guard  = std::function<bool(const IEvent_ptr&)>;
 
     StateManager(tree<T>&& state_tree, t_iterator current_state)
-        : m_tree(std::move(state_tree)), m_current_state(current_state)
+        : m_tree(std::move(state_tree)),
+          m_current_state(current_state),
+          m_active{current_state},
+          m_dispatch_leaf(m_tree.end()),
+          // Dense pre-order numbering, the tree never changes once owned by the StateManager
+          m_topology(m_tree)
     {
+        m_table.resize(m_topology.size());
+        m_orthogonal_index.assign(m_topology.size(), false);
+        m_shallow_history.assign(m_topology.size(), NO_STATE);
+        m_deep_history.assign(m_topology.size(), NO_STATE);
+        m_current_index = stateIndex(current_state);
     }
 
-    void transitionTo(t_iterator target_state)
+    ~StateManager()
     {
-        // Special case: self-transition
-        if (target_state == m_current_state)
+        for (auto handle : m_continuations)
+            handle.destroy();
+    }
+
+    StateManager(const StateManager&)            = delete;
+    StateManager& operator=(const StateManager&) = delete;
+
+    std::size_t stateCount() const
+    {
+        return m_topology.size();
+    }
+
+    std::size_t stateIndex(t_iterator state) const
+    {
+        return m_topology.index(state);
+    }
+
+    t_iterator stateAt(std::size_t index) const
+    {
+        return m_topology.state(index);
+    }
+
+    /**
+     * Declares 'state' as an orthogonal state: each of its children is a region, and all of them
+     * are active at the same time whenever 'state' is active. Must be called before init()
+     */
+    void setOrthogonal(t_iterator state)
+    {
+        m_orthogonal.push_back(state);
+        m_orthogonal_index[stateIndex(state)] = true;
+    }
+
+    bool isOrthogonal(t_iterator state) const
+    {
+        return std::find(m_orthogonal.begin(), m_orthogonal.end(), state) != m_orthogonal.end();
+    }
+
+    /**
+     * Declares a transition of 'source' triggered by events of type E, checked before the state's
+     * own process_event(). The first row whose guard accepts the event wins, and the event counts
+     * as handled by 'source'. Rows are stored per state index, so matching them costs no lookup
+     */
+    template <class E>
+    void addTransition(t_iterator source, t_iterator target_state, t_action action = nullptr,
+                       t_guard guard = nullptr)
+    {
+        std::size_t index = stateIndex(source);
+        m_table[index].push_back(
+            {typeid(E).hash_code(), stateIndex(target_state), std::move(action), std::move(guard)});
+        m_topology.markHandled(index, eventId<E>());
+    }
+
+    /**
+     * Declares the complete set of event types whose process_event() (or process_inline()) of
+     * 'state' may handle, besides the types of its transition table rows. Events with a dense id
+     * (see Event<E>) skip the declared states that do not handle them while bubbling up, going
+     * straight to the first ancestor that may. States without a declaration get every event
+     */
+    template <class... E>
+    void declareHandled(t_iterator state)
+    {
+        std::size_t index = stateIndex(state);
+        m_topology.declare(index);
+        (m_topology.markHandled(index, eventId<E>()), ...);
+    }
+
+    /**
+     * Exits every active state up to the least common ancestor of the current state and
+     * 'target_state', runs 'action', then enters down to 'target_state'
+     */
+    void transitionTo(t_iterator target_state, const t_action& action = nullptr)
+    {
+        transitionTo(stateIndex(target_state), action);
+    }
+
+    // Same as above for the state numbered 'target' (see stateIndex()), without any lookup
+    void transitionTo(std::size_t target, const t_action& action = nullptr)
+    {
+        if (!m_orthogonal.empty())
         {
-            m_current_state.node->data->on_exit();
-            m_current_state.node->data->on_entry();
+            transitionFrom(closestLeaf(m_topology.state(target)), m_topology.state(target), action);
             return;
         }
 
-        std::vector<t_iterator> ancestorsA;
-        std::vector<t_iterator> ancestorsB;
+        const std::size_t source = m_current_index;
+        m_topology.transition(
+            source, target,
+            [&](std::size_t exited)
+            {
+                recordExit(exited, source);
+                cancelContinuations(m_topology.state(exited));
+                m_topology.state(exited).node->data->on_exit();
+            },
+            [&]() { runAction(action); },
+            [&](std::size_t entered) { m_topology.state(entered).node->data->on_entry(); });
+        // A self-transition leaves the configuration as it was
+        if (target == source)
+            return;
+        setCurrentState(target);
+        m_active[0] = m_current_state;
+        configurationChanged();
+    }
+
+    /**
+     * Asks for a transition from within a state handler. Transitions requested while an event is
+     * being processed are executed once every active region has seen the event, each one from the
+     * region that requested it. Outside of processEvent() it is the same as transitionTo().
+     * Returns 0 (handled), so that a handler can simply
+     * 'return m_state_manager->requestTransition(target, action);'
+     */
+    int requestTransition(t_iterator target_state, t_action action = nullptr)
+    {
+        return requestTransition(stateIndex(target_state), std::move(action));
+    }
 
-        for (auto it = m_current_state; it != m_tree.begin(); it = m_tree.parent(it))
+    // Same as above for the state numbered 'target' (see stateIndex()), without any lookup
+    int requestTransition(std::size_t target, t_action action = nullptr)
+    {
+        if (!m_in_step)
         {
-            ancestorsA.push_back(it);
+            transitionTo(target, action);
+            return 0;
         }
+        m_pending.push_back(
+            {m_dispatch_leaf, target, History::None, std::move(action), *m_step_event});
+        return 0;
+    }
 
-        for (auto it = target_state; it != m_tree.begin(); it = m_tree.parent(it))
+    /**
+     * Transition to the history of 'composite_state': the configuration it had when it was last
+     * exited is read from flat per-state arrays, so no search of the tree is needed. Falls back
+     * to 'composite_state' itself if it has never been exited
+     */
+    void transitionToHistory(t_iterator composite_state, History kind = History::Shallow,
+                             const t_action& action = nullptr)
+    {
+        transitionToHistory(stateIndex(composite_state), kind, action);
+    }
+
+    void transitionToHistory(std::size_t composite, History kind = History::Shallow,
+                             const t_action& action = nullptr)
+    {
+        uint32_t    recorded = recordedHistory(composite, kind);
+        std::size_t target   = (recorded == NO_STATE) ? composite : recorded;
+        if (kind == History::Deep && !m_orthogonal.empty())
         {
-            ancestorsB.insert(ancestorsB.begin(), it);
+            m_restoring_deep = true;
+            transitionTo(target, action);
+            m_restoring_deep = false;
+            return;
         }
+        transitionTo(target, action);
+    }
 
-        t_iterator                                 commonAncestor = m_tree.begin();
-        typename std::vector<t_iterator>::iterator it_commonAncestor;
-        for (auto& it : ancestorsA)
+    // requestTransition() counterpart of transitionToHistory()
+    int requestTransitionToHistory(t_iterator composite_state, History kind = History::Shallow,
+                                   t_action action = nullptr)
+    {
+        if (!m_in_step)
         {
-            it_commonAncestor = std::find(ancestorsB.begin(), ancestorsB.end(), it);
-            if (it_commonAncestor != ancestorsB.end())
+            transitionToHistory(composite_state, kind, action);
+            return 0;
+        }
+        m_pending.push_back(
+            {m_dispatch_leaf, stateIndex(composite_state), kind, std::move(action), *m_step_event});
+        return 0;
+    }
+
+    /**
+     * Last active child (Shallow) or innermost state (Deep) of 'composite_state', i.e. the state a
+     * history transition would enter. 'composite_state' itself if there is no history yet
+     */
+    t_iterator history(t_iterator composite_state, History kind = History::Shallow) const
+    {
+        uint32_t target = recordedHistory(stateIndex(composite_state), kind);
+        return (target == NO_STATE) ? composite_state : m_topology.state(target);
+    }
+
+    void init()
+    {
+        // std::cout << "This is m_current_state: " << typeid(m_current_state).name() << std::endl;
+        m_current_state.node->data->on_entry();
+
+        if (!m_orthogonal.empty())
+        {
+            // Every region of the orthogonal states involved must be active as well
+            t_iterator initial = m_current_state;
+            m_active.clear();
+            enterChildren(initial, {}, 0);
+            for (auto it = initial; it != m_tree.begin(); it = m_tree.parent(it))
             {
-                commonAncestor = it;
-                break;
+                t_iterator parent = m_tree.parent(it);
+                if (!isOrthogonal(parent))
+                    continue;
+                for (auto* child = parent.node->first_child; child; child = child->next_sibling)
+                {
+                    if (child != it.node)
+                        enterDefault(t_iterator(child));
+                }
             }
-            else
+            setCurrentState(m_active.front());
+        }
+        configurationChanged();
+    }
+
+    /**
+     * Starts over from 'initial_state', e.g. once a step threw: the states of the failed
+     * configuration are not exited, its continuations are destroyed, pending transitions and
+     * history are dropped, then 'initial_state' is entered as by init(). The tree, the transition
+     * table and the mailbox are kept, so that a restart costs no more than entering the state
+     */
+    void restart(t_iterator initial_state)
+    {
+        for (auto handle : m_continuations)
+            handle.destroy();
+        m_continuations.clear();
+        m_pending.clear();
+        m_unhandled.clear();
+        m_dispatch_leaves.clear();
+        m_dispatch_leaf    = m_tree.end();
+        m_in_step          = false;
+        m_step_event       = &m_no_event;
+        m_transition_event = &m_no_event;
+        m_restoring_deep   = false;
+        std::fill(m_shallow_history.begin(), m_shallow_history.end(), NO_STATE);
+        std::fill(m_deep_history.begin(), m_deep_history.end(), NO_STATE);
+        setCurrentState(initial_state);
+        m_active.assign(1, initial_state);
+        init();
+    }
+
+    void processEvent(std::shared_ptr<IEvent> event)
+    {
+        m_step_event = &event;
+        step(event);
+    }
+
+    /**
+     * Same as above for an event delivered in an InlineEvent envelope, handed to the states'
+     * process_inline(). Transition table rows declared for the payload type match it, but their
+     * guards and actions get a nullptr event
+     */
+    void processEvent(const InlineEvent& event)
+    {
+        step(event);
+    }
+
+    void currentState(t_iterator current_state)
+    {
+        setCurrentState(current_state);
+        m_active.assign(1, current_state);
+        configurationChanged();
+    }
+
+    t_iterator currentState()
+    {
+        return m_current_state;
+    }
+
+    // Innermost active state of every active region (a single one when no region is active)
+    const std::vector<t_iterator>& activeStates() const
+    {
+        return m_active;
+    }
+
+    bool isActive(t_iterator state) const
+    {
+        return std::any_of(m_active.begin(), m_active.end(),
+                           [&](t_iterator leaf) { return isDescendantOrSelf(leaf, state); });
+    }
+
+    /**
+     * Appends the configuration (active leaves and history of every state) to 'blob' as
+     * native-endian uint32_t state indices:
+     *  [state count][active count][active leaves...][shallow history...][deep history...]
+     * A state without history is stored as NO_STATE. The layout has no pointers nor padding, so a
+     * blob can be read back in place from a mapped file
+     */
+    void saveConfiguration(std::vector<uint8_t>& blob) const
+    {
+        auto put = [&](uint32_t value)
+        {
+            std::size_t offset = blob.size();
+            blob.resize(offset + sizeof(value));
+            std::memcpy(blob.data() + offset, &value, sizeof(value));
+        };
+        auto put_history = [&](const std::vector<uint32_t>& history)
+        {
+            for (uint32_t state : history)
+                put(state);
+        };
+
+        put(uint32_t(m_topology.size()));
+        put(uint32_t(m_active.size()));
+        for (auto& leaf : m_active)
+            put(uint32_t(stateIndex(leaf)));
+        put_history(m_shallow_history);
+        put_history(m_deep_history);
+    }
+
+    /**
+     * Puts the state machine straight into a configuration written by saveConfiguration(), in place
+     * of init(): no entry action is executed. Returns the number of bytes read, or 0 (and leaves
+     * the state machine untouched) if 'data' does not describe a configuration of this state tree
+     */
+    std::size_t restoreConfiguration(const uint8_t* data, std::size_t size)
+    {
+        const std::size_t count = m_topology.size();
+        std::size_t       read  = 0;
+        auto get = [&](uint32_t& value)
+        {
+            if (size - read < sizeof(value))
+                return false;
+            std::memcpy(&value, data + read, sizeof(value));
+            read += sizeof(value);
+            return true;
+        };
+
+        uint32_t state_count, active_count;
+        if (!get(state_count) || state_count != count || !get(active_count) || active_count == 0
+            || active_count > count || size - read < (active_count + 2 * count) * sizeof(uint32_t))
+            return 0;
+
+        std::vector<t_iterator> active;
+        for (uint32_t i = 0, index; i < active_count; i++)
+        {
+            get(index);
+            if (index >= count)
+                return 0;
+            active.push_back(m_topology.state(index));
+        }
+        std::vector<uint32_t> history[2];
+        for (auto& entries : history)
+        {
+            for (std::size_t i = 0; i < count; i++)
             {
-                it.node->data->on_exit();
+                uint32_t value;
+                get(value);
+                if (value != NO_STATE && value >= count)
+                    return 0;
+                entries.push_back(value);
             }
         }
 
-        /* Did not find common ancestor */
-        if (it_commonAncestor == ancestorsB.end())
+        m_active          = std::move(active);
+        m_shallow_history = std::move(history[0]);
+        m_deep_history    = std::move(history[1]);
+        setCurrentState(m_active.front());
+        configurationChanged();
+        return read;
+    }
+
+    /**
+     * How to put an event into the mailbox of this state machine's own actor (e.g. its queue's
+     * put()), through which continuations suspended by yield() are scheduled back. Required by
+     * yield()
+     */
+    void setMailbox(SignatureIEvent mailbox)
+    {
+        m_mailbox = std::move(mailbox);
+    }
+
+    /**
+     * Runs 'continuation' on behalf of 'owner' (normally the state whose handler calls spawn())
+     * up to its first co_await. Later steps of processEvent() resume it when what it awaits is
+     * delivered, within the step (so its requestTransition()s are deferred as a handler's are).
+     * It is cancelled, i.e. destroyed wherever it is suspended, when 'owner' is exited
+     */
+    void spawn(t_iterator owner, Continuation continuation)
+    {
+        auto handle            = continuation.release();
+        handle.promise().owner = stateIndex(owner);
+        m_continuations.push_back(handle);
+        resume(handle);
+    }
+
+    /**
+     * Awaited by a continuation: 'co_await' suspends it until the event it was armed with is
+     * processed (yield(), resumeWhen()), or until an event of type E arrives (nextEvent<E>()),
+     * and returns that event (nullptr for the former)
+     */
+    template <class E>
+    class Awaiter
+    {
+       public:
+        Awaiter(StateManager& manager, SignatureIEvent arm, std::size_t awaited_type)
+            : m_manager{manager}, m_arm{std::move(arm)}, m_awaited_type{awaited_type}
+        {
+        }
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+        void await_suspend(Continuation::t_handle handle)
+        {
+            m_handle      = handle;
+            auto& promise = handle.promise();
+            if (m_awaited_type != 0)
+            {
+                promise.awaited_type = m_awaited_type;
+                return;
+            }
+            promise.ticket = ++m_manager.m_last_ticket;
+            m_arm(std::make_shared<ContinuationResume>(promise.ticket));
+        }
+        std::shared_ptr<E> await_resume()
+        {
+            return std::static_pointer_cast<E>(std::exchange(m_handle.promise().event, nullptr));
+        }
+
+       private:
+        StateManager&          m_manager;
+        SignatureIEvent        m_arm;
+        std::size_t            m_awaited_type;
+        Continuation::t_handle m_handle;
+    };
+
+    /**
+     * Resumes the continuation once the events already in the mailbox (see setMailbox()) are
+     * done. That holds for a mailbox keeping the order of every put() (Ordering::Total); one
+     * keeping each sender's order only (Ordering::PerSender) may resume it before the events
+     * other threads put earlier. Throws std::logic_error if setMailbox() was not called
+     */
+    Awaiter<IEvent> yield()
+    {
+        if (!m_mailbox)
+            throw std::logic_error("StateManager::yield() needs setMailbox() first");
+        return Awaiter<IEvent>(*this, m_mailbox, 0);
+    }
+
+    /**
+     * Resumes the continuation once the event given to 'arm' is processed: 'arm' must have it
+     * delivered to the actor, e.g. from a timer callback putting it into the actor's queue
+     */
+    Awaiter<IEvent> resumeWhen(SignatureIEvent arm)
+    {
+        return Awaiter<IEvent>(*this, std::move(arm), 0);
+    }
+
+    /**
+     * Resumes the continuation with the next event of type E given to processEvent(IEvent_ptr),
+     * which is then consumed by the continuation instead of being dispatched to the states
+     */
+    template <class E>
+    Awaiter<E> nextEvent()
+    {
+        return Awaiter<E>(*this, nullptr, typeid(E).hash_code());
+    }
+
+    // Continuations spawned and neither finished nor cancelled yet
+    std::size_t continuations() const
+    {
+        return m_continuations.size();
+    }
+
+    /**
+     * Event types the active configuration may handle: those declared (see declareHandled() and
+     * addTransition()) by the active states and their ancestors. Every event type as soon as one
+     * of them has no declaration
+     */
+    EventFilter handledEvents() const
+    {
+        EventFilter filter;
+        for (auto& leaf : m_active)
         {
-            it_commonAncestor = ancestorsB.begin();
+            for (std::size_t i = stateIndex(leaf);; i = m_topology.parent(i))
+            {
+                if (!m_topology.isDeclared(i))
+                    return EventFilter::all();
+                const auto& handles = m_topology.handled(i);
+                for (uint32_t id = 1; id < handles.size(); id++)
+                {
+                    if (handles[id])
+                        filter.add(id);
+                }
+                if (m_topology.isRoot(i))
+                    break;
+            }
         }
+        return filter;
+    }
+
+    using t_listener_id = uint64_t;
+
+    /**
+     * Calls 'listener' whenever the set of active states changes: after init(), after every
+     * transition that is not a self-transition, and after a configuration is set or restored.
+     * Lets a subscription follow handledEvents() (see Topic::follow()). Every listener added is
+     * called, in the order they were added, until removed with the returned id
+     */
+    t_listener_id onConfigurationChange(std::function<void()> listener)
+    {
+        m_listeners.push_back({++m_last_listener_id, std::move(listener)});
+        return m_last_listener_id;
+    }
+
+    // May be called from a listener, including for itself
+    void removeConfigurationListener(t_listener_id id)
+    {
+        auto it = std::find_if(m_listeners.begin(), m_listeners.end(),
+                               [id](const Listener& listener) { return listener.id == id; });
+        if (it == m_listeners.end())
+            return;
+        if (m_notifying)
+            it->call = nullptr;  // Erased once every listener was called
         else
+            m_listeners.erase(it);
+    }
+
+    static constexpr uint32_t NO_STATE = StateTopology<T>::NO_STATE;
+
+   private:
+    void setCurrentState(t_iterator state)
+    {
+        setCurrentState(stateIndex(state));
+    }
+
+    void setCurrentState(std::size_t index)
+    {
+        m_current_state = m_topology.state(index);
+        m_current_index = index;
+    }
+
+    void configurationChanged()
+    {
+        if (m_listeners.empty())
+            return;
+        // A deque keeps its elements in place when a listener adds another one, which is only
+        // called from the next change on
+        struct Notifying
+        {
+            StateManager& manager;
+            ~Notifying()
+            {
+                manager.m_notifying = false;
+                std::erase_if(manager.m_listeners, [](const Listener& listener)
+                              { return !listener.call; });
+            }
+        } notifying{*this};
+        m_notifying = true;
+        for (std::size_t i = 0, count = m_listeners.size(); i < count; i++)
+        {
+            if (m_listeners[i].call)
+                m_listeners[i].call();
+        }
+    }
+
+    void runAction(const t_action& action)
+    {
+        if (action)
+            action(*m_transition_event);
+    }
+
+    /**
+     * Ends a step, even one left by an exception: the transitions it requested are dropped and
+     * no pointer to its event, destroyed by then, is kept
+     */
+    struct StepGuard
+    {
+        StateManager& manager;
+        ~StepGuard()
         {
-            it_commonAncestor++;
+            manager.m_pending.clear();
+            manager.m_dispatch_leaf    = manager.m_tree.end();
+            manager.m_transition_event = &manager.m_no_event;
+            manager.m_step_event       = &manager.m_no_event;
+            manager.m_in_step          = false;
         }
+    };
 
-        for (auto it = it_commonAncestor; it != ancestorsB.end(); ++it)
+    template <class Event>
+    void step(const Event& event)
+    {
+        StepGuard guard{*this};
+        m_in_step = true;
+        if (!resumeContinuation(event))
         {
-            (*it).node->data->on_entry();
+            if (m_active.size() == 1)
+            {
+                // Bubbles up through the flat parent indices, from the current state to the root,
+                // jumping over the states declared not to handle the event
+                m_dispatch_leaf      = m_current_state;
+                const uint32_t id    = eventIdOf(event);
+                uint32_t       index = m_topology.firstHandler(m_current_index, id);
+                while (index != NO_STATE && dispatch(index, event) != 0)
+                {
+                    index = m_topology.isRoot(index)
+                                ? NO_STATE
+                                : m_topology.firstHandler(m_topology.parent(index), id);
+                }
+            }
+            else
+            {
+                dispatchToRegions(event);
+            }
         }
-        m_current_state = target_state;
+        applyPendingTransitions();
     }
 
-    void init()
+    /**
+     * Resumes the continuation awaiting 'event', if any. Returns true if the event was meant for
+     * a continuation, including the resume events of continuations cancelled since, which are
+     * dropped
+     */
+    bool resumeContinuation(const IEvent_ptr& event)
     {
-        // std::cout << "This is m_current_state: " << typeid(m_current_state).name() << std::endl;
-        m_current_state.node->data->on_entry();
+        if (m_continuations.empty() && m_last_ticket == 0)
+            return false;
+        if (event->getEventId() == eventId<ContinuationResume>())
+        {
+            uint64_t ticket = static_cast<const ContinuationResume&>(*event).ticket;
+            for (auto handle : m_continuations)
+            {
+                if (handle.promise().ticket == ticket)
+                {
+                    handle.promise().ticket = 0;
+                    resumeInStep(handle);
+                    break;
+                }
+            }
+            return true;
+        }
+        if (m_continuations.empty())
+            return false;
+        std::size_t type = event->getTypeHash();
+        for (auto handle : m_continuations)
+        {
+            auto& promise = handle.promise();
+            if (promise.awaited_type == type)
+            {
+                promise.awaited_type = 0;
+                promise.event        = event;
+                resumeInStep(handle);
+                return true;
+            }
+        }
+        return false;
     }
 
-    void processEvent(std::shared_ptr<IEvent> event)
+    // InlineEvents are never awaited
+    bool resumeContinuation(const InlineEvent&)
+    {
+        return false;
+    }
+
+    // Transitions the continuation requests are taken from the active leaf under its owner
+    void resumeInStep(Continuation::t_handle handle)
     {
-        if (m_current_state.node->data->process_event(event) != 0)
+        m_dispatch_leaf = closestLeaf(m_topology.state(handle.promise().owner));
+        resume(handle);
+    }
+
+    void resume(Continuation::t_handle handle)
+    {
+        auto& promise   = handle.promise();
+        promise.running = true;
+        try
         {
-            t_iterator parent_state = m_tree.parent(m_current_state);
-            while ((parent_state.node->data->process_event(event) != 0)
-                   && (parent_state != m_tree.begin()))
+            handle.resume();
+        }
+        catch (...)
+        {
+            // Rethrown by unhandled_exception(): the coroutine is done, and goes with the step
+            forget(handle);
+            throw;
+        }
+        promise.running = false;
+        if (handle.done() || promise.cancelled)
+            forget(handle);
+    }
+
+    void forget(Continuation::t_handle handle)
+    {
+        m_continuations.erase(std::find(m_continuations.begin(), m_continuations.end(), handle));
+        handle.destroy();
+    }
+
+    // A continuation cancelled while running is only destroyed once it suspends
+    void cancelContinuations(t_iterator state)
+    {
+        if (m_continuations.empty())
+            return;
+        std::size_t index = stateIndex(state);
+        for (std::size_t i = 0; i < m_continuations.size();)
+        {
+            auto  handle  = m_continuations[i];
+            auto& promise = handle.promise();
+            if (promise.owner != index || promise.running)
             {
-                parent_state = m_tree.parent(parent_state);
+                if (promise.owner == index)
+                    promise.cancelled = true;
+                i++;
+                continue;
             }
+            m_continuations.erase(m_continuations.begin() + i);
+            handle.destroy();
         }
     }
 
-    void currentState(t_iterator current_state)
+    // Declared transitions of the state first, then the state's own handler
+    template <class Event>
+    int dispatch(std::size_t index, const Event& event)
     {
-        m_current_state = current_state;
+        const auto& rows = m_table[index];
+        if (!rows.empty())
+        {
+            std::size_t event_type = typeHash(event);
+            for (const auto& row : rows)
+            {
+                if (row.event_type == event_type && (!row.guard || row.guard(*m_step_event)))
+                {
+                    m_pending.push_back(
+                        {m_dispatch_leaf, row.target, History::None, row.action, *m_step_event});
+                    return 0;
+                }
+            }
+        }
+        return handle(m_topology.state(index), event);
     }
 
-    t_iterator currentState()
+    static std::size_t typeHash(const IEvent_ptr& event)
     {
-        return m_current_state;
+        return event->getTypeHash();
     }
 
-   private:
-    tree<T>    m_tree;
-    t_iterator m_current_state;
+    static std::size_t typeHash(const InlineEvent& event)
+    {
+        return event.typeHash();
+    }
+
+    static uint32_t eventIdOf(const IEvent_ptr& event)
+    {
+        return event->getEventId();
+    }
+
+    static uint32_t eventIdOf(const InlineEvent& event)
+    {
+        return event.id();
+    }
+
+    static int handle(t_iterator state, const IEvent_ptr& event)
+    {
+        return state.node->data->process_event(event);
+    }
+
+    static int handle(t_iterator state, const InlineEvent& event)
+    {
+        return state.node->data->process_inline(event);
+    }
+
+    bool isActiveLeaf(t_iterator state) const
+    {
+        return std::find(m_active.begin(), m_active.end(), state) != m_active.end();
+    }
+
+    uint32_t recordedHistory(std::size_t composite, History kind) const
+    {
+        return (kind == History::Deep) ? m_deep_history[composite] : m_shallow_history[composite];
+    }
+
+    void recordExit(t_iterator state, t_iterator leaf)
+    {
+        recordExit(stateIndex(state), stateIndex(leaf));
+    }
+
+    /* State 'state' is being exited while 'leaf' was the innermost active state below it */
+    void recordExit(std::size_t state, std::size_t leaf)
+    {
+        m_topology.recordExit(state, leaf,
+                              [this](std::size_t composite, uint32_t shallow, uint32_t deep)
+                              {
+                                  m_shallow_history[composite] = shallow;
+                                  m_deep_history[composite]    = deep;
+                              });
+    }
+
+    bool isDescendantOrSelf(t_iterator state, t_iterator ancestor) const
+    {
+        for (auto* node = state.node; node; node = node->parent)
+        {
+            if (node == ancestor.node)
+                return true;
+        }
+        return false;
+    }
+
+    t_iterator nearestOrthogonalAncestor(t_iterator state) const
+    {
+        for (auto* node = state.node->parent; node; node = node->parent)
+        {
+            if (isOrthogonal(t_iterator(node)))
+                return t_iterator(node);
+        }
+        return m_tree.end();
+    }
+
+    // Active leaf sharing the deepest common ancestor with 'target_state'
+    t_iterator closestLeaf(t_iterator target_state) const
+    {
+        for (auto* node = target_state.node; node; node = node->parent)
+        {
+            for (auto& leaf : m_active)
+            {
+                if (isDescendantOrSelf(leaf, t_iterator(node)))
+                    return leaf;
+            }
+        }
+        return m_active.front();
+    }
+
+    /**
+     * Every region gets the event, bubbling from its innermost active state up to (excluding) its
+     * orthogonal state. An orthogonal state only gets the event if none of its regions handled it
+     */
+    template <class Event>
+    void dispatchToRegions(const Event& event)
+    {
+        m_unhandled.clear();
+        m_dispatch_leaves = m_active;
+        for (auto& leaf : m_dispatch_leaves)
+        {
+            m_dispatch_leaf = leaf;
+            bubble(stateIndex(leaf), event);
+        }
+
+        // Deepest orthogonal states first, so that nested regions are resolved before outer ones
+        while (true)
+        {
+            auto next = m_unhandled.end();
+            for (auto it = m_unhandled.begin(); it != m_unhandled.end(); ++it)
+            {
+                if (!it->done
+                    && (next == m_unhandled.end()
+                        || m_tree.depth(it->state) > m_tree.depth(next->state)))
+                    next = it;
+            }
+            if (next == m_unhandled.end())
+                break;
+
+            next->done             = true;
+            t_iterator orthogonal  = next->state;
+            bool       was_handled = next->handled;
+            if (was_handled)
+            {
+                noteRegionResult(nearestOrthogonalAncestor(orthogonal), true);
+            }
+            else
+            {
+                for (auto& leaf : m_dispatch_leaves)
+                {
+                    if (isDescendantOrSelf(leaf, orthogonal))
+                    {
+                        m_dispatch_leaf = leaf;
+                        break;
+                    }
+                }
+                bubble(stateIndex(orthogonal), event);
+            }
+        }
+    }
+
+    template <class Event>
+    void bubble(std::size_t index, const Event& event)
+    {
+        while (true)
+        {
+            if (dispatch(index, event) == 0)
+            {
+                noteRegionResult(nearestOrthogonalAncestor(m_topology.state(index)), true);
+                return;
+            }
+            std::size_t parent = m_topology.parent(index);
+            if (parent == index)
+                return;
+            if (m_orthogonal_index[parent])
+            {
+                noteRegionResult(m_topology.state(parent), false);
+                return;
+            }
+            index = parent;
+        }
+    }
+
+    void noteRegionResult(t_iterator orthogonal, bool handled)
+    {
+        if (orthogonal == m_tree.end())
+            return;
+        for (auto& entry : m_unhandled)
+        {
+            if (entry.state == orthogonal)
+            {
+                entry.handled = entry.handled || handled;
+                return;
+            }
+        }
+        m_unhandled.push_back({orthogonal, handled, false});
+    }
+
+    void applyPendingTransitions()
+    {
+        // Transitions requested by entry/exit actions are appended and executed in the same step
+        m_dispatch_leaf = m_tree.end();
+        for (std::size_t i = 0; i < m_pending.size(); i++)
+        {
+            PendingTransition pending = std::move(m_pending[i]);
+            m_transition_event        = &pending.event;
+            if (pending.history != History::None)
+            {
+                if (pending.source == m_tree.end() || isActiveLeaf(pending.source))
+                    transitionToHistory(pending.target, pending.history, pending.action);
+            }
+            else if (pending.source == m_tree.end())
+            {
+                transitionTo(pending.target, pending.action);
+            }
+            else if (isActiveLeaf(pending.source))
+            {
+                if (m_orthogonal.empty())
+                    transitionTo(pending.target, pending.action);
+                else
+                    transitionFrom(pending.source, m_topology.state(pending.target),
+                                   pending.action);
+            }
+            // else: the requesting region has been exited by an earlier transition of this step
+        }
+        m_transition_event = &m_no_event;
+        m_pending.clear();
+    }
+
+    /**
+     * Same semantics as the single-region transitionTo(), generalized to a configuration with
+     * several active leaves: every active state below the common ancestor is exited (innermost
+     * first), and the regions of every orthogonal state entered along the way are entered too
+     */
+    void transitionFrom(t_iterator source, t_iterator target_state, const t_action& action)
+    {
+        // Special case: self-transition
+        if (target_state == source)
+        {
+            recordExit(source, source);
+            cancelContinuations(source);
+            source.node->data->on_exit();
+            runAction(action);
+            source.node->data->on_entry();
+            return;
+        }
+
+        std::vector<t_iterator> path;
+        for (auto it = target_state; it != m_tree.begin(); it = m_tree.parent(it))
+        {
+            path.insert(path.begin(), it);
+        }
+
+        t_iterator  common = m_tree.begin();
+        std::size_t first  = 0;
+        for (auto it = source; it != m_tree.begin(); it = m_tree.parent(it))
+        {
+            auto found = std::find(path.begin(), path.end(), it);
+            if (found != path.end())
+            {
+                common = it;
+                first  = std::distance(path.begin(), found) + 1;
+                break;
+            }
+        }
+
+        // Exit every active state below the common ancestor, innermost first
+        std::vector<t_iterator> exiting;
+        std::size_t             insert_at = m_active.size();
+        for (std::size_t i = m_active.size(); i-- > 0;)
+        {
+            if (!isDescendantOrSelf(m_active[i], common))
+                continue;
+            insert_at = i;
+            for (auto it = m_active[i]; it != common; it = m_tree.parent(it))
+            {
+                recordExit(it, m_active[i]);
+                if (std::find(exiting.begin(), exiting.end(), it) == exiting.end())
+                    exiting.push_back(it);
+            }
+            m_active.erase(m_active.begin() + i);
+        }
+        std::stable_sort(exiting.begin(), exiting.end(), [&](t_iterator a, t_iterator b)
+                         { return m_tree.depth(a) > m_tree.depth(b); });
+        for (auto& it : exiting)
+        {
+            cancelContinuations(it);
+            it.node->data->on_exit();
+        }
+        runAction(action);
+
+        // Enter down to the target, completing every orthogonal state on the way
+        std::vector<t_iterator> leaves;
+        std::swap(leaves, m_active);
+        enterChildren(common, path, first);
+        leaves.insert(leaves.begin() + std::min(insert_at, leaves.size()), m_active.begin(),
+                      m_active.end());
+        m_active = std::move(leaves);
+        setCurrentState(m_active.front());
+        configurationChanged();
+    }
+
+    /* 'path[index]', if any, is the child of 'parent' that leads to the target */
+    void enterChildren(t_iterator parent, const std::vector<t_iterator>& path, std::size_t index)
+    {
+        if (isOrthogonal(parent))
+        {
+            for (auto* child = parent.node->first_child; child; child = child->next_sibling)
+            {
+                if (index < path.size() && child == path[index].node)
+                {
+                    path[index].node->data->on_entry();
+                    enterChildren(path[index], path, index + 1);
+                }
+                else
+                {
+                    enterDefault(t_iterator(child));
+                }
+            }
+        }
+        else if (index < path.size())
+        {
+            path[index].node->data->on_entry();
+            enterChildren(path[index], path, index + 1);
+        }
+        else
+        {
+            m_active.push_back(parent);
+        }
+    }
+
+    void enterDefault(t_iterator state)
+    {
+        state.node->data->on_entry();
+
+        uint32_t deep_index =
+            m_restoring_deep ? recordedHistory(stateIndex(state), History::Deep) : NO_STATE;
+        if (deep_index == NO_STATE)
+        {
+            enterChildren(state, {}, 0);
+            return;
+        }
+
+        // Restoring deep history: the region resumes its own last configuration
+        t_iterator              deep = m_topology.state(deep_index);
+        std::vector<t_iterator> path;
+        for (auto it = deep; it != state; it = m_tree.parent(it))
+        {
+            path.insert(path.begin(), it);
+        }
+        enterChildren(state, path, 0);
+    }
+
+    struct RegionResult
+    {
+        t_iterator state;
+        bool       handled;
+        bool       done;
+    };
+
+    struct PendingTransition
+    {
+        t_iterator  source;
+        std::size_t target;  // State index, the composite state for a history transition
+        History    history;
+        t_action   action;
+        IEvent_ptr event;
+    };
+
+    struct TransitionRow
+    {
+        std::size_t event_type;
+        std::size_t target;  // State index
+        t_action    action;
+        t_guard     guard;
+    };
+
+    tree<T>     m_tree;
+    t_iterator  m_current_state;
+    std::size_t m_current_index;
+
+    std::vector<t_iterator>                        m_active;
+    std::vector<t_iterator>                        m_orthogonal;
+    std::vector<t_iterator>                        m_dispatch_leaves;
+    std::vector<RegionResult>                      m_unhandled;
+    std::vector<PendingTransition>                 m_pending;
+    t_iterator                                     m_dispatch_leaf;
+    bool                                           m_in_step{false};
+    IEvent_ptr                                     m_no_event;
+    const IEvent_ptr*                              m_step_event{&m_no_event};
+    const IEvent_ptr*                              m_transition_event{&m_no_event};
+
+    StateTopology<T>                             m_topology;
+    std::vector<std::vector<TransitionRow>>      m_table;
+    std::vector<bool>                            m_orthogonal_index;
+    std::vector<uint32_t>                        m_shallow_history;  // State indices, or NO_STATE
+    std::vector<uint32_t>                        m_deep_history;
+    bool                                         m_restoring_deep{false};
+    struct Listener
+    {
+        t_listener_id         id;
+        std::function<void()> call;
+    };
+    std::deque<Listener> m_listeners;
+    t_listener_id        m_last_listener_id{0};
+    bool                 m_notifying{false};
+    std::vector<Continuation::t_handle>          m_continuations;  // Suspended, oldest first
+    SignatureIEvent                              m_mailbox;
+    uint64_t                                     m_last_ticket{0};
 };
 
-#endif
\ No newline at end of file
+#endif
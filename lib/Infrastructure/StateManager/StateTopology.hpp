@@ -0,0 +1,238 @@
+#ifndef __STATETOPOLOGY_H_
+#define __STATETOPOLOGY_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "tree/tree.h"
+
+/**
+ * Flat view of a state tree, shared by the StateManager and the MachineArray: dense pre-order
+ * numbering, the parent and depth of every state, the exit/entry sequence of a transition and
+ * the event types each state is declared to handle, with the routes derived from them. The tree
+ * must not change once the topology is built
+ */
+template <typename T>
+class StateTopology
+{
+   public:
+    using t_iterator = typename tree<T>::iterator;
+
+    static constexpr uint32_t    NO_STATE    = 0xFFFFFFFF;
+    static constexpr std::size_t NO_ANCESTOR = ~std::size_t(0);
+
+    explicit StateTopology(tree<T>& state_tree)
+    {
+        for (auto it = state_tree.begin(); it != state_tree.end(); ++it)
+        {
+            m_index[it.node] = m_states.size();
+            m_states.push_back(it);
+        }
+        for (auto& state : m_states)
+        {
+            // Roots are their own parent
+            auto* parent = state.node->parent ? state.node->parent : state.node;
+            m_parent.push_back(uint32_t(m_index[parent]));
+            // Pre-order: the parent is numbered (and its depth known) before its children
+            m_depth.push_back(
+                m_parent.back() == m_parent.size() - 1 ? 0 : m_depth[m_parent.back()] + 1);
+        }
+        m_declared.assign(m_states.size(), false);
+        m_handles.resize(m_states.size());
+    }
+
+    std::size_t size() const
+    {
+        return m_states.size();
+    }
+
+    // Throws std::out_of_range for a state of another tree
+    std::size_t index(t_iterator state) const
+    {
+        return m_index.at(state.node);
+    }
+
+    t_iterator state(std::size_t index) const
+    {
+        return m_states[index];
+    }
+
+    std::size_t parent(std::size_t index) const
+    {
+        return m_parent[index];
+    }
+
+    std::size_t depth(std::size_t index) const
+    {
+        return m_depth[index];
+    }
+
+    bool isRoot(std::size_t index) const
+    {
+        return m_parent[index] == index;
+    }
+
+    // Deepest state that is 'a' or one of its ancestors, and 'b' or one of its ancestors.
+    // NO_ANCESTOR for states under different top-level roots
+    std::size_t commonAncestor(std::size_t a, std::size_t b) const
+    {
+        while (m_depth[a] > m_depth[b])
+            a = m_parent[a];
+        while (m_depth[b] > m_depth[a])
+            b = m_parent[b];
+        while (a != b)
+        {
+            if (m_parent[a] == a)
+                return NO_ANCESTOR;
+            a = m_parent[a];
+            b = m_parent[b];
+        }
+        return a;
+    }
+
+    /**
+     * Single-region transition from the leaf 'source' to 'target': exit(state) for every state
+     * up to the least common ancestor, innermost first, then between(), then enter(state) down to
+     * 'target', outermost first. A self-transition exits and re-enters 'source'. Walks the flat
+     * parent indices, so it makes no heap allocation nor lookup. The head of the tree is never
+     * exited nor entered
+     */
+    template <class Exit, class Between, class Enter>
+    void transition(std::size_t source, std::size_t target, Exit&& exit, Between&& between,
+                    Enter&& enter) const
+    {
+        if (source == target)
+        {
+            exit(source);
+            between();
+            enter(source);
+            return;
+        }
+
+        const std::size_t common = commonAncestor(source, target);
+        for (std::size_t i = source; i != common && i != 0; i = m_parent[i])
+        {
+            exit(i);
+            if (m_parent[i] == i)
+                break;
+        }
+        between();
+        // The ancestor of the target at each depth below the common ancestor
+        for (std::size_t depth = (common == NO_ANCESTOR) ? 0 : m_depth[common] + 1;
+             depth <= m_depth[target]; depth++)
+        {
+            std::size_t entered = target;
+            while (m_depth[entered] > depth)
+                entered = m_parent[entered];
+            if (entered != 0)
+                enter(entered);
+        }
+    }
+
+    /**
+     * 'state' is being exited while 'leaf' was the innermost active state below it: calls
+     * record(composite, shallow, deep) for each history entry this rewrites. A state exited while
+     * none of its children was active forgets its own history
+     */
+    template <class Record>
+    void recordExit(std::size_t state, std::size_t leaf, Record&& record) const
+    {
+        if (state == leaf)
+            record(state, NO_STATE, NO_STATE);
+        if (m_parent[state] != state)
+            record(std::size_t(m_parent[state]), uint32_t(state), uint32_t(leaf));
+    }
+
+    // From now on, 'index' only gets the events marked with markHandled()
+    void declare(std::size_t index)
+    {
+        m_declared[index] = true;
+        m_route.assign(m_route.size(), UNROUTED);
+    }
+
+    void markHandled(std::size_t index, uint32_t id)
+    {
+        auto& handles = m_handles[index];
+        if (handles.size() <= id)
+            handles.resize(id + 1, false);
+        handles[id] = true;
+        m_route.assign(m_route.size(), UNROUTED);
+    }
+
+    bool isDeclared(std::size_t index) const
+    {
+        return m_declared[index];
+    }
+
+    // [event id] of the events marked as handled by 'index'
+    const std::vector<bool>& handled(std::size_t index) const
+    {
+        return m_handles[index];
+    }
+
+    /**
+     * 'index' itself or its nearest ancestor that may handle events of dense id 'id' (NO_STATE if
+     * none does). Computed once per (state, event id) and then read from a flat table
+     */
+    uint32_t firstHandler(std::size_t index, uint32_t id)
+    {
+        if (id == 0)
+            return uint32_t(index);  // Event without dense id, every state gets it
+        if (id >= m_route_stride)
+        {
+            m_route_stride = std::max<std::size_t>(2 * m_route_stride, id + 1);
+            m_route.assign(m_states.size() * m_route_stride, UNROUTED);
+        }
+        uint32_t& route = m_route[index * m_route_stride + id];
+        if (route == UNROUTED)
+        {
+            route = NO_STATE;
+            for (std::size_t i = index;; i = m_parent[i])
+            {
+                const auto& handles = m_handles[i];
+                if (!m_declared[i] || (id < handles.size() && handles[id]))
+                {
+                    route = uint32_t(i);
+                    break;
+                }
+                if (m_parent[i] == i)
+                    break;
+            }
+        }
+        return route;
+    }
+
+    /**
+     * Computes the routes of every id of 'ids' for every state, after which firstHandler() only
+     * reads them for those ids: threads may then share the topology until the next resolve or
+     * declaration
+     */
+    template <class Ids>
+    void resolveRoutes(const Ids& ids)
+    {
+        // Grows the table for the largest id first, growing it drops the routes computed so far
+        for (uint32_t id : ids)
+            firstHandler(0, id);
+        for (uint32_t id : ids)
+        {
+            for (std::size_t index = 0; index < m_states.size(); index++)
+                firstHandler(index, id);
+        }
+    }
+
+   private:
+    static constexpr uint32_t UNROUTED = 0xFFFFFFFE;  // m_route entry not computed yet
+
+    std::unordered_map<const void*, std::size_t> m_index;
+    std::vector<t_iterator>                      m_states;
+    std::vector<uint32_t>                        m_parent;
+    std::vector<uint32_t>                        m_depth;
+    std::vector<bool>                            m_declared;
+    std::vector<std::vector<bool>>               m_handles;  // [state][event id]
+    std::vector<uint32_t>                        m_route;    // [state * m_route_stride + event id]
+    std::size_t                                  m_route_stride{0};
+};
+
+#endif
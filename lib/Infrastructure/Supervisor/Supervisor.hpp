@@ -0,0 +1,262 @@
+#ifndef __SUPERVISOR_H_
+#define __SUPERVISOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#include <boost/core/demangle.hpp>
+
+#include "BoostDeadlineTimer/Clock.hpp"
+#include "Logger/Logger.hpp"
+
+#define LOG_SUP(lvl) (LOG("Supervisor.hpp", lvl))
+
+/**
+ * Catches the exceptions escaping a run-to-completion step of its children and restarts them in
+ * place, on their own thread and with their mailbox untouched, instead of letting the exception
+ * terminate the process. Each actor's run loop wraps its steps:
+ *   m_child->step(*event, [&]() { m_state_manager->processEvent(event); });
+ * where m_child came from supervise() with a callback resetting the actor, typically
+ *   [this]() { m_state_manager->restart(m_states[StateValue::STATE_A]); }
+ * OneForOne restarts the failed child only, right away. OneForAll restarts the others too, each
+ * before its next step. More than 'restarts' restarts within 'period' means the failures are not
+ * transient: the supervisor gives up and escalates to its parent, which restarts the whole
+ * subtree as one child, or, at the root, calls 'escalate' (logs and terminates by default)
+ */
+class Supervisor
+{
+   public:
+    enum class Strategy
+    {
+        OneForOne,
+        OneForAll
+    };
+
+    struct Intensity
+    {
+        std::size_t              restarts;
+        std::chrono::nanoseconds period;
+    };
+    static constexpr Intensity DEFAULT_INTENSITY{3, std::chrono::seconds{5}};
+
+    struct Failure
+    {
+        std::string child;
+        std::string event;  // Demangled type of the event being processed
+        std::string what;
+    };
+    using t_escalate = std::function<void(const Failure&)>;
+
+    class Child
+    {
+       public:
+        /**
+         * Runs 'step' for 'event', returning false if it threw. A restart requested by the
+         * supervisor is applied first, and right after the failure for a OneForOne restart. A
+         * restart that throws (e.g. from an on_entry()) is a failure of the step as well, and is
+         * tried again before the next one. Costs one relaxed load when nothing fails
+         */
+        template <class Event, class Step>
+        bool step(const Event& event, Step&& step)
+        {
+            const bool done = attempt(typeid(event),
+                                      [&]()
+                                      {
+                                          if (m_pending.load(std::memory_order_relaxed))
+                                              restartNow();
+                                          step();
+                                      });
+            if (!done && m_pending.load(std::memory_order_relaxed))
+                attempt(typeid(event), [&]() { restartNow(); });
+            return done;
+        }
+
+        const std::string& name() const
+        {
+            return m_name;
+        }
+
+        uint64_t restarts() const
+        {
+            return m_restarts.load(std::memory_order_relaxed);
+        }
+
+        Child(Supervisor* supervisor, std::string name, std::function<void()> restart)
+            : m_supervisor{supervisor}, m_name{std::move(name)}, m_restart{std::move(restart)}
+        {
+        }
+
+       private:
+        friend class Supervisor;
+
+        template <class Work>
+        bool attempt(const std::type_info& event, Work&& work)
+        {
+            try
+            {
+                work();
+                return true;
+            }
+            catch (const std::exception& exception)
+            {
+                failed(event, exception.what());
+            }
+            catch (...)
+            {
+                failed(event, "unknown exception");
+            }
+            return false;
+        }
+
+        void failed(const std::type_info& event, const char* what)
+        {
+            m_supervisor->fail(*this, Failure{m_name, boost::core::demangle(event.name()), what});
+        }
+
+        void restartNow()
+        {
+            m_pending.store(false, std::memory_order_relaxed);
+            m_restarts.fetch_add(1, std::memory_order_relaxed);
+            m_restart();
+        }
+
+        Supervisor*           m_supervisor;
+        std::string           m_name;
+        std::function<void()> m_restart;
+        Supervisor*           m_nested{nullptr};  // Set if the child is a supervisor itself
+        std::atomic_bool      m_pending{false};
+        std::atomic<uint64_t> m_restarts{0};
+    };
+
+    // Root of a supervision tree. Without a 'clock', the intensity period is in steady time
+    explicit Supervisor(Strategy  strategy  = Strategy::OneForOne,
+                        Intensity intensity = DEFAULT_INTENSITY,
+                        t_escalate escalate = nullptr, const Clock* clock = nullptr)
+        : m_strategy{strategy},
+          m_intensity{intensity},
+          m_escalate{escalate ? std::move(escalate) : giveUp},
+          m_clock{clock}
+    {
+    }
+
+    // Supervised by 'parent', to which it escalates
+    Supervisor(Supervisor& parent, std::string name, Strategy strategy = Strategy::OneForOne,
+               Intensity intensity = DEFAULT_INTENSITY)
+        : m_strategy{strategy}, m_intensity{intensity}, m_clock{parent.m_clock}, m_parent{&parent}
+    {
+        m_in_parent           = parent.supervise(std::move(name), nullptr);
+        m_in_parent->m_nested = this;
+    }
+
+    Supervisor(const Supervisor&)            = delete;
+    Supervisor& operator=(const Supervisor&) = delete;
+
+    // Handle for the run loop of the child 'name', valid as long as the Supervisor
+    Child* supervise(std::string name, std::function<void()> restart)
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        m_children.push_back(std::make_unique<Child>(this, std::move(name), std::move(restart)));
+        return m_children.back().get();
+    }
+
+    // Restarts decided by this supervisor so far
+    uint64_t restarts() const
+    {
+        return m_restarts.load(std::memory_order_relaxed);
+    }
+
+   private:
+    static void giveUp(const Failure& failure)
+    {
+        LOG_SUP(LEVEL_ERROR) << failure.child << ": too many restarts, last failure on "
+                             << failure.event << " (" << failure.what << ")" << std::endl;
+        std::terminate();
+    }
+
+    std::chrono::nanoseconds now() const
+    {
+        if (m_clock)
+            return m_clock->now();
+        return std::chrono::steady_clock::now().time_since_epoch();
+    }
+
+    // Called on the thread of the failed child, or of a failed descendant for a nested child
+    void fail(Child& child, const Failure& failure)
+    {
+        {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+            if (withinIntensity())
+            {
+                LOG_SUP(LEVEL_WARNING) << failure.child << ": restarting after " << failure.what
+                                       << " on " << failure.event << std::endl;
+                m_restarts.fetch_add(1, std::memory_order_relaxed);
+                if (m_strategy == Strategy::OneForOne)
+                {
+                    requestRestart(child);
+                }
+                else
+                {
+                    for (auto& sibling : m_children)
+                        requestRestart(*sibling);
+                }
+                return;
+            }
+            m_history.clear();
+        }
+        if (m_parent)
+            m_parent->fail(*m_in_parent, failure);
+        else
+            m_escalate(failure);
+    }
+
+    // Records a restart now, unless there were already too many within the period
+    bool withinIntensity()
+    {
+        auto current = now();
+        while (!m_history.empty() && current - m_history.front() >= m_intensity.period)
+            m_history.pop_front();
+        if (m_history.size() >= m_intensity.restarts)
+            return false;
+        m_history.push_back(current);
+        return true;
+    }
+
+    // Restarting a nested supervisor restarts all of its children, with a fresh intensity
+    static void requestRestart(Child& child)
+    {
+        if (!child.m_nested)
+        {
+            child.m_pending.store(true, std::memory_order_relaxed);
+            return;
+        }
+        child.m_restarts.fetch_add(1, std::memory_order_relaxed);
+        Supervisor&                  nested = *child.m_nested;
+        std::scoped_lock<std::mutex> lock(nested.m_mutex);
+        nested.m_history.clear();
+        for (auto& grandchild : nested.m_children)
+            requestRestart(*grandchild);
+    }
+
+    const Strategy                       m_strategy;
+    const Intensity                      m_intensity;
+    t_escalate                           m_escalate;
+    const Clock*                         m_clock;
+    Supervisor*                          m_parent{nullptr};
+    Child*                               m_in_parent{nullptr};
+    std::mutex                           m_mutex;
+    std::vector<std::unique_ptr<Child>>  m_children;
+    std::deque<std::chrono::nanoseconds> m_history;  // Times of the restarts within the period
+    std::atomic<uint64_t>                m_restarts{0};
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef __CACHELINE_H_
+#define __CACHELINE_H_
+
+#include <cstddef>
+#include <utility>
+
+/**
+ * Distance keeping two fields written by different threads from sharing a cache line, i.e.
+ * std::hardware_destructive_interference_size on x86-64 and most AArch64 cores. It is a constant
+ * of our own because the standard one may change with -mtune, and with it the layout of every
+ * structure padded with it (GCC warns about its use in headers for that reason)
+ */
+constexpr std::size_t CACHE_LINE = 64;
+
+/**
+ * True if a member of type G never shares a cache line with the members around it. Groups of
+ * fields written by the same side are gathered in such a type, so that
+ *   static_assert(isolatedLayout<Producer>);
+ * catches a field added to the group (or padding removed) that would bring false sharing back
+ */
+template <class G>
+constexpr bool isolatedLayout = (alignof(G) >= CACHE_LINE) && (sizeof(G) % CACHE_LINE == 0);
+
+/**
+ * A T alone on its cache line(s), e.g. a flag written by stop() and polled by a run loop next
+ * to members the run loop itself keeps writing
+ */
+template <class T>
+struct alignas(CACHE_LINE) CachePadded
+{
+    template <class... Args>
+    explicit CachePadded(Args&&... args) : value(std::forward<Args>(args)...)
+    {
+    }
+
+    T& operator*()
+    {
+        return value;
+    }
+    const T& operator*() const
+    {
+        return value;
+    }
+    T* operator->()
+    {
+        return &value;
+    }
+    const T* operator->() const
+    {
+        return &value;
+    }
+
+    T value;
+};
+
+#endif
@@ -0,0 +1,360 @@
+#ifndef __COMPACTTHREADSAFEQUEUE_H_
+#define __COMPACTTHREADSAFEQUEUE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "ThreadSafeQueue/ThreadSafeQueue.hpp"
+
+namespace detail
+{
+// Blocks while 'word' still holds 'expected', at most 'timeout_ns' if not negative
+inline void futexWait(std::atomic<uint32_t>& word, uint32_t expected, long timeout_ns = -1)
+{
+    timespec timeout{timeout_ns / 1000000000, timeout_ns % 1000000000};
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected,
+            (timeout_ns < 0) ? nullptr : &timeout, nullptr, 0);
+}
+
+inline void futexWake(std::atomic<uint32_t>& word, int count)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr,
+            nullptr, 0);
+}
+}  // namespace detail
+
+/**
+ * IThreadSafeQueue for large numbers of mostly idle actors. An empty queue owns no memory besides
+ * its own few dozen bytes: a futex word replaces the mutex and another one the condition
+ * variable. Elements are stored in fixed-size segments linked from front to back; a segment is
+ * handed back as soon as it is drained, to a small per-thread cache of free segments, so a queue
+ * grows with a burst and shrinks back once the burst is consumed
+ */
+template <typename T>
+class CompactThreadSafeQueue : public IThreadSafeQueue<T>
+{
+   public:
+    // Elements per segment, for segments of about 256 bytes
+    static constexpr uint32_t SEGMENT_CAPACITY =
+        (sizeof(T) < 60) ? uint32_t((256 - 2 * sizeof(void*)) / sizeof(T)) : 4;
+    // Free segments kept by each thread, beyond which drained segments are deleted
+    static constexpr std::size_t CACHED_SEGMENTS = 16;
+
+    CompactThreadSafeQueue() = default;
+
+    CompactThreadSafeQueue(const CompactThreadSafeQueue&)            = delete;
+    CompactThreadSafeQueue& operator=(const CompactThreadSafeQueue&) = delete;
+
+    ~CompactThreadSafeQueue()
+    {
+        clear();
+    }
+
+    /**
+     * A new segment is linked, and the slot counted, only once the element is constructed: if
+     * the allocation or T's constructor throws, the queue is left unchanged and unlocked
+     */
+    virtual void put(T element) override
+    {
+        lock();
+        Segment* fresh = nullptr;
+        try
+        {
+            if (!m_tail || m_tail->end == SEGMENT_CAPACITY)
+                fresh = acquire(0);
+            Segment* tail = fresh ? fresh : m_tail;
+            new (tail->slot(tail->end)) T(std::move(element));
+        }
+        catch (...)
+        {
+            delete fresh;
+            unlock();
+            throw;
+        }
+        if (fresh)
+        {
+            if (m_tail)
+                m_tail->next = fresh;
+            else
+                m_head = fresh;
+            m_tail = fresh;
+        }
+        m_tail->end++;
+        pushed();
+    }
+
+    virtual void put_prioritized(T element) override
+    {
+        lock();
+        Segment* fresh = nullptr;
+        try
+        {
+            if (!m_head || m_head->begin == 0)
+                fresh = acquire(SEGMENT_CAPACITY);
+            Segment* head = fresh ? fresh : m_head;
+            new (head->slot(head->begin - 1)) T(std::move(element));
+        }
+        catch (...)
+        {
+            delete fresh;
+            unlock();
+            throw;
+        }
+        if (fresh)
+        {
+            fresh->next = m_head;
+            m_head      = fresh;
+            if (!m_tail)
+                m_tail = fresh;
+        }
+        m_head->begin--;
+        pushed();
+    }
+
+    virtual T wait_and_pop() override
+    {
+        while (true)
+        {
+            T result;
+            if (try_pop(result))
+                return result;
+            m_waiters.fetch_add(1);
+            detail::futexWait(m_count, 0);
+            m_waiters.fetch_sub(1);
+        }
+    }
+
+    // Default-constructed T on timeout
+    virtual T wait_and_pop_for(const std::chrono::milliseconds& timeout) override
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (true)
+        {
+            T result;
+            if (try_pop(result))
+                return result;
+            auto left = deadline - std::chrono::steady_clock::now();
+            if (left <= std::chrono::steady_clock::duration::zero())
+                return T{};
+            m_waiters.fetch_add(1);
+            detail::futexWait(m_count, 0,
+                              std::chrono::duration_cast<std::chrono::nanoseconds>(left).count());
+            m_waiters.fetch_sub(1);
+        }
+    }
+
+    bool try_pop(T& result)
+    {
+        if (m_count.load() == 0)
+            return false;
+        lock();
+        if (!m_head)
+        {
+            unlock();
+            return false;
+        }
+        T* front = m_head->slot(m_head->begin);
+        try
+        {
+            result = std::move(*front);
+        }
+        catch (...)
+        {
+            unlock();
+            throw;
+        }
+        front->~T();
+        m_head->begin++;
+        if (m_head->begin == m_head->end)
+        {
+            Segment* drained = m_head;
+            m_head           = drained->next;
+            if (!m_head)
+                m_tail = nullptr;
+            release(drained);
+        }
+        m_count.fetch_sub(1);
+        unlock();
+        return true;
+    }
+
+    virtual bool empty() override
+    {
+        return m_count.load() == 0;
+    }
+
+    virtual std::size_t size() override
+    {
+        return m_count.load(std::memory_order_relaxed);
+    }
+
+    virtual void reset() override
+    {
+        clear();
+    }
+
+    virtual void clear() override
+    {
+        lock();
+        while (m_head)
+        {
+            Segment* segment = m_head;
+            for (uint32_t i = segment->begin; i < segment->end; i++)
+                segment->slot(i)->~T();
+            m_head = segment->next;
+            release(segment);
+        }
+        m_tail = nullptr;
+        m_count.store(0);
+        unlock();
+    }
+
+    virtual std::vector<T> snapshot() override
+    {
+        std::vector<T> result;
+        lock();
+        try
+        {
+            result.reserve(m_count.load(std::memory_order_relaxed));
+            for (Segment* segment = m_head; segment; segment = segment->next)
+            {
+                for (uint32_t i = segment->begin; i < segment->end; i++)
+                    result.push_back(*segment->slot(i));
+            }
+        }
+        catch (...)
+        {
+            unlock();
+            throw;
+        }
+        unlock();
+        return result;
+    }
+
+    // Bytes owned by the queue: the object itself and its segments
+    std::size_t footprint()
+    {
+        lock();
+        std::size_t segments = 0;
+        for (Segment* segment = m_head; segment; segment = segment->next)
+            segments++;
+        unlock();
+        return sizeof(*this) + segments * sizeof(Segment);
+    }
+
+    // Deletes the free segments cached by the calling thread
+    static void trimCache()
+    {
+        Cache& cache = threadCache();
+        for (Segment* segment : cache.segments)
+            delete segment;
+        cache.segments.clear();
+        cache.segments.shrink_to_fit();
+    }
+
+   private:
+    struct Segment
+    {
+        T* slot(uint32_t index)
+        {
+            return std::launder(reinterpret_cast<T*>(storage) + index);
+        }
+
+        Segment* next{nullptr};
+        uint32_t begin{0};
+        uint32_t end{0};
+        alignas(T) unsigned char storage[SEGMENT_CAPACITY * sizeof(T)];
+    };
+
+    struct Cache
+    {
+        ~Cache()
+        {
+            for (Segment* segment : segments)
+                delete segment;
+        }
+        std::vector<Segment*> segments;
+    };
+
+    static Cache& threadCache()
+    {
+        thread_local Cache cache;
+        return cache;
+    }
+
+    // A segment whose elements start (and end) at 'position'
+    static Segment* acquire(uint32_t position)
+    {
+        Cache&   cache = threadCache();
+        Segment* segment;
+        if (cache.segments.empty())
+        {
+            segment = new Segment;
+        }
+        else
+        {
+            segment = cache.segments.back();
+            cache.segments.pop_back();
+            segment->next = nullptr;
+        }
+        segment->begin = position;
+        segment->end   = position;
+        return segment;
+    }
+
+    static void release(Segment* segment)
+    {
+        Cache& cache = threadCache();
+        if (cache.segments.size() < CACHED_SEGMENTS)
+            cache.segments.push_back(segment);
+        else
+            delete segment;
+    }
+
+    // Futex-based mutex: 0 unlocked, 1 locked, 2 locked with (possibly) sleeping waiters
+    void lock()
+    {
+        uint32_t state = 0;
+        if (m_lock.compare_exchange_strong(state, 1, std::memory_order_acquire))
+            return;
+        if (state != 2)
+            state = m_lock.exchange(2, std::memory_order_acquire);
+        while (state != 0)
+        {
+            detail::futexWait(m_lock, 2);
+            state = m_lock.exchange(2, std::memory_order_acquire);
+        }
+    }
+
+    void unlock()
+    {
+        if (m_lock.exchange(0, std::memory_order_release) == 2)
+            detail::futexWake(m_lock, 1);
+    }
+
+    // Called with the lock held, releases it
+    void pushed()
+    {
+        m_count.fetch_add(1);
+        unlock();
+        if (m_waiters.load() > 0)
+            detail::futexWake(m_count, 1);
+    }
+
+    Segment*              m_head{nullptr};
+    Segment*              m_tail{nullptr};
+    std::atomic<uint32_t> m_count{0};
+    std::atomic<uint32_t> m_lock{0};
+    std::atomic<uint32_t> m_waiters{0};
+};
+
+#endif
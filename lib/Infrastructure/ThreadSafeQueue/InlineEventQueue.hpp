@@ -0,0 +1,104 @@
+#ifndef __INLINEEVENTQUEUE__
+#define __INLINEEVENTQUEUE__
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "IEvent/InlineEvent.hpp"
+
+/**
+ * Mailbox of InlineEvents: a ring buffer of envelopes, so that queuing an event copies it into a
+ * slot of a plain array instead of allocating a node. The array only grows (doubling) when full
+ */
+class InlineEventQueue
+{
+   public:
+    explicit InlineEventQueue(std::size_t capacity = 64) : m_slots(roundUp(capacity))
+    {
+    }
+
+    void put(InlineEvent event)
+    {
+        {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+            if (m_count == m_slots.size())
+                grow();
+            m_slots[(m_head + m_count) & (m_slots.size() - 1)] = std::move(event);
+            m_count++;
+            m_size.store(m_count, std::memory_order_relaxed);
+        }
+        m_cv.notify_one();
+    }
+
+    InlineEvent wait_and_pop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [&]() { return m_count != 0; });
+        return take();
+    }
+
+    // Empty InlineEvent on timeout
+    InlineEvent wait_and_pop_for(const std::chrono::milliseconds& timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_cv.wait_for(lock, timeout, [&]() { return m_count != 0; }))
+            return InlineEvent{};
+        return take();
+    }
+
+    bool empty()
+    {
+        return size() == 0;
+    }
+
+    // Read without taking the lock
+    std::size_t size()
+    {
+        return m_size.load(std::memory_order_relaxed);
+    }
+
+    std::size_t capacity()
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        return m_slots.size();
+    }
+
+   private:
+    static std::size_t roundUp(std::size_t capacity)
+    {
+        std::size_t result = 1;
+        while (result < capacity)
+            result <<= 1;
+        return result;
+    }
+
+    InlineEvent take()
+    {
+        InlineEvent event = std::move(m_slots[m_head]);
+        m_head            = (m_head + 1) & (m_slots.size() - 1);
+        m_count--;
+        m_size.store(m_count, std::memory_order_relaxed);
+        return event;
+    }
+
+    void grow()
+    {
+        std::vector<InlineEvent> slots(m_slots.size() * 2);
+        for (std::size_t i = 0; i < m_count; i++)
+            slots[i] = std::move(m_slots[(m_head + i) & (m_slots.size() - 1)]);
+        m_slots = std::move(slots);
+        m_head  = 0;
+    }
+
+    std::vector<InlineEvent> m_slots;
+    std::size_t              m_head{0};
+    std::size_t              m_count{0};
+    std::atomic<std::size_t> m_size{0};
+    std::condition_variable  m_cv;
+    std::mutex               m_mutex;
+};
+
+#endif
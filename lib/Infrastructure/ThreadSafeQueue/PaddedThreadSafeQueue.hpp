@@ -0,0 +1,152 @@
+#ifndef __PADDEDTHREADSAFEQUEUE_H_
+#define __PADDEDTHREADSAFEQUEUE_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "ThreadSafeQueue/CacheLine.hpp"
+#include "ThreadSafeQueue/ThreadSafeQueue.hpp"
+
+/**
+ * SimplestThreadSafeQueue with a cache-conscious layout, for queues many producers put() to.
+ * Fields are grouped by the threads writing them, one group per cache line:
+ *  - the mutex and what it protects, written by whichever thread holds the lock
+ *  - the size, written under the lock but read without it (e.g. by a load-balancing router), so
+ *    that polling it does not pull the line of the mutex away from the lock holder
+ *  - the condition variable, which producers notify after releasing the lock, and only when a
+ *    consumer is waiting
+ */
+template <typename T>
+class PaddedThreadSafeQueue : public IThreadSafeQueue<T>
+{
+   public:
+    PaddedThreadSafeQueue() = default;
+
+    PaddedThreadSafeQueue(const PaddedThreadSafeQueue&)            = delete;
+    PaddedThreadSafeQueue& operator=(const PaddedThreadSafeQueue&) = delete;
+
+    virtual void put(T element) override
+    {
+        bool waiting;
+        {
+            std::scoped_lock<std::mutex> lock(m_locked.mutex);
+            m_locked.queue.push_back(std::move(element));
+            m_published.size.store(m_locked.queue.size(), std::memory_order_relaxed);
+            waiting = m_locked.waiters > 0;
+        }
+        if (waiting)
+            m_wakeup.cv.notify_one();
+    }
+
+    virtual void put_prioritized(T element) override
+    {
+        bool waiting;
+        {
+            std::scoped_lock<std::mutex> lock(m_locked.mutex);
+            m_locked.queue.push_front(std::move(element));
+            m_published.size.store(m_locked.queue.size(), std::memory_order_relaxed);
+            waiting = m_locked.waiters > 0;
+        }
+        if (waiting)
+            m_wakeup.cv.notify_one();
+    }
+
+    virtual T wait_and_pop() override
+    {
+        std::unique_lock<std::mutex> lock(m_locked.mutex);
+        if (m_locked.queue.empty())
+        {
+            m_locked.waiters++;
+            m_wakeup.cv.wait(lock, [&]() { return !m_locked.queue.empty(); });
+            m_locked.waiters--;
+        }
+        return pop();
+    }
+
+    // Default-constructed T on timeout
+    virtual T wait_and_pop_for(const std::chrono::milliseconds& timeout) override
+    {
+        std::unique_lock<std::mutex> lock(m_locked.mutex);
+        if (m_locked.queue.empty())
+        {
+            m_locked.waiters++;
+            bool ready = m_wakeup.cv.wait_for(lock, timeout,
+                                              [&]() { return !m_locked.queue.empty(); });
+            m_locked.waiters--;
+            if (!ready)
+                return T{};
+        }
+        return pop();
+    }
+
+    virtual bool empty() override
+    {
+        std::scoped_lock<std::mutex> lock(m_locked.mutex);
+        return m_locked.queue.empty();
+    }
+
+    // Read without taking the lock
+    virtual std::size_t size() override
+    {
+        return m_published.size.load(std::memory_order_relaxed);
+    }
+
+    virtual void reset() override
+    {
+        std::scoped_lock<std::mutex> lock(m_locked.mutex);
+        m_locked.queue = std::deque<T>{};
+        m_published.size.store(0, std::memory_order_relaxed);
+    }
+
+    virtual void clear() override
+    {
+        std::scoped_lock<std::mutex> lock(m_locked.mutex);
+        m_locked.queue.clear();
+        m_published.size.store(0, std::memory_order_relaxed);
+    }
+
+    virtual std::vector<T> snapshot() override
+    {
+        std::scoped_lock<std::mutex> lock(m_locked.mutex);
+        return std::vector<T>(m_locked.queue.begin(), m_locked.queue.end());
+    }
+
+   private:
+    // Called with the lock held and the queue not empty
+    T pop()
+    {
+        T result = std::move(m_locked.queue.front());
+        m_locked.queue.pop_front();
+        m_published.size.store(m_locked.queue.size(), std::memory_order_relaxed);
+        return result;
+    }
+
+    struct alignas(CACHE_LINE) Locked
+    {
+        std::mutex    mutex;
+        std::deque<T> queue;
+        uint32_t      waiters{0};  // Consumers blocked on the condition variable
+    };
+    struct alignas(CACHE_LINE) Published
+    {
+        std::atomic<std::size_t> size{0};
+    };
+    struct alignas(CACHE_LINE) Wakeup
+    {
+        std::condition_variable cv;
+    };
+    static_assert(isolatedLayout<Locked> && isolatedLayout<Published> && isolatedLayout<Wakeup>);
+    static_assert(sizeof(Published) == CACHE_LINE && sizeof(Wakeup) == CACHE_LINE,
+                  "the size and the condition variable are meant to take one cache line each");
+
+    Locked    m_locked;
+    Published m_published;
+    Wakeup    m_wakeup;
+};
+
+#endif
@@ -0,0 +1,430 @@
+#ifndef __PERSENDERQUEUE_H_
+#define __PERSENDERQUEUE_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ThreadSafeQueue/CacheLine.hpp"
+#include "ThreadSafeQueue/SpscChannel.hpp"
+#include "ThreadSafeQueue/ThreadSafeQueue.hpp"
+
+/**
+ * IThreadSafeQueue keeping the order of the elements of each sender only, for an actor with many
+ * producers and no need for a total order between them. Every producer thread gets its own lane
+ * on its first put(), an unbounded single-producer single-consumer queue, so producers never
+ * contend with one another: a put() costs a store and a fence, plus a futex wake if the consumer
+ * sleeps. The consumer takes one element from each non-empty lane in turn.
+ * put_prioritized() elements go before any lane's, through a mutex, the last one put first as
+ * in SimplestThreadSafeQueue. The consumer-side calls (pops, empty(), clear(), reset(),
+ * snapshot()) serialize on a lock of their own, which producers never take. Each producer thread
+ * keeps a small map from the queues it put() to, to its lanes; when the thread exits its lanes
+ * are marked retired, and the consumer drops them once drained. Entries for destroyed queues are
+ * pruned from the map as new ones are added
+ */
+template <typename T>
+class PerSenderQueue : public IThreadSafeQueue<T>
+{
+   public:
+    // Elements per lane segment
+    static constexpr std::size_t SEGMENT_CAPACITY = 256;
+
+    PerSenderQueue() : m_id{s_last_id.fetch_add(1, std::memory_order_relaxed) + 1}
+    {
+    }
+
+    PerSenderQueue(const PerSenderQueue&)            = delete;
+    PerSenderQueue& operator=(const PerSenderQueue&) = delete;
+
+    virtual void put(T element) override
+    {
+        laneOfThisThread().push(std::move(element));
+        m_doorbell.ring();
+    }
+
+    virtual void put_prioritized(T element) override
+    {
+        {
+            std::scoped_lock<std::mutex> lock(m_priority_mutex);
+            m_priority.push_front(std::move(element));
+            m_priority_size.store(m_priority.size(), std::memory_order_relaxed);
+        }
+        m_doorbell.ring();
+    }
+
+    bool try_pop(T& element)
+    {
+        std::scoped_lock<std::mutex> lock(m_consumer_mutex);
+        return pop(element);
+    }
+
+    virtual T wait_and_pop() override
+    {
+        T element;
+        while (!try_pop(element))
+        {
+            uint32_t ticket = m_doorbell.prepare();
+            if (try_pop(element))
+            {
+                m_doorbell.cancel();
+                break;
+            }
+            m_doorbell.wait(ticket);
+        }
+        return element;
+    }
+
+    // Default-constructed T on timeout
+    virtual T wait_and_pop_for(const std::chrono::milliseconds& timeout) override
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        T    element;
+        while (!try_pop(element))
+        {
+            auto left = deadline - std::chrono::steady_clock::now();
+            if (left <= std::chrono::steady_clock::duration::zero())
+                return T{};
+            uint32_t ticket = m_doorbell.prepare();
+            if (try_pop(element))
+            {
+                m_doorbell.cancel();
+                break;
+            }
+            m_doorbell.wait(ticket,
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(left).count());
+        }
+        return element;
+    }
+
+    virtual bool empty() override
+    {
+        return size() == 0;
+    }
+
+    // Sum over the lanes, approximate while producers put()
+    virtual std::size_t size() override
+    {
+        std::scoped_lock<std::mutex> lock(m_consumer_mutex);
+        refreshLanes();
+        std::size_t result = m_priority_size.load(std::memory_order_relaxed);
+        for (Lane* lane : m_consumer_lanes)
+            result += lane->size();
+        return result;
+    }
+
+    virtual void reset() override
+    {
+        clear();
+    }
+
+    virtual void clear() override
+    {
+        std::scoped_lock<std::mutex> lock(m_consumer_mutex);
+        T                            element;
+        while (pop(element))
+        {
+        }
+    }
+
+    // Copy of the queued elements: the prioritized ones, then each lane's, front first
+    virtual std::vector<T> snapshot() override
+    {
+        std::scoped_lock<std::mutex> lock(m_consumer_mutex);
+        std::vector<T>               result;
+        {
+            std::scoped_lock<std::mutex> priority_lock(m_priority_mutex);
+            result.assign(m_priority.begin(), m_priority.end());
+        }
+        refreshLanes();
+        for (Lane* lane : m_consumer_lanes)
+            lane->copyTo(result);
+        return result;
+    }
+
+    // Producer threads that put() so far, but for the exited ones whose lane was drained
+    std::size_t senders()
+    {
+        std::scoped_lock<std::mutex> lock(m_lanes_mutex);
+        return m_lanes.size();
+    }
+
+   private:
+    struct Segment
+    {
+        std::array<T, SEGMENT_CAPACITY> slots;
+        std::atomic<Segment*>           next{nullptr};
+    };
+
+    // Unbounded SPSC queue of linked segments; the consumer hands a drained segment back
+    class Lane
+    {
+       public:
+        Lane() : m_tail{new Segment}, m_head{m_tail}
+        {
+        }
+        ~Lane()
+        {
+            for (Segment* segment = m_head; segment;)
+                delete std::exchange(segment, segment->next.load(std::memory_order_relaxed));
+            delete m_spare.load(std::memory_order_relaxed);
+        }
+
+        // Producer side
+        void push(T element)
+        {
+            if (m_tail_position == SEGMENT_CAPACITY)
+            {
+                Segment* segment = m_spare.exchange(nullptr, std::memory_order_acquire);
+                if (!segment)
+                    segment = new Segment;
+                segment->next.store(nullptr, std::memory_order_relaxed);
+                m_tail->next.store(segment, std::memory_order_relaxed);
+                m_tail          = segment;
+                m_tail_position = 0;
+            }
+            m_tail->slots[m_tail_position++] = std::move(element);
+            m_pushed.store(m_pushed.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        // Consumer side
+        bool pop(T& element)
+        {
+            if (m_popped == m_cached_pushed)
+            {
+                m_cached_pushed = m_pushed.load(std::memory_order_acquire);
+                if (m_popped == m_cached_pushed)
+                    return false;
+            }
+            if (m_head_position == SEGMENT_CAPACITY)
+            {
+                Segment* drained = m_head;
+                m_head           = m_head->next.load(std::memory_order_relaxed);
+                m_head_position  = 0;
+                delete m_spare.exchange(drained, std::memory_order_release);
+            }
+            element = std::move(m_head->slots[m_head_position++]);
+            m_popped++;
+            m_popped_published.store(m_popped, std::memory_order_relaxed);
+            return true;
+        }
+
+        std::size_t size() const
+        {
+            return m_pushed.load(std::memory_order_acquire)
+                   - m_popped_published.load(std::memory_order_relaxed);
+        }
+
+        // Producer side, once it put() its last element
+        void retire()
+        {
+            m_retired.store(true, std::memory_order_release);
+        }
+
+        // Once true, every element of the lane can be popped
+        bool retired() const
+        {
+            return m_retired.load(std::memory_order_acquire);
+        }
+
+        // Consumer side
+        void copyTo(std::vector<T>& elements)
+        {
+            uint64_t    pushed   = m_pushed.load(std::memory_order_acquire);
+            Segment*    segment  = m_head;
+            std::size_t position = m_head_position;
+            for (uint64_t i = m_popped; i < pushed; i++, position++)
+            {
+                if (position == SEGMENT_CAPACITY)
+                {
+                    segment  = segment->next.load(std::memory_order_relaxed);
+                    position = 0;
+                }
+                elements.push_back(segment->slots[position]);
+            }
+        }
+
+       private:
+        // Producer's cache line
+        alignas(CACHE_LINE) Segment* m_tail;
+        std::size_t           m_tail_position{0};
+        std::atomic<uint64_t> m_pushed{0};
+
+        // Consumer's cache line
+        alignas(CACHE_LINE) Segment* m_head;
+        std::size_t           m_head_position{0};
+        uint64_t              m_popped{0};
+        uint64_t              m_cached_pushed{0};
+        std::atomic<uint64_t> m_popped_published{0};
+
+        alignas(CACHE_LINE) std::atomic<Segment*> m_spare{nullptr};
+        std::atomic<bool> m_retired{false};
+    };
+
+    Lane& laneOfThisThread()
+    {
+        // Queues are told apart by id, so that a new queue at the address of a destroyed one
+        // does not get its lanes
+        if (t_last.id == m_id)
+            return *t_last.lane;
+        auto& lanes = t_lanes.lanes;
+        auto  it    = lanes.find(m_id);
+        if (it == lanes.end())
+        {
+            std::shared_ptr<Lane> lane(new Lane);
+            {
+                std::scoped_lock<std::mutex> lock(m_lanes_mutex);
+                m_lanes.push_back(lane);
+                m_lanes_version.fetch_add(1, std::memory_order_release);
+            }
+            t_lanes.prune();
+            it = lanes.emplace(m_id, ThreadLane{lane, lane.get()}).first;
+        }
+        t_last = {m_id, it->second.lane};
+        return *t_last.lane;
+    }
+
+    // Consumer side, with m_consumer_mutex held
+    void refreshLanes()
+    {
+        if (m_consumer_version == m_lanes_version.load(std::memory_order_acquire))
+            return;
+        std::scoped_lock<std::mutex> lock(m_lanes_mutex);
+        m_consumer_lanes.clear();
+        for (auto& lane : m_lanes)
+            m_consumer_lanes.push_back(lane.get());
+        m_consumer_version = m_lanes_version.load(std::memory_order_relaxed);
+    }
+
+    // Consumer side: the producer of lane 'i' exited and the lane is drained
+    void dropLane(std::size_t i)
+    {
+        Lane* lane = m_consumer_lanes[i];
+        m_consumer_lanes.erase(m_consumer_lanes.begin() + i);
+        std::scoped_lock<std::mutex> lock(m_lanes_mutex);
+        std::erase_if(m_lanes, [lane](const std::shared_ptr<Lane>& kept)
+                      { return kept.get() == lane; });
+    }
+
+    bool pop(T& element)
+    {
+        if (m_priority_size.load(std::memory_order_relaxed) > 0)
+        {
+            std::scoped_lock<std::mutex> lock(m_priority_mutex);
+            if (!m_priority.empty())
+            {
+                element = std::move(m_priority.front());
+                m_priority.pop_front();
+                m_priority_size.store(m_priority.size(), std::memory_order_relaxed);
+                return true;
+            }
+        }
+        refreshLanes();
+        for (std::size_t tried = 0; tried < m_consumer_lanes.size();)
+        {
+            if (m_next >= m_consumer_lanes.size())
+                m_next = 0;
+            Lane* lane    = m_consumer_lanes[m_next];
+            bool  retired = lane->retired();
+            if (lane->pop(element))
+            {
+                m_next++;
+                return true;
+            }
+            if (retired)
+            {
+                dropLane(m_next);  // m_next now names the lane after it
+                continue;
+            }
+            m_next++;
+            tried++;
+        }
+        return false;
+    }
+
+    struct ThreadLane
+    {
+        std::weak_ptr<Lane> owner;  // Expires with the queue
+        Lane*               lane;
+    };
+
+    // Lanes of one producer thread, retired when it exits
+    struct ThreadLanes
+    {
+        ~ThreadLanes()
+        {
+            for (auto& [id, entry] : lanes)
+            {
+                if (auto lane = entry.owner.lock())
+                    lane->retire();
+            }
+        }
+
+        // Forgets the destroyed queues, every time the map doubled
+        void prune()
+        {
+            if (lanes.size() < prune_at)
+                return;
+            std::erase_if(lanes, [](const auto& entry) { return entry.second.owner.expired(); });
+            prune_at = std::max<std::size_t>(2 * lanes.size(), 16);
+        }
+
+        std::unordered_map<uint64_t, ThreadLane> lanes;
+        std::size_t                              prune_at{16};
+    };
+
+    struct LastLane
+    {
+        uint64_t id{0};
+        Lane*    lane{nullptr};
+    };
+
+    static inline std::atomic<uint64_t>    s_last_id{0};
+    static inline thread_local ThreadLanes t_lanes;
+    static inline thread_local LastLane    t_last;
+
+    const uint64_t m_id;
+    Doorbell       m_doorbell;
+
+    std::mutex                         m_lanes_mutex;
+    std::vector<std::shared_ptr<Lane>> m_lanes;
+    std::atomic<uint64_t>              m_lanes_version{0};  // Bumped when a lane is added
+
+    std::mutex               m_priority_mutex;
+    std::deque<T>            m_priority;
+    std::atomic<std::size_t> m_priority_size{0};
+
+    // Consumer's own
+    std::mutex         m_consumer_mutex;
+    std::vector<Lane*> m_consumer_lanes;
+    uint64_t           m_consumer_version{0};
+    std::size_t        m_next{0};
+};
+
+/**
+ * Order in which an actor's mailbox delivers the events put() by different threads: Total keeps
+ * the order of the put()s across every sender, PerSender only each sender's own order, with no
+ * contention between senders
+ */
+enum class Ordering
+{
+    Total,
+    PerSender
+};
+
+template <typename T>
+std::shared_ptr<IThreadSafeQueue<T>> makeMailbox(Ordering ordering)
+{
+    if (ordering == Ordering::PerSender)
+        return std::make_shared<PerSenderQueue<T>>();
+    return std::make_shared<SimplestThreadSafeQueue<T>>();
+}
+
+#endif
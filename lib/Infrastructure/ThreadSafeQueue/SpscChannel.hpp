@@ -0,0 +1,256 @@
+#ifndef __SPSCCHANNEL_H_
+#define __SPSCCHANNEL_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ThreadSafeQueue/CacheLine.hpp"
+#include "ThreadSafeQueue/CompactThreadSafeQueue.hpp"
+
+/**
+ * Wakes a consumer sleeping on several sources at once. Producers only touch the futex word when
+ * the consumer announced it is going to sleep, so a busy consumer costs them a single load
+ */
+class Doorbell
+{
+   public:
+    // Producer side, once the element is published
+    void ring()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // Only the first producer to see the consumer asleep wakes it up
+        if (m_sleeping.load(std::memory_order_relaxed) && m_sleeping.exchange(0))
+        {
+            m_ticket.fetch_add(1);
+            detail::futexWake(m_ticket, 1);
+        }
+    }
+
+    // Consumer side: prepare(), check every source once more, then wait() or cancel()
+    uint32_t prepare()
+    {
+        uint32_t ticket = m_ticket.load();
+        m_sleeping.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return ticket;
+    }
+
+    void wait(uint32_t ticket, long timeout_ns = -1)
+    {
+        detail::futexWait(m_ticket, ticket, timeout_ns);
+        m_sleeping.store(0, std::memory_order_relaxed);
+    }
+
+    void cancel()
+    {
+        m_sleeping.store(0, std::memory_order_relaxed);
+    }
+
+   private:
+    std::atomic<uint32_t> m_ticket{0};
+    std::atomic<uint32_t> m_sleeping{0};
+};
+
+/**
+ * Bounded single-producer single-consumer ring for a fixed point-to-point link between two actors.
+ * Both sides are wait-free: each one keeps a cached copy of the other side's index and only reads
+ * the shared one when the cached copy says the ring is full (or empty). The producer may write()
+ * several elements and publish() them at once, paying for one release store and one doorbell
+ */
+template <typename T>
+class SpscChannel
+{
+   public:
+    explicit SpscChannel(std::size_t capacity = 1024, Doorbell* doorbell = nullptr)
+        : m_doorbell{doorbell}
+    {
+        std::size_t size = 2;
+        while (size < capacity)
+            size *= 2;
+        m_slots.resize(size);
+        m_mask = size - 1;
+    }
+
+    SpscChannel(const SpscChannel&)            = delete;
+    SpscChannel& operator=(const SpscChannel&) = delete;
+
+    /* Producer side */
+
+    // Stores 'element' without making it visible to the consumer. False if the ring is full
+    bool write(T& element)
+    {
+        if (m_write - m_cached_read == m_slots.size())
+        {
+            m_cached_read = m_read.load(std::memory_order_acquire);
+            if (m_write - m_cached_read == m_slots.size())
+                return false;
+        }
+        m_slots[m_write & m_mask] = std::move(element);
+        m_write++;
+        return true;
+    }
+
+    // Makes every written element visible to the consumer
+    void publish()
+    {
+        if (m_write == m_published)
+            return;
+        m_published = m_write;
+        m_tail.store(m_write, std::memory_order_release);
+        if (m_doorbell)
+            m_doorbell->ring();
+    }
+
+    bool try_push(T element)
+    {
+        if (!write(element))
+            return false;
+        publish();
+        return true;
+    }
+
+    // Yields while the ring is full
+    void push(T element)
+    {
+        while (!write(element))
+        {
+            publish();
+            std::this_thread::yield();
+        }
+        publish();
+    }
+
+    /* Consumer side */
+
+    bool try_pop(T& element)
+    {
+        if (m_consumed == m_cached_tail)
+        {
+            m_cached_tail = m_tail.load(std::memory_order_acquire);
+            if (m_consumed == m_cached_tail)
+                return false;
+        }
+        element = std::move(m_slots[m_consumed & m_mask]);
+        m_consumed++;
+        m_read.store(m_consumed, std::memory_order_release);
+        return true;
+    }
+
+    // Published elements not consumed yet (approximate when read by neither side)
+    std::size_t size() const
+    {
+        return m_tail.load(std::memory_order_acquire) - m_read.load(std::memory_order_acquire);
+    }
+
+    std::size_t capacity() const
+    {
+        return m_slots.size();
+    }
+
+   private:
+    std::vector<T> m_slots;
+    std::size_t    m_mask;
+    Doorbell*      m_doorbell;
+
+    // Producer's cache line
+    alignas(CACHE_LINE) std::size_t  m_write{0};
+    std::size_t              m_published{0};
+    std::size_t              m_cached_read{0};
+    std::atomic<std::size_t> m_tail{0};
+
+    // Consumer's cache line
+    alignas(CACHE_LINE) std::size_t  m_consumed{0};
+    std::size_t              m_cached_tail{0};
+    std::atomic<std::size_t> m_read{0};
+};
+
+/**
+ * An actor's inputs: a general mailbox any thread may put() to, plus SPSC channels declared with
+ * connect() for fixed point-to-point links. wait_and_pop() blocks until any of them has an
+ * element, taking them in turns so that no source starves the others
+ */
+template <typename T>
+class Inbox
+{
+   public:
+    // May be called from any thread
+    void put(T element)
+    {
+        m_mailbox.put(std::move(element));
+        m_doorbell.ring();
+    }
+
+    /**
+     * Declares a link from a single producer, which then push()es to the returned channel instead
+     * of put()ting to the inbox. Must be called before the consumer starts waiting
+     */
+    SpscChannel<T>& connect(std::size_t capacity = 1024)
+    {
+        m_channels.push_back(std::make_unique<SpscChannel<T>>(capacity, &m_doorbell));
+        return *m_channels.back();
+    }
+
+    bool try_pop(T& element)
+    {
+        const std::size_t sources = m_channels.size() + 1;
+        for (std::size_t i = 0; i < sources; i++)
+        {
+            std::size_t source = m_next;
+            m_next             = (m_next + 1 == sources) ? 0 : m_next + 1;
+            if (source == 0 ? m_mailbox.try_pop(element) : m_channels[source - 1]->try_pop(element))
+                return true;
+        }
+        return false;
+    }
+
+    T wait_and_pop()
+    {
+        T element;
+        while (!try_pop(element))
+        {
+            uint32_t ticket = m_doorbell.prepare();
+            if (try_pop(element))
+            {
+                m_doorbell.cancel();
+                break;
+            }
+            m_doorbell.wait(ticket);
+        }
+        return element;
+    }
+
+    // Default-constructed T on timeout
+    T wait_and_pop_for(const std::chrono::milliseconds& timeout)
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        T    element;
+        while (!try_pop(element))
+        {
+            auto left = deadline - std::chrono::steady_clock::now();
+            if (left <= std::chrono::steady_clock::duration::zero())
+                return T{};
+            uint32_t ticket = m_doorbell.prepare();
+            if (try_pop(element))
+            {
+                m_doorbell.cancel();
+                break;
+            }
+            m_doorbell.wait(ticket,
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(left).count());
+        }
+        return element;
+    }
+
+   private:
+    CompactThreadSafeQueue<T>                    m_mailbox;
+    Doorbell                                     m_doorbell;
+    std::vector<std::unique_ptr<SpscChannel<T>>> m_channels;
+    std::size_t                                  m_next{0};
+};
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef __THREADSAFEQUEUE__
 #define __THREADSAFEQUEUE__
 
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 #include <deque>
@@ -8,6 +9,7 @@
 #include <chrono>
 #include <memory>
 #include <thread>
+#include <vector>
 
 #include "Logger/Logger.hpp"
 
@@ -22,8 +24,10 @@ class IThreadSafeQueue
     virtual T    wait_and_pop()                                             = 0;
     virtual T    wait_and_pop_for(const std::chrono::milliseconds &timeout) = 0;
     virtual bool empty()                                                    = 0;
+    virtual std::size_t size()                                              = 0;
     virtual void reset()                                                    = 0;
     virtual void clear()                                                    = 0;
+    virtual std::vector<T> snapshot()                                       = 0;
 
    private:
 };
@@ -43,6 +47,7 @@ class SimplestThreadSafeQueue : public IThreadSafeQueue<T>
             std::scoped_lock<std::mutex> lock(m_mutex);
             LOG_TSQ(LEVEL_DEBUG) << __PRETTY_FUNCTION__ << std::endl;
             m_queue.push_back(element);
+            m_size.store(m_queue.size(), std::memory_order_relaxed);
         }
         m_cv.notify_all();
     }
@@ -52,6 +57,7 @@ class SimplestThreadSafeQueue : public IThreadSafeQueue<T>
             std::scoped_lock<std::mutex> lock(m_mutex);
             LOG_TSQ(LEVEL_DEBUG) << __PRETTY_FUNCTION__ << std::endl;
             m_queue.push_front(element);
+            m_size.store(m_queue.size(), std::memory_order_relaxed);
         }
         m_cv.notify_all();
     }
@@ -69,6 +75,7 @@ class SimplestThreadSafeQueue : public IThreadSafeQueue<T>
         LOG_TSQ(LEVEL_DEBUG) << __PRETTY_FUNCTION__ << " - Finished waiting" << std::endl;
         T result = m_queue.front();
         m_queue.pop_front();
+        m_size.store(m_queue.size(), std::memory_order_relaxed);
         lock.unlock();
         return result;
     }
@@ -91,6 +98,7 @@ class SimplestThreadSafeQueue : public IThreadSafeQueue<T>
             LOG_TSQ(LEVEL_DEBUG) << __PRETTY_FUNCTION__ << " - Finished waiting" << std::endl;
             result = m_queue.front();
             m_queue.pop_front();
+            m_size.store(m_queue.size(), std::memory_order_relaxed);
             lock.unlock();
         }
         return result;
@@ -105,21 +113,35 @@ class SimplestThreadSafeQueue : public IThreadSafeQueue<T>
         }
         return result;
     }
+    // Number of queued elements, read without taking the lock (e.g. by a load-balancing router)
+    virtual std::size_t size() override
+    {
+        return m_size.load(std::memory_order_relaxed);
+    }
     virtual void reset() override
     {
         LOG_TSQ(LEVEL_DEBUG) << __PRETTY_FUNCTION__ << std::endl;
         m_queue = std::deque<T>{};
+        m_size.store(0, std::memory_order_relaxed);
     }
     virtual void clear() override
     {
         LOG_TSQ(LEVEL_DEBUG) << __PRETTY_FUNCTION__ << std::endl;
         m_queue.clear();
+        m_size.store(0, std::memory_order_relaxed);
+    }
+    // Copy of the queued elements, front first, e.g. to checkpoint an actor's pending events
+    virtual std::vector<T> snapshot() override
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        return std::vector<T>(m_queue.begin(), m_queue.end());
     }
 
    private:
-    std::deque<T>           m_queue{};
-    std::condition_variable m_cv;
-    std::mutex              m_mutex;
+    std::deque<T>            m_queue{};
+    std::atomic<std::size_t> m_size{0};
+    std::condition_variable  m_cv;
+    std::mutex               m_mutex;
 };
 
 #endif
\ No newline at end of file
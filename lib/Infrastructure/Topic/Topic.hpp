@@ -0,0 +1,150 @@
+#ifndef __TOPIC_H_
+#define __TOPIC_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "IEvent/EventFilter.hpp"
+#include "IEvent/IEvent.hpp"
+
+/**
+ * Publisher whose subscriptions carry the set of event types they want. Unlike a SignalIEvent,
+ * which hands every event to every slot and lets the actor discard what it does not handle,
+ * publish() tests each subscription's EventFilter first, so an unwanted event is never enqueued,
+ * never wakes the actor up and never bubbles up its state tree. Only events with a dense id (see
+ * Event<E>) can be filtered out; the others reach every subscriber
+ */
+class Topic
+{
+   public:
+    class Subscription
+    {
+       public:
+        Subscription(SignatureIEvent mailbox, const EventFilter& filter)
+            : m_mailbox{std::move(mailbox)}, m_filter{filter}
+        {
+        }
+
+        // May be changed at any time, e.g. from the subscriber's own thread
+        EventFilter& filter()
+        {
+            return m_filter;
+        }
+
+        // Events published while subscribed that the filter kept out of the mailbox
+        uint64_t filtered() const
+        {
+            return m_filtered.load(std::memory_order_relaxed);
+        }
+
+       private:
+        friend class Topic;
+
+        SignatureIEvent       m_mailbox;
+        EventFilter           m_filter;
+        std::atomic<uint64_t> m_filtered{0};
+    };
+    using t_subscription = std::shared_ptr<Subscription>;
+
+    Topic() : m_subscriptions{std::make_shared<const t_list>()}
+    {
+    }
+
+    Topic(const Topic&)            = delete;
+    Topic& operator=(const Topic&) = delete;
+
+    /**
+     * Delivers the published events accepted by 'filter' to 'mailbox' (typically the put() of the
+     * subscriber's queue), until unsubscribe()d
+     */
+    t_subscription subscribe(SignatureIEvent    mailbox,
+                             const EventFilter& filter = EventFilter::all())
+    {
+        auto subscription = std::make_shared<Subscription>(std::move(mailbox), filter);
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        auto list = std::make_shared<t_list>(*m_subscriptions);
+        list->push_back(subscription);
+        m_subscriptions = std::move(list);
+        return subscription;
+    }
+
+    void unsubscribe(const t_subscription& subscription)
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        auto list = std::make_shared<t_list>(*m_subscriptions);
+        list->erase(std::remove(list->begin(), list->end(), subscription), list->end());
+        m_subscriptions = std::move(list);
+    }
+
+    /**
+     * Keeps the filter of 'subscription' equal to the event types the active states of 'manager'
+     * may handle (StateManager::handledEvents()), updated on every change of configuration.
+     * Other configuration listeners of 'manager', including other follow()ing subscriptions, are
+     * kept. Returns the listener id, to stop following with
+     * manager.removeConfigurationListener().
+     * Events are filtered against the configuration active when they are published, not when
+     * they are processed: an event published while an earlier one that will cause a transition
+     * is still queued in the mailbox is dropped if the current states do not handle it, even if
+     * the states entered by that transition would. So this only suits events that are
+     * meaningless to states not handling them at the time they are published
+     */
+    template <class Manager>
+    static auto follow(const t_subscription& subscription, Manager& manager)
+    {
+        subscription->filter() = manager.handledEvents();
+        return manager.onConfigurationChange(
+            [subscription, &manager] { subscription->filter() = manager.handledEvents(); });
+    }
+
+    // May be called from any thread. Returns the number of subscriptions the event was given to
+    std::size_t publish(const IEvent_ptr& event)
+    {
+        std::shared_ptr<const t_list> subscriptions;
+        {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+            subscriptions = m_subscriptions;
+        }
+        const uint32_t id        = event->getEventId();
+        std::size_t    delivered = 0;
+        for (auto& subscription : *subscriptions)
+        {
+            if (subscription->m_filter.accepts(id))
+            {
+                subscription->m_mailbox(event);
+                delivered++;
+            }
+            else
+            {
+                subscription->m_filtered.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        m_filtered.fetch_add(subscriptions->size() - delivered, std::memory_order_relaxed);
+        return delivered;
+    }
+
+    // Deliveries saved by the filters since the topic was created, over every subscription
+    uint64_t filtered() const
+    {
+        return m_filtered.load(std::memory_order_relaxed);
+    }
+
+    std::size_t size() const
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        return m_subscriptions->size();
+    }
+
+   private:
+    using t_list = std::vector<t_subscription>;
+
+    mutable std::mutex            m_mutex;
+    std::shared_ptr<const t_list> m_subscriptions;  // Copied on change, publish() takes a snapshot
+    std::atomic<uint64_t>         m_filtered{0};
+};
+
+#endif
@@ -0,0 +1,274 @@
+#ifndef __WATCHDOG_H_
+#define __WATCHDOG_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+#include <boost/core/demangle.hpp>
+
+#include "Logger/Logger.hpp"
+
+#define LOG_WDG(lvl) (LOG("Watchdog.hpp", lvl))
+
+/**
+ * Flags run-to-completion steps that exceed a time budget, e.g. a handler blocking its actor.
+ * Each actor's run loop marks the start and end of every step on its Probe with relaxed atomic
+ * stores; a monitor thread polls the probes and reports each step still running after the
+ * budget once, with the actor, the state and the event type. Probes also keep a histogram of
+ * step durations
+ */
+class Watchdog
+{
+   public:
+    using t_clock = std::chrono::steady_clock;
+
+    // Histogram bucket 0 counts steps under 1us, bucket i steps of [2^(i-1), 2^i) us
+    static constexpr std::size_t BUCKETS = 32;
+    using t_histogram                    = std::array<uint64_t, BUCKETS>;
+
+    struct Stall
+    {
+        std::string              actor;
+        std::string              state;
+        std::string              event;
+        std::chrono::nanoseconds elapsed;
+    };
+    using t_report = std::function<void(const Stall&)>;
+
+    class Probe
+    {
+       public:
+        explicit Probe(std::string name) : m_name{std::move(name)}
+        {
+        }
+
+        void begin(const std::type_info& state, const std::type_info& event)
+        {
+            m_state.store(&state, std::memory_order_relaxed);
+            m_event.store(&event, std::memory_order_relaxed);
+            m_step.store(m_step.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            m_start.store(now(), std::memory_order_release);
+        }
+
+        void end()
+        {
+            int64_t elapsed = now() - m_start.load(std::memory_order_relaxed);
+            m_start.store(0, std::memory_order_relaxed);
+            m_histogram[bucket(elapsed)].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        const std::string& name() const
+        {
+            return m_name;
+        }
+
+        t_histogram histogram() const
+        {
+            t_histogram result;
+            for (std::size_t i = 0; i < BUCKETS; i++)
+                result[i] = m_histogram[i].load(std::memory_order_relaxed);
+            return result;
+        }
+
+       private:
+        friend class Watchdog;
+
+        static std::size_t bucket(int64_t elapsed_ns)
+        {
+            uint64_t us = uint64_t(elapsed_ns > 0 ? elapsed_ns : 0) / 1000;
+            return std::min<std::size_t>(std::bit_width(us), BUCKETS - 1);
+        }
+
+        std::string                                m_name;
+        std::atomic<int64_t>                       m_start{0};  // 0 while idle
+        std::atomic<uint64_t>                      m_step{0};
+        std::atomic<const std::type_info*>         m_state{nullptr};
+        std::atomic<const std::type_info*>         m_event{nullptr};
+        std::array<std::atomic<uint64_t>, BUCKETS> m_histogram{};
+        uint64_t                                   m_flagged_step{0};  // Monitor thread only
+    };
+
+    /**
+     * Marks one step on 'probe' (nothing if nullptr) for its lifetime:
+     *   Watchdog::Step step(m_probe, *m_state_manager->currentState().node->data, *event);
+     *   m_state_manager->processEvent(event);
+     */
+    class Step
+    {
+       public:
+        template <class State, class Event>
+        Step(Probe* probe, const State& state, const Event& event) : m_probe{probe}
+        {
+            if (m_probe)
+                m_probe->begin(typeid(state), typeid(event));
+        }
+        ~Step()
+        {
+            if (m_probe)
+                m_probe->end();
+        }
+        Step(const Step&)            = delete;
+        Step& operator=(const Step&) = delete;
+
+       private:
+        Probe* m_probe;
+    };
+
+    // Shortest polling period, so that a tiny budget does not make the monitor thread spin
+    static constexpr std::chrono::nanoseconds MIN_PERIOD = std::chrono::microseconds{100};
+
+    /**
+     * Starts the monitor thread, polling every 'period' (a quarter of the budget by default, no
+     * less than MIN_PERIOD). Stalls are logged as warnings unless a 'report' callback is given,
+     * which is then called from the monitor thread. Throws std::invalid_argument if 'budget' is
+     * not positive
+     */
+    explicit Watchdog(std::chrono::nanoseconds budget, t_report report = nullptr,
+                      std::chrono::nanoseconds period = std::chrono::nanoseconds{0})
+        : m_budget{budget.count()},
+          m_report{report ? std::move(report) : logStall},
+          m_period{std::max(period.count() > 0 ? period : budget / 4, MIN_PERIOD)}
+    {
+        if (budget.count() <= 0)
+            throw std::invalid_argument("Watchdog budget must be positive");
+        m_thread = std::thread(&Watchdog::monitor, this);
+    }
+
+    ~Watchdog()
+    {
+        {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+            m_running = false;
+        }
+        m_cv.notify_all();
+        m_thread.join();
+    }
+
+    Watchdog(const Watchdog&)            = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+    // Probe for the run loop of the actor 'name', valid as long as the Watchdog
+    Probe* watch(std::string name)
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        m_probes.push_back(std::make_unique<Probe>(std::move(name)));
+        return m_probes.back().get();
+    }
+
+    /**
+     * One pass over every probe, as done periodically by the monitor thread. The stalls are
+     * reported once the lock is released, so the report may call watch() or histogram()
+     */
+    void check()
+    {
+        struct Stalled
+        {
+            const std::string*    name;
+            const std::type_info* state;
+            const std::type_info* event;
+            int64_t               duration;
+        };
+        std::vector<Stalled> stalled;
+        {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+            int64_t                      current = now();
+            for (auto& probe : m_probes)
+            {
+                int64_t start = probe->m_start.load(std::memory_order_acquire);
+                if (start == 0 || current - start <= m_budget)
+                    continue;
+                uint64_t step  = probe->m_step.load(std::memory_order_relaxed);
+                auto*    state = probe->m_state.load(std::memory_order_relaxed);
+                auto*    event = probe->m_event.load(std::memory_order_relaxed);
+                // Skip if the step ended (or another one began) meanwhile, or was already reported
+                if (probe->m_start.load(std::memory_order_acquire) != start
+                    || step == probe->m_flagged_step)
+                    continue;
+                probe->m_flagged_step = step;
+                m_stalls++;
+                // Probes are never destroyed before the Watchdog, nor their names changed
+                stalled.push_back({&probe->m_name, state, event, current - start});
+            }
+        }
+        for (auto& stall : stalled)
+        {
+            m_report(Stall{*stall.name, boost::core::demangle(stall.state->name()),
+                           boost::core::demangle(stall.event->name()),
+                           std::chrono::nanoseconds{stall.duration}});
+        }
+    }
+
+    // Number of stalled steps reported so far
+    uint64_t stalls() const
+    {
+        return m_stalls.load();
+    }
+
+    // Step durations of every watched actor
+    t_histogram histogram()
+    {
+        t_histogram                  result{};
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        for (auto& probe : m_probes)
+        {
+            t_histogram histogram = probe->histogram();
+            for (std::size_t i = 0; i < BUCKETS; i++)
+                result[i] += histogram[i];
+        }
+        return result;
+    }
+
+   private:
+    static int64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   t_clock::now().time_since_epoch())
+            .count();
+    }
+
+    static void logStall(const Stall& stall)
+    {
+        LOG_WDG(LEVEL_WARNING) << stall.actor << ": step still running after "
+                               << stall.elapsed.count() / 1000000 << " ms, in state "
+                               << stall.state << " on " << stall.event << std::endl;
+    }
+
+    void monitor()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (m_running)
+        {
+            m_cv.wait_for(lock, m_period);
+            if (!m_running)
+                break;
+            lock.unlock();
+            check();
+            lock.lock();
+        }
+    }
+
+    const int64_t                       m_budget;
+    t_report                            m_report;
+    std::chrono::nanoseconds            m_period;
+    std::mutex                          m_mutex;
+    std::condition_variable             m_cv;
+    bool                                m_running{true};
+    std::vector<std::unique_ptr<Probe>> m_probes;
+    std::atomic<uint64_t>               m_stalls{0};
+    std::thread                         m_thread;
+};
+
+#endif
@@ -11,9 +11,13 @@
 #include <boost/bind/bind.hpp>
 
 #include "Logger/Logger.hpp"
+#include "ThreadSafeQueue/CacheLine.hpp"
+#include "ThreadSafeQueue/PerSenderQueue.hpp"
 #include "ThreadSafeQueue/ThreadSafeQueue.hpp"
 #include "IState/IState.hpp"
 #include "StateManager/StateManager.hpp"
+#include "Supervisor/Supervisor.hpp"
+#include "Watchdog/Watchdog.hpp"
 
 #define LOG_MAIN (LOG("main.cpp", LEVEL_INFO))
 #define DELAY 200
@@ -161,7 +165,9 @@ class ActorFoo
 {
    public:
     using ActorFooSuperState_ptr = std::shared_ptr<ActorFooSuperState>;
-    ActorFoo() : m_queue{std::make_shared<SimplestThreadSafeQueue<IEvent_ptr>>()}
+    // Total keeps the order of the events across senders, PerSender only each sender's own
+    explicit ActorFoo(Ordering ordering = Ordering::Total)
+        : m_queue{makeMailbox<IEvent_ptr>(ordering)}
     {
         /* clang-format off */
         tree<ActorFooSuperState_ptr> tree;
@@ -174,12 +180,10 @@ class ActorFoo
         m_states[StateValue::STATE_G] = tree.append_child(m_states[StateValue::STATE_F], std::make_shared<StateG>(this));
         m_states[StateValue::STATE_B] = tree.append_child(m_states[StateValue::ROOT], std::make_shared<StateB>(this));
         m_states[StateValue::STATE_E] = tree.append_child(m_states[StateValue::STATE_B], std::make_shared<StateE>(this));
-        m_states[StateValue::UNKNOWN] = tree.end();
-
-        m_next_state = m_states[StateValue::UNKNOWN];
-
         m_state_manager = std::make_shared<StateManager<ActorFooSuperState_ptr>>(std::move(tree), m_states[StateValue::STATE_A]);
         /* clang-format on */
+        // Continuations spawned by the states are resumed through the actor's own queue
+        m_state_manager->setMailbox([this](IEvent_ptr event) { m_queue->put(event); });
     }
     ~ActorFoo()
     {
@@ -188,22 +192,35 @@ class ActorFoo
     void start()
     {
         m_state_manager->init();
-        m_running = true;
-        m_thread  = std::thread(&ActorFoo::run, this);
+        *m_running = true;
+        m_thread   = std::thread(&ActorFoo::run, this);
     }
 
     void stop()
     {
-        if (!m_running)
+        if (!*m_running)
             return;
 
-        m_running = false;
+        *m_running = false;
         m_queue->clear();
 
         if (m_thread.joinable())
             m_thread.join();
     };
 
+    // Steps of the run loop are timed on 'probe'
+    void watch(Watchdog::Probe* probe)
+    {
+        m_probe = probe;
+    }
+
+    // A step that throws restarts the actor from STATE_A, on its thread and with its queue kept
+    void superviseBy(Supervisor& supervisor)
+    {
+        m_child = supervisor.supervise("ActorFoo", [this]()
+                                       { m_state_manager->restart(m_states[StateValue::STATE_A]); });
+    }
+
     void callback_IEvent(IEvent_ptr event)
     {
         m_queue->put(event);
@@ -219,28 +236,30 @@ class ActorFoo
 
     std::shared_ptr<StateManager<ActorFooSuperState_ptr>>        m_state_manager;
     std::map<StateValue, tree<ActorFooSuperState_ptr>::iterator> m_states;
-    tree<ActorFooSuperState_ptr>::iterator                       m_next_state;
 
    private:
     void run()
     {
         do
         {
-            IEvent_ptr current_event = m_queue->wait_and_pop();
-            m_state_manager->processEvent(current_event);
-
-            if (m_next_state != m_states[StateValue::UNKNOWN])
-            {
-                m_state_manager->transitionTo(m_next_state);
-                m_next_state = m_states[StateValue::UNKNOWN];
-            }
-        } while (m_running);
+            IEvent_ptr     current_event = m_queue->wait_and_pop();
+            Watchdog::Step step(m_probe, *m_state_manager->currentState().node->data,
+                                *current_event);
+            // Unsupervised, an exception escapes the run loop
+            if (m_child)
+                m_child->step(*current_event,
+                              [&]() { m_state_manager->processEvent(current_event); });
+            else
+                m_state_manager->processEvent(current_event);
+        } while (*m_running);
     };
 
-    std::atomic_bool m_running{false};
-    std::thread      m_thread;
+    CachePadded<std::atomic_bool> m_running{false};
+    std::thread                   m_thread;
 
-    std::shared_ptr<SimplestThreadSafeQueue<IEvent_ptr>> m_queue;
+    std::shared_ptr<IThreadSafeQueue<IEvent_ptr>> m_queue;
+    Watchdog::Probe*                              m_probe{nullptr};
+    Supervisor::Child*                            m_child{nullptr};
 };
 
 /* clang-format off */
@@ -282,8 +301,7 @@ int StateA::process_event(IEvent_ptr event)
                 logStream << k << " ";
             }
             LOG_MAIN << logStream.str() << std::endl;
-            m_actor->m_next_state = m_actor->m_states[StateValue::STATE_G];
-            return 0;
+            return m_actor->m_state_manager->requestTransition(m_actor->m_states[StateValue::STATE_G]);
         }
         else
         {
@@ -353,8 +371,7 @@ int StateG::process_event(IEvent_ptr event)
                 logStream << k << " ";
             }
             LOG_MAIN << logStream.str() << std::endl;
-            m_actor->m_next_state = m_actor->m_states[StateValue::STATE_E];
-            return 0;
+            return m_actor->m_state_manager->requestTransition(m_actor->m_states[StateValue::STATE_E]);
         }
         else
         {
@@ -402,8 +419,7 @@ int StateE::process_event(IEvent_ptr event)
                 logStream << k << " ";
             }
             LOG_MAIN << logStream.str() << std::endl;
-            m_actor->m_next_state = m_actor->m_states[StateValue::STATE_A];
-            return 0;
+            return m_actor->m_state_manager->requestTransition(m_actor->m_states[StateValue::STATE_A]);
         }
         else
         {
@@ -487,7 +503,9 @@ class ActorBar
 {
    public:
     using ActorBarSuperState_ptr = std::shared_ptr<ActorBarSuperState>;
-    ActorBar() : m_queue{std::make_shared<SimplestThreadSafeQueue<IEvent_ptr>>()}
+    // Total keeps the order of the events across senders, PerSender only each sender's own
+    explicit ActorBar(Ordering ordering = Ordering::Total)
+        : m_queue{makeMailbox<IEvent_ptr>(ordering)}
     {
         /* clang-format off */
         tree<ActorBarSuperState_ptr> tree;
@@ -496,12 +514,10 @@ class ActorBar
         m_states[StateValue::STATE_1] = tree.append_child(m_states[StateValue::ROOT], std::make_shared<State1>(this));
         m_states[StateValue::STATE_2] = tree.append_child(m_states[StateValue::ROOT], std::make_shared<State2>(this));
         m_states[StateValue::STATE_3] = tree.append_child(m_states[StateValue::STATE_1], std::make_shared<State3>(this));
-        m_states[StateValue::UNKNOWN] = tree.end();
-
-        m_next_state = m_states[StateValue::UNKNOWN];
-
         m_state_manager = std::make_shared<StateManager<ActorBarSuperState_ptr>>(std::move(tree), m_states[StateValue::STATE_1]);
         /* clang-format on */
+        // Continuations spawned by the states are resumed through the actor's own queue
+        m_state_manager->setMailbox([this](IEvent_ptr event) { m_queue->put(event); });
     }
     ~ActorBar()
     {
@@ -510,22 +526,35 @@ class ActorBar
     void start()
     {
         m_state_manager->init();
-        m_running = true;
-        m_thread  = std::thread(&ActorBar::run, this);
+        *m_running = true;
+        m_thread   = std::thread(&ActorBar::run, this);
     }
 
     void stop()
     {
-        if (!m_running)
+        if (!*m_running)
             return;
 
-        m_running = false;
+        *m_running = false;
         m_queue->clear();
 
         if (m_thread.joinable())
             m_thread.join();
     };
 
+    // Steps of the run loop are timed on 'probe'
+    void watch(Watchdog::Probe* probe)
+    {
+        m_probe = probe;
+    }
+
+    // A step that throws restarts the actor from STATE_1, on its thread and with its queue kept
+    void superviseBy(Supervisor& supervisor)
+    {
+        m_child = supervisor.supervise("ActorBar", [this]()
+                                       { m_state_manager->restart(m_states[StateValue::STATE_1]); });
+    }
+
     void callback_IEvent(IEvent_ptr event)
     {
         m_queue->put(event);
@@ -541,29 +570,30 @@ class ActorBar
 
     std::shared_ptr<StateManager<ActorBarSuperState_ptr>>        m_state_manager;
     std::map<StateValue, tree<ActorBarSuperState_ptr>::iterator> m_states;
-    tree<ActorBarSuperState_ptr>::iterator                       m_next_state;
 
    private:
     void run()
     {
         do
         {
-            IEvent_ptr current_event = m_queue->wait_and_pop();
-            m_state_manager->processEvent(current_event);
-
-            if (m_next_state != m_states[StateValue::UNKNOWN])
-            {
-                m_state_manager->transitionTo(m_next_state);
-                m_next_state = m_states[StateValue::UNKNOWN];
-            }
-
-        } while (m_running);
+            IEvent_ptr     current_event = m_queue->wait_and_pop();
+            Watchdog::Step step(m_probe, *m_state_manager->currentState().node->data,
+                                *current_event);
+            // Unsupervised, an exception escapes the run loop
+            if (m_child)
+                m_child->step(*current_event,
+                              [&]() { m_state_manager->processEvent(current_event); });
+            else
+                m_state_manager->processEvent(current_event);
+        } while (*m_running);
     };
 
-    std::atomic_bool m_running{false};
-    std::thread      m_thread;
+    CachePadded<std::atomic_bool> m_running{false};
+    std::thread                   m_thread;
 
-    std::shared_ptr<SimplestThreadSafeQueue<IEvent_ptr>> m_queue;
+    std::shared_ptr<IThreadSafeQueue<IEvent_ptr>> m_queue;
+    Watchdog::Probe*                              m_probe{nullptr};
+    Supervisor::Child*                            m_child{nullptr};
 };
 
 /* clang-format off */
@@ -591,8 +621,7 @@ int State1::process_event(IEvent_ptr event)
         if (event_blue)
         {
             LOG_MAIN << "This is the event data: " << event_blue->timeout << std::endl;
-            m_actor->m_next_state = m_actor->m_states[StateValue::STATE_2];
-            return 0;
+            return m_actor->m_state_manager->requestTransition(m_actor->m_states[StateValue::STATE_2]);
         }
         else
         {
@@ -628,8 +657,7 @@ int State2::process_event(IEvent_ptr event)
         if (event_blue)
         {
             LOG_MAIN << "This is the event data: " << event_blue->timeout << std::endl;
-            m_actor->m_next_state = m_actor->m_states[StateValue::STATE_3];
-            return 0;
+            return m_actor->m_state_manager->requestTransition(m_actor->m_states[StateValue::STATE_3]);
         }
         else
         {
@@ -676,8 +704,7 @@ int State3::process_event(IEvent_ptr event)
         if (event_blue)
         {
             LOG_MAIN << "This is the event data: " << event_blue->timeout << std::endl;
-            m_actor->m_next_state = m_actor->m_states[StateValue::STATE_1];
-            return 0;
+            return m_actor->m_state_manager->requestTransition(m_actor->m_states[StateValue::STATE_1]);
         }
         else
         {
@@ -696,13 +723,21 @@ namespace Demo
 class App
 {
    public:
-    App() : m_foo{std::make_shared<Foo::ActorFoo>()}, m_bar{std::make_shared<Bar::ActorBar>()}
+    // Each actor only relies on the order of the events of each of its senders
+    App()
+        : m_foo{std::make_shared<Foo::ActorFoo>(Ordering::PerSender)},
+          m_bar{std::make_shared<Bar::ActorBar>(Ordering::PerSender)}
     {
         LOG_MAIN << __PRETTY_FUNCTION__ << std::endl;
         m_foo->connect_callbacks(
             boost::bind(&Bar::ActorBar::callback_IEvent, m_bar.get(), boost::placeholders::_1));
         m_bar->connect_callbacks(
             boost::bind(&Foo::ActorFoo::callback_IEvent, m_foo.get(), boost::placeholders::_1));
+        // The handlers sleep for DELAY ms to make the demo readable, so each of them is flagged
+        m_foo->watch(m_watchdog.watch("ActorFoo"));
+        m_bar->watch(m_watchdog.watch("ActorBar"));
+        m_foo->superviseBy(m_supervisor);
+        m_bar->superviseBy(m_supervisor);
     }
     ~App()
     {
@@ -725,6 +760,8 @@ class App
     }
 
    private:
+    Watchdog                       m_watchdog{std::chrono::milliseconds(DELAY / 2)};
+    Supervisor                     m_supervisor{Supervisor::Strategy::OneForOne};
     std::shared_ptr<Foo::ActorFoo> m_foo;
     std::shared_ptr<Bar::ActorBar> m_bar;
 };
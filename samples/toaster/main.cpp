@@ -7,6 +7,7 @@
 #include <boost/bind/bind.hpp>
 
 #include "Logger/Logger.hpp"
+#include "ThreadSafeQueue/CacheLine.hpp"
 #include "ThreadSafeQueue/ThreadSafeQueue.hpp"
 #include "IState/IState.hpp"
 #include "StateManager/StateManager.hpp"
@@ -140,12 +141,20 @@ class Toaster
             tree.append_child(m_states[StateValue::HEATING], std::make_shared<Toasting>(this));
         m_states[StateValue::BAKING] =
             tree.append_child(m_states[StateValue::HEATING], std::make_shared<Baking>(this));
-        m_states[StateValue::UNKNOWN] = tree.end();
-
-        m_next_state = m_states[StateValue::UNKNOWN];
 
         m_state_manager = std::make_shared<StateManager<ToasterSuperState_ptr>>(
             std::move(tree), m_states[StateValue::HEATING]);
+
+        // Matched before the states' own handlers
+        m_state_manager->addTransition<Evts::DoorOpen>(m_states[StateValue::HEATING],
+                                                       m_states[StateValue::DOOR_OPEN]);
+        m_state_manager->addTransition<Evts::DoToasting>(m_states[StateValue::HEATING],
+                                                         m_states[StateValue::TOASTING]);
+        m_state_manager->addTransition<Evts::DoBaking>(m_states[StateValue::HEATING],
+                                                       m_states[StateValue::BAKING]);
+        m_state_manager->addTransition<Evts::Timeout>(m_states[StateValue::TOASTING],
+                                                      m_states[StateValue::HEATING],
+                                                      [this](const IEvent_ptr&) { pop_up(); });
     }
     ~Toaster()
     {
@@ -154,16 +163,16 @@ class Toaster
     void start()
     {
         m_state_manager->init();
-        m_running = true;
-        m_thread  = std::thread(&Toaster::run, this);
+        *m_running = true;
+        m_thread   = std::thread(&Toaster::run, this);
     }
 
     void stop()
     {
-        if (!m_running)
+        if (!*m_running)
             return;
 
-        m_running = false;
+        *m_running = false;
         m_queue->clear();
 
         if (m_thread.joinable())
@@ -220,16 +229,20 @@ class Toaster
     {
         LOG_MAIN << __PRETTY_FUNCTION__ << std::endl;
     }
+
+    void pop_up()
+    {
+        LOG_MAIN << __PRETTY_FUNCTION__ << std::endl;
+    }
     void run_once()
     {
-        m_running = false;
+        *m_running = false;
         run();
     }
 
     SignalIEvent                                                m_signal;
     std::shared_ptr<StateManager<ToasterSuperState_ptr>>        m_state_manager;
     std::map<StateValue, tree<ToasterSuperState_ptr>::iterator> m_states;
-    tree<ToasterSuperState_ptr>::iterator                       m_next_state;
 
    private:
     void run()
@@ -238,17 +251,10 @@ class Toaster
         {
             IEvent_ptr current_event = m_queue->wait_and_pop();
             m_state_manager->processEvent(current_event);
-
-            if (m_next_state != m_states[StateValue::UNKNOWN])
-            {
-                m_state_manager->transitionTo(m_next_state);
-                m_next_state = m_states[StateValue::UNKNOWN];
-            }
-
-        } while (m_running);
+        } while (*m_running);
     };
 
-    std::atomic_bool                                     m_running{false};
+    CachePadded<std::atomic_bool>                        m_running{false};
     std::thread                                          m_thread;
     std::shared_ptr<SimplestThreadSafeQueue<IEvent_ptr>> m_queue;
 };
@@ -283,25 +289,9 @@ int Heating::on_exit()
 }
 int Heating::process_event(IEvent_ptr event)
 {
+    (void) event;
     LOG_MAIN << __PRETTY_FUNCTION__ << std::endl;
-
-    std::size_t event_type = event->getTypeHash();
-    if (event_type == typeid(Evts::DoorOpen).hash_code())
-    {
-        m_actor->m_next_state = m_actor->m_states[StateValue::DOOR_OPEN];
-        return 0;
-    }
-    else if (event_type == typeid(Evts::DoToasting).hash_code())
-    {
-        m_actor->m_next_state = m_actor->m_states[StateValue::TOASTING];
-        return 0;
-    }
-    else if (event_type == typeid(Evts::DoBaking).hash_code())
-    {
-        m_actor->m_next_state = m_actor->m_states[StateValue::BAKING];
-        return 0;
-    }
-    return -1;  // unhandled event
+    return -1;  // unhandled event, transitions are in the StateManager's table
 }
 int DoorOpen::on_entry()
 {
@@ -322,8 +312,9 @@ int DoorOpen::process_event(IEvent_ptr event)
     std::size_t event_type = event->getTypeHash();
     if (event_type == typeid(Evts::DoorClose).hash_code())
     {
-        m_actor->m_next_state = m_actor->m_states[StateValue::HEATING];
-        return 0;
+        // Resume toasting or baking, whichever was interrupted by opening the door
+        return m_actor->m_state_manager->requestTransitionToHistory(
+            m_actor->m_states[StateValue::HEATING]);
     }
     return -1;  // unhandled event
 }
@@ -341,15 +332,9 @@ int Toasting::on_exit()
 }
 int Toasting::process_event(IEvent_ptr event)
 {
+    (void) event;
     LOG_MAIN << __PRETTY_FUNCTION__ << std::endl;
-
-    std::size_t event_type = event->getTypeHash();
-    if (event_type == typeid(Evts::Timeout).hash_code())
-    {
-        m_actor->m_next_state = m_actor->m_states[StateValue::HEATING];
-        return 0;
-    }
-    return -1;  // unhandled event
+    return -1;  // unhandled event, transitions are in the StateManager's table
 }
 int Baking::on_entry()
 {
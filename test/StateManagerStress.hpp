@@ -0,0 +1,201 @@
+#ifndef __STATEMANAGERSTRESS_H_
+#define __STATEMANAGERSTRESS_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "StateManager/StateManager.hpp"
+
+/**
+ * Random state trees and transitions checked against a reference model of the exit/entry
+ * sequence, shared by the unit tests (testStateManagerStress.cpp) and the multithreaded soak test
+ * (stressStateManager.cpp)
+ */
+namespace Stress
+{
+// Trace entries: +(id + 1) on entry, -(id + 1) on exit, ACTION for the transition action
+using Trace                = std::vector<int>;
+constexpr int      ACTION  = 0;
+constexpr uint32_t NO_NODE = 0xFFFFFFFF;
+
+class Goto : public Event<Goto>
+{
+   public:
+    explicit Goto(uint32_t target) : target{target}
+    {
+    }
+    uint32_t target;
+};
+
+/* Breadth-first numbered tree: node 0 is the root, parent[i] < i */
+inline std::vector<uint32_t> randomTree(std::mt19937& rng, int max_depth, int max_width)
+{
+    std::vector<uint32_t> parent{NO_NODE};
+    std::vector<int>      depth{0};
+    for (uint32_t node = 0; node < parent.size(); node++)
+    {
+        if (depth[node] == max_depth)
+            continue;
+        int children = std::uniform_int_distribution<int>(node == 0 ? 1 : 0, max_width)(rng);
+        for (int i = 0; i < children; i++)
+        {
+            parent.push_back(node);
+            depth.push_back(depth[node] + 1);
+        }
+    }
+    return parent;
+}
+
+/**
+ * Reference model of StateManager::transitionTo() for a single region: every state from the
+ * current one up to (excluding) the least common ancestor with the target is exited, innermost
+ * first, then the action runs and the states down to the target are entered. A self-transition
+ * exits and re-enters the state. The root is never exited nor entered
+ */
+inline Trace expectedTrace(const std::vector<uint32_t>& parent, uint32_t current, uint32_t target)
+{
+    if (current == target)
+        return {-int(current + 1), ACTION, int(current + 1)};
+
+    auto path = [&](uint32_t node)
+    {
+        std::vector<uint32_t> result;  // node first, root excluded
+        for (; node != 0; node = parent[node])
+            result.push_back(node);
+        return result;
+    };
+    std::vector<uint32_t> exits   = path(current);
+    std::vector<uint32_t> entries = path(target);
+
+    // Drop the common ancestors (the common suffix of both paths)
+    while (!exits.empty() && !entries.empty() && exits.back() == entries.back())
+    {
+        exits.pop_back();
+        entries.pop_back();
+    }
+    // A target above the current state is not re-entered, a current state above the target is not
+    // exited: its common ancestor with the other one is itself
+    Trace trace;
+    for (uint32_t node : exits)
+        trace.push_back(-int(node + 1));
+    trace.push_back(ACTION);
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it)
+        trace.push_back(int(*it + 1));
+    return trace;
+}
+
+class TracedState
+{
+   public:
+    TracedState(uint32_t id, Trace& trace) : m_id{id}, m_trace{trace}
+    {
+    }
+    int on_entry()
+    {
+        m_trace.push_back(int(m_id + 1));
+        return 0;
+    }
+    int on_exit()
+    {
+        m_trace.push_back(-int(m_id + 1));
+        return 0;
+    }
+    int process_event(IEvent_ptr event)
+    {
+        return m_handler ? m_handler(event) : -1;
+    }
+
+    std::function<int(const IEvent_ptr&)> m_handler;
+
+   private:
+    uint32_t m_id;
+    Trace&   m_trace;
+};
+
+using TracedState_ptr = std::shared_ptr<TracedState>;
+
+/**
+ * A StateManager over a random tree, and its model. The root handles Goto events by requesting a
+ * transition, and a random subset of the other states declares it handles nothing, so that
+ * events are routed past them
+ */
+class Machine
+{
+   public:
+    using t_manager = StateManager<TracedState_ptr>;
+
+    Machine(std::mt19937& rng, int max_depth, int max_width)
+        : m_parent{randomTree(rng, max_depth, max_width)}
+    {
+        tree<TracedState_ptr> states;
+        for (uint32_t node = 0; node < m_parent.size(); node++)
+        {
+            auto state = std::make_shared<TracedState>(node, m_trace);
+            m_nodes.push_back((node == 0) ? states.set_head(state)
+                                          : states.append_child(m_nodes[m_parent[node]], state));
+        }
+        m_current = randomNode(rng);
+        m_manager = std::make_unique<t_manager>(std::move(states), m_nodes[m_current]);
+
+        m_nodes[0].node->data->m_handler = [this](const IEvent_ptr& event)
+        {
+            auto target = static_cast<const Goto&>(*event).target;
+            return m_manager->requestTransition(m_nodes[target], [this](const IEvent_ptr&)
+                                                { m_trace.push_back(ACTION); });
+        };
+        for (uint32_t node = 1; node < m_parent.size(); node++)
+        {
+            if (rng() % 2)
+                m_manager->declareHandled<>(m_nodes[node]);
+        }
+        m_manager->init();
+        m_trace.clear();
+    }
+
+    uint32_t randomNode(std::mt19937& rng) const
+    {
+        return std::uniform_int_distribution<uint32_t>(0, uint32_t(m_parent.size() - 1))(rng);
+    }
+
+    std::size_t size() const
+    {
+        return m_parent.size();
+    }
+
+    /**
+     * Transition to 'target', through processEvent() if 'by_event' or transitionTo() otherwise.
+     * Returns false if the exit/entry sequence or the resulting state differ from the model
+     */
+    bool step(uint32_t target, bool by_event)
+    {
+        m_trace.clear();
+        if (by_event)
+            m_manager->processEvent(std::make_shared<Goto>(target));
+        else
+            m_manager->transitionTo(m_nodes[target], [this](const IEvent_ptr&)
+                                    { m_trace.push_back(ACTION); });
+
+        bool ok   = (m_trace == expectedTrace(m_parent, m_current, target))
+                    && m_manager->currentState() == m_nodes[target];
+        m_current = target;
+        return ok;
+    }
+
+    uint32_t current() const
+    {
+        return m_current;
+    }
+
+   private:
+    std::vector<uint32_t>                        m_parent;
+    std::vector<tree<TracedState_ptr>::iterator> m_nodes;
+    Trace                                        m_trace;
+    uint32_t                                     m_current;
+    std::unique_ptr<t_manager>                   m_manager;
+};
+}  // namespace Stress
+
+#endif
@@ -0,0 +1,116 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "StateManagerStress.hpp"
+#include "ThreadSafeQueue/ThreadSafeQueue.hpp"
+
+/**
+ * Soak test of StateManager transitions, doubling as a scaling benchmark:
+ *   stressStateManager [depth] [width] [transitions] [actors] [producers] [seed]
+ * Each actor owns a random state tree and a thread; producer threads post Goto events with random
+ * targets to random actors, and every actor checks each resulting exit/entry sequence against the
+ * reference model. Exits with a non-zero status on the first mismatch
+ */
+
+class Actor
+{
+   public:
+    Actor(unsigned seed, int depth, int width) : m_rng{seed}, m_machine{m_rng, depth, width}
+    {
+    }
+
+    void start()
+    {
+        m_thread = std::thread(&Actor::run, this);
+    }
+
+    void join()
+    {
+        m_queue.put(nullptr);
+        m_thread.join();
+    }
+
+    void post(uint32_t target)
+    {
+        m_queue.put(std::make_shared<Stress::Goto>(target));
+    }
+
+    std::size_t size() const
+    {
+        return m_machine.size();
+    }
+
+    long m_transitions{0};
+    long m_failures{0};
+
+   private:
+    void run()
+    {
+        while (auto event = m_queue.wait_and_pop())
+        {
+            uint32_t target = static_cast<Stress::Goto&>(*event).target;
+            if (!m_machine.step(target, true))
+                m_failures++;
+            m_transitions++;
+        }
+    }
+
+    std::mt19937                        m_rng;
+    Stress::Machine                     m_machine;
+    SimplestThreadSafeQueue<IEvent_ptr> m_queue;
+    std::thread                         m_thread;
+};
+
+int main(int argc, char** argv)
+{
+    int      depth       = (argc > 1) ? std::atoi(argv[1]) : 6;
+    int      width       = (argc > 2) ? std::atoi(argv[2]) : 3;
+    long     transitions = (argc > 3) ? std::atol(argv[3]) : 1000000;
+    int      actors      = (argc > 4) ? std::atoi(argv[4]) : 16;
+    int      producers   = (argc > 5) ? std::atoi(argv[5]) : 4;
+    unsigned seed        = (argc > 6) ? unsigned(std::atoi(argv[6])) : 1;
+
+    std::vector<std::unique_ptr<Actor>> pool;
+    for (int i = 0; i < actors; i++)
+    {
+        pool.emplace_back(std::make_unique<Actor>(seed + i, depth, width));
+        pool.back()->start();
+    }
+
+    auto                     begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++)
+    {
+        threads.emplace_back(
+            [&, p]()
+            {
+                std::mt19937 rng(seed * 7919 + p);
+                for (long i = p; i < transitions; i += producers)
+                {
+                    Actor& actor = *pool[rng() % pool.size()];
+                    actor.post(uint32_t(rng() % actor.size()));
+                }
+            });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    long done = 0, failures = 0;
+    for (auto& actor : pool)
+    {
+        actor->join();
+        done += actor->m_transitions;
+        failures += actor->m_failures;
+    }
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::printf("%ld transitions, %d actors, %d producers: %.0f transitions/s, %ld mismatches\n",
+                done, actors, producers, done / seconds, failures);
+    return (failures == 0 && done == transitions) ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "ActorRegistry/ActorRegistry.hpp"
+
+namespace
+{
+class Ping : public IEvent
+{
+};
+}  // namespace
+
+TEST(ActorRegistryTest, TestPostReachesActor)
+{
+    ActorRegistry           registry;
+    std::vector<IEvent_ptr> received;
+    ActorId id = registry.add([&](IEvent_ptr event) { received.push_back(event); });
+
+    auto event = std::make_shared<Ping>();
+    ASSERT_TRUE(id.valid());
+    ASSERT_TRUE(registry.alive(id));
+    ASSERT_TRUE(registry.post(id, event));
+    ASSERT_EQ(1u, received.size());
+    ASSERT_EQ(event, received[0]);
+}
+
+TEST(ActorRegistryTest, TestEventsToRemovedActorAreDropped)
+{
+    ActorRegistry registry;
+    int           old_count = 0, new_count = 0;
+    ActorId       old_id = registry.add([&](IEvent_ptr) { old_count++; });
+    ASSERT_TRUE(registry.remove(old_id));
+    ASSERT_FALSE(registry.remove(old_id));
+
+    // The slot is reused, but the stale id still does not resolve
+    ActorId new_id = registry.add([&](IEvent_ptr) { new_count++; });
+    ASSERT_EQ(old_id.index(), new_id.index());
+    ASSERT_NE(old_id, new_id);
+
+    ASSERT_FALSE(registry.post(old_id, std::make_shared<Ping>()));
+    ASSERT_TRUE(registry.post(new_id, std::make_shared<Ping>()));
+    ASSERT_EQ(0, old_count);
+    ASSERT_EQ(1, new_count);
+    ASSERT_EQ(1u, registry.dropped());
+    ASSERT_FALSE(registry.post(ActorId{}, std::make_shared<Ping>()));
+}
+
+TEST(ActorRegistryTest, TestActorsOfOneThreadAreContiguous)
+{
+    ActorRegistry registry;
+    ActorId       first = registry.add([](IEvent_ptr) {});
+    ASSERT_EQ(0u, first.index() % ActorRegistry::PAGE_SIZE);
+    for (uint32_t i = 1; i < ActorRegistry::PAGE_SIZE; i++)
+        ASSERT_EQ(first.index() + i, registry.add([](IEvent_ptr) {}).index());
+    // Then a whole new page
+    ASSERT_EQ(0u, registry.add([](IEvent_ptr) {}).index() % ActorRegistry::PAGE_SIZE);
+
+    // A slot removed by another thread is reused by the thread owning its page
+    std::thread([&]() { registry.remove(first); }).join();
+    ASSERT_EQ(first.index(), registry.add([](IEvent_ptr) {}).index());
+}
+
+TEST(ActorRegistryTest, TestConcurrentAddPostRemove)
+{
+    ActorRegistry         registry;
+    std::atomic<long>     delivered{0};
+    std::vector<ActorId>  stable;
+    for (int i = 0; i < 64; i++)
+        stable.push_back(registry.add([&](IEvent_ptr) { delivered++; }));
+
+    // Churn: actors added and removed while others post to both stable and churning ids
+    std::vector<std::thread> threads;
+    std::atomic<uint64_t>    churning{0};
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back(
+            [&]()
+            {
+                for (int i = 0; i < 2000; i++)
+                {
+                    ActorId id = registry.add([](IEvent_ptr) {});
+                    churning   = id.value();
+                    ASSERT_TRUE(registry.remove(id));
+                }
+            });
+    }
+    long posted = 0;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back(
+            [&, t]()
+            {
+                auto event = std::make_shared<Ping>();
+                for (int i = 0; i < 20000; i++)
+                {
+                    registry.post(stable[(i + t) % stable.size()], event);
+                    uint64_t value = churning;
+                    registry.post(ActorId{uint32_t(value), uint32_t(value >> 32)}, event);
+                }
+            });
+        posted += 20000;
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    ASSERT_EQ(posted, delivered);
+    ASSERT_EQ(stable.size(), registry.size());
+}
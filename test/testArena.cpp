@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Arena/ActorArena.hpp"
+#include "Arena/CountGlobalAllocations.hpp"
+#include "StateManager/StateManager.hpp"
+
+namespace
+{
+class Small : public IEvent
+{
+   public:
+    explicit Small(int value) : value{value}
+    {
+    }
+    int value;
+};
+class Large : public IEvent
+{
+   public:
+    char payload[1024];
+};
+
+class CountingState
+{
+   public:
+    int on_entry()
+    {
+        m_entries++;
+        return 0;
+    }
+    int on_exit()
+    {
+        m_exits++;
+        return 0;
+    }
+    int process_event(IEvent_ptr)
+    {
+        return -1;
+    }
+
+    int m_entries{0};
+    int m_exits{0};
+};
+using CountingState_ptr = std::shared_ptr<CountingState>;
+}  // namespace
+
+TEST(ActorArena, TestFreedBlocksAreReused)
+{
+    ActorArena arena;
+    void*      first = arena.allocate(24);
+    ActorArena::deallocate(first);
+    ASSERT_EQ(first, arena.allocate(20));  // Same size class
+
+    void* large = arena.allocate(4096);
+    ActorArena::deallocate(large);
+    ASSERT_EQ(3u, arena.stats().allocations);
+    ASSERT_EQ(2u, arena.stats().heap);  // One chunk and the large block
+}
+
+TEST(ActorArena, TestEventsFreedByAnotherThreadReturnToTheOwner)
+{
+    ActorArena                           arena;
+    std::vector<std::shared_ptr<IEvent>> sent;
+    for (int i = 0; i < 100; i++)
+        sent.push_back(arena.make<Small>(i));
+    auto heap = arena.stats().heap;
+
+    // The receiving actor drops the last references
+    std::thread receiver([&]() { sent.clear(); });
+    receiver.join();
+    ASSERT_EQ(0u, arena.stats().remote_frees);
+
+    for (int i = 0; i < 100; i++)
+        sent.push_back(arena.make<Small>(i));
+    ASSERT_EQ(100u, arena.stats().remote_frees);
+    ASSERT_EQ(heap, arena.stats().heap);
+    ASSERT_EQ(99, std::static_pointer_cast<Small>(sent.back())->value);
+}
+
+TEST(ActorArena, TestSteadyStateMakesNoHeapAllocation)
+{
+    ActorArena arena;
+    arena.make<Small>(0);  // Carves the first chunk
+
+    Allocation::Span arena_span;
+    for (int i = 0; i < 1000; i++)
+        arena.make<Small>(i);
+    ASSERT_EQ(0u, arena_span.elapsed().allocations);
+
+    Allocation::Span heap_span;
+    for (int i = 0; i < 1000; i++)
+        std::make_shared<Small>(i);
+    ASSERT_EQ(1000u, heap_span.elapsed().allocations);
+}
+
+TEST(AllocationProfile, TestAlignedAndNothrowAllocationsAreCounted)
+{
+    struct alignas(128) Aligned
+    {
+        char byte;
+    };
+    Allocation::Span     span;
+    auto                 aligned = std::make_unique<Aligned>();
+    auto                 array   = std::make_unique<Aligned[]>(3);
+    std::unique_ptr<int> nothrow(new (std::nothrow) int(1));
+    ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(aligned.get()) % 128);
+    ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(array.get()) % 128);
+    ASSERT_NE(nullptr, nothrow);
+    ASSERT_EQ(3u, span.elapsed().allocations);
+    ASSERT_GE(span.elapsed().bytes, 4 * sizeof(Aligned) + sizeof(int));
+}
+
+TEST(AllocationProfile, TestCountsPerEventType)
+{
+    AllocationProfile profile;
+    {
+        AllocationProfile::Step step(&profile, Small(0));
+        std::string             allocating(100, 'x');
+    }
+    {
+        AllocationProfile::Step step(&profile, Large());
+    }
+    {
+        AllocationProfile::Step step(nullptr, Small(0));  // Not profiled
+        std::string             allocating(100, 'x');
+    }
+
+    ASSERT_EQ(1u, profile.of<Small>().allocations);
+    ASSERT_EQ(0u, profile.of<Large>().allocations);
+    ASSERT_EQ(1u, profile.total().allocations);
+    auto entries = profile.byEventType();
+    ASSERT_EQ(2u, entries.size());
+    ASSERT_NE(std::string::npos, entries[0].event.find("Small"));
+    ASSERT_EQ(1u, entries[0].steps);
+}
+
+// root -> a -> a1 -> a11, root -> b -> b1
+TEST(AllocationProfile, TestTransitionMakesNoHeapAllocation)
+{
+    tree<CountingState_ptr> states;
+    auto root = states.set_head(std::make_shared<CountingState>());
+    auto a    = states.append_child(root, std::make_shared<CountingState>());
+    auto a1   = states.append_child(a, std::make_shared<CountingState>());
+    auto a11  = states.append_child(a1, std::make_shared<CountingState>());
+    auto b    = states.append_child(root, std::make_shared<CountingState>());
+    auto b1   = states.append_child(b, std::make_shared<CountingState>());
+    StateManager<CountingState_ptr> sm(std::move(states), a11);
+    sm.init();
+
+    Allocation::Span span;
+    for (int i = 0; i < 100; i++)
+    {
+        sm.transitionTo(b1);
+        sm.transitionTo(a11);
+    }
+    sm.transitionTo(a);  // To an ancestor: only a1 and a11 are exited
+    ASSERT_EQ(0u, span.elapsed().allocations);
+
+    ASSERT_EQ(0, root.node->data->m_exits);
+    ASSERT_EQ(100, a.node->data->m_entries);
+    ASSERT_EQ(100, a.node->data->m_exits);
+    ASSERT_EQ(101, a11.node->data->m_exits);
+    ASSERT_EQ(100, b1.node->data->m_entries);
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <set>
+#include <thread>
+
+#include "Ask/Ask.hpp"
+#include "ThreadSafeQueue/ThreadSafeQueue.hpp"
+
+namespace
+{
+class GetSquare : public Request<int>
+{
+   public:
+    GetSquare(int v) : value{v}
+    {
+    }
+    int value;
+};
+
+class Ignored : public Request<int>
+{
+};
+}  // namespace
+
+// Fixture definition
+class AskFixture : public ::testing::Test
+{
+   protected:
+    AskFixture()
+    {
+        m_thread = std::thread(&AskFixture::run, this);
+    }
+
+    ~AskFixture()
+    {
+        m_running = false;
+        m_queue.put(nullptr);
+        m_thread.join();
+    }
+
+    // Plays the role of the target actor's run loop
+    void run()
+    {
+        while (m_running)
+        {
+            IEvent_ptr event = m_queue.wait_and_pop();
+            if (auto request = std::dynamic_pointer_cast<GetSquare>(event))
+            {
+                request->reply(request->value * request->value);
+            }
+        }
+    }
+
+    void post(IEvent_ptr event)
+    {
+        m_queue.put(event);
+    }
+
+    SimplestThreadSafeQueue<IEvent_ptr> m_queue;
+    std::atomic_bool                    m_running{true};
+    std::thread                         m_thread;
+};
+
+TEST_F(AskFixture, TestGet)
+{
+    auto future = ask([this](IEvent_ptr e) { post(e); }, std::make_shared<GetSquare>(7));
+    ASSERT_EQ(49, future.get().value());
+    ASSERT_EQ(AskStatus::ready, future.status());
+}
+
+TEST_F(AskFixture, TestCorrelationIdsAreUnique)
+{
+    std::set<uint64_t> ids;
+    for (int i = 0; i < 100; i++)
+    {
+        auto future = ask([this](IEvent_ptr e) { post(e); }, std::make_shared<GetSquare>(i));
+        ids.insert(future.correlationId());
+        ASSERT_EQ(i * i, future.get().value());
+    }
+    ASSERT_EQ(100u, ids.size());
+}
+
+TEST_F(AskFixture, TestThen)
+{
+    std::atomic_int result{0};
+    auto future = ask([this](IEvent_ptr e) { post(e); }, std::make_shared<GetSquare>(3));
+    future.then([&](Future<int> f) { result = f.get().value(); });
+
+    future.get();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_EQ(9, result);
+}
+
+TEST_F(AskFixture, TestThenPostDeliversTheRequestBack)
+{
+    SimplestThreadSafeQueue<IEvent_ptr> asker_queue;
+
+    auto request = std::make_shared<GetSquare>(5);
+    auto future  = ask([this](IEvent_ptr e) { post(e); }, request);
+    future.then_post([&](IEvent_ptr e) { asker_queue.put(e); });
+
+    IEvent_ptr reply = asker_queue.wait_and_pop_for(std::chrono::milliseconds(500));
+    ASSERT_EQ(request, reply);
+    auto answered = std::dynamic_pointer_cast<GetSquare>(reply);
+    ASSERT_EQ(future.correlationId(), answered->correlationId());
+    ASSERT_EQ(25, future.get().value());
+}
+
+TEST_F(AskFixture, TestTimeout)
+{
+    auto future = ask([this](IEvent_ptr e) { post(e); }, std::make_shared<Ignored>(),
+                      std::chrono::milliseconds(50));
+    ASSERT_FALSE(future.get().has_value());
+    ASSERT_EQ(AskStatus::timeout, future.status());
+
+    // A late reply is discarded
+    ASSERT_FALSE(future.request()->reply(1));
+}
+
+TEST_F(AskFixture, TestReplyBeforeTimeout)
+{
+    auto future = ask([this](IEvent_ptr e) { post(e); }, std::make_shared<GetSquare>(4),
+                      std::chrono::milliseconds(500));
+    ASSERT_EQ(16, future.get().value());
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_EQ(AskStatus::ready, future.status());
+}
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Broadcast/Broadcast.hpp"
+#include "CoroutineExecutor/CoroutineExecutor.hpp"
+
+namespace
+{
+class Numbered : public IEvent
+{
+   public:
+    Numbered(int number) : number{number}
+    {
+    }
+    int number;
+};
+
+int numberOf(const IEvent_ptr& event)
+{
+    return std::static_pointer_cast<Numbered>(event)->number;
+}
+}  // namespace
+
+TEST(BroadcastTest, TestMailboxIsFifo)
+{
+    LockFreeMailbox mailbox;
+    ASSERT_EQ(nullptr, mailbox.try_pop());
+    for (int i = 0; i < 5; i++)
+        mailbox.put(std::make_shared<Numbered>(i));
+    ASSERT_EQ(5u, mailbox.size());
+    for (int i = 0; i < 5; i++)
+        ASSERT_EQ(i, numberOf(mailbox.wait_and_pop()));
+    ASSERT_TRUE(mailbox.empty());
+}
+
+TEST(BroadcastTest, TestBroadcastSharesOneEvent)
+{
+    std::vector<LockFreeMailbox>  mailboxes(8);
+    std::vector<LockFreeMailbox*> recipients;
+    for (auto& mailbox : mailboxes)
+        recipients.push_back(&mailbox);
+
+    std::weak_ptr<IEvent> watch;
+    {
+        auto event = std::make_shared<Numbered>(42);
+        watch      = event;
+        broadcast(event, recipients);
+    }
+    for (auto& mailbox : mailboxes)
+    {
+        ASSERT_FALSE(watch.expired());
+        ASSERT_EQ(watch.lock(), mailbox.wait_and_pop());
+    }
+    // Released by the last recipient
+    ASSERT_TRUE(watch.expired());
+}
+
+TEST(BroadcastTest, TestUnpoppedEventsReleasedWithMailbox)
+{
+    std::weak_ptr<IEvent> watch;
+    LockFreeMailbox       survivor;
+    {
+        LockFreeMailbox dropped;
+        auto            event = std::make_shared<Numbered>(1);
+        watch                 = event;
+        LockFreeMailbox* recipients[] = {&survivor, &dropped};
+        broadcast(event, recipients, 2);
+    }
+    ASSERT_FALSE(watch.expired());
+    survivor.wait_and_pop();
+    ASSERT_TRUE(watch.expired());
+}
+
+TEST(BroadcastTest, TestBroadcastWakesEachWorkerOnce)
+{
+    MailboxWorker                                 workers[2];
+    std::vector<std::unique_ptr<LockFreeMailbox>> mailboxes;
+    std::vector<LockFreeMailbox*>                 recipients;
+    for (int i = 0; i < 6; i++)
+    {
+        mailboxes.push_back(std::make_unique<LockFreeMailbox>(&workers[i % 2]));
+        recipients.push_back(mailboxes.back().get());
+    }
+
+    broadcast(std::make_shared<Numbered>(1), recipients);
+    for (auto& worker : workers)
+        ASSERT_EQ(1u, worker.ticket());
+
+    // Already non-empty: no wakeup at all
+    broadcast(std::make_shared<Numbered>(2), recipients);
+    for (auto& worker : workers)
+        ASSERT_EQ(1u, worker.ticket());
+    for (auto& mailbox : mailboxes)
+    {
+        ASSERT_EQ(1, numberOf(mailbox->wait_and_pop()));
+        ASSERT_EQ(2, numberOf(mailbox->wait_and_pop()));
+    }
+}
+
+TEST(BroadcastTest, TestWorkerServesSeveralMailboxes)
+{
+    MailboxWorker   worker;
+    LockFreeMailbox first(&worker), second(&worker);
+
+    std::thread producer(
+        [&]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            second.put(std::make_shared<Numbered>(3));
+        });
+
+    IEvent_ptr event;
+    while (!event)
+    {
+        uint32_t seen = worker.ticket();
+        if (!(event = first.try_pop()) && !(event = second.try_pop()))
+            worker.wait(seen);
+    }
+    producer.join();
+    ASSERT_EQ(3, numberOf(event));
+}
+
+TEST(BroadcastTest, TestConcurrentProducers)
+{
+    constexpr int PRODUCERS = 4, EVENTS = 10000;
+    LockFreeMailbox          mailbox;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; p++)
+    {
+        producers.emplace_back(
+            [&, p]()
+            {
+                for (int i = 0; i < EVENTS; i++)
+                    mailbox.put(std::make_shared<Numbered>(p * EVENTS + i));
+            });
+    }
+
+    // Per-producer order is preserved
+    std::vector<int> last(PRODUCERS, -1);
+    for (int i = 0; i < PRODUCERS * EVENTS; i++)
+    {
+        int number   = numberOf(mailbox.wait_and_pop());
+        int producer = number / EVENTS;
+        ASSERT_GT(number % EVENTS, last[producer]);
+        last[producer] = number % EVENTS;
+    }
+    for (auto& producer : producers)
+        producer.join();
+    ASSERT_TRUE(mailbox.empty());
+}
+
+TEST(BroadcastTest, TestBroadcastToLoopMailboxes)
+{
+    EventLoop                             loops[2];
+    std::vector<std::unique_ptr<Mailbox>> mailboxes;
+    std::vector<Mailbox*>                 recipients;
+    for (int i = 0; i < 6; i++)
+    {
+        mailboxes.push_back(std::make_unique<Mailbox>(loops[i % 2]));
+        recipients.push_back(mailboxes.back().get());
+    }
+
+    auto event = std::make_shared<Numbered>(7);
+    broadcast(event, recipients);
+
+    // Not running: the events wait in the loops' remote inboxes, delivered once they run
+    for (auto& loop : loops)
+    {
+        std::thread runner([&]() { loop.run(); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        loop.stop();
+        runner.join();
+    }
+    for (auto& mailbox : mailboxes)
+    {
+        ASSERT_EQ(std::vector<IEvent_ptr>{event}, mailbox->snapshot());
+    }
+}
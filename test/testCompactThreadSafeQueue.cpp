@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "ThreadSafeQueue/CompactThreadSafeQueue.hpp"
+
+using CompactQueue = CompactThreadSafeQueue<std::shared_ptr<int>>;
+
+// Its move constructor throws when asked to
+struct Fragile
+{
+    Fragile() = default;
+    Fragile(int value, bool failing = false) : value{value}, failing{failing}
+    {
+    }
+    Fragile(Fragile&& other) : value{other.value}, failing{other.failing}
+    {
+        if (failing)
+            throw std::runtime_error("move failed");
+    }
+    Fragile(const Fragile&)            = default;
+    Fragile& operator=(Fragile&&)      = default;
+    Fragile& operator=(const Fragile&) = default;
+
+    int  value{0};
+    bool failing{false};
+};
+
+// Fixture definition
+class CompactThreadSafeQueueFixture : public ::testing::Test
+{
+   protected:
+    CompactQueue m_queue;
+};
+
+TEST_F(CompactThreadSafeQueueFixture, TestFifoOrderAcrossSegments)
+{
+    const int count = 3 * CompactQueue::SEGMENT_CAPACITY + 1;
+    for (int i = 0; i < count; i++)
+        m_queue.put(std::make_shared<int>(i));
+    ASSERT_EQ(std::size_t(count), m_queue.size());
+    ASSERT_EQ(std::size_t(count), m_queue.snapshot().size());
+
+    for (int i = 0; i < count; i++)
+        ASSERT_EQ(i, *m_queue.wait_and_pop());
+    ASSERT_TRUE(m_queue.empty());
+}
+
+TEST_F(CompactThreadSafeQueueFixture, TestPutPrioritized)
+{
+    m_queue.put(std::make_shared<int>(1));
+    m_queue.put_prioritized(std::make_shared<int>(2));
+    m_queue.put_prioritized(std::make_shared<int>(3));
+
+    ASSERT_EQ(3, *m_queue.wait_and_pop());
+    ASSERT_EQ(2, *m_queue.wait_and_pop());
+    ASSERT_EQ(1, *m_queue.wait_and_pop());
+}
+
+TEST_F(CompactThreadSafeQueueFixture, TestWaitAndPopForTimeout)
+{
+    auto before = std::chrono::steady_clock::now();
+    ASSERT_EQ(nullptr, m_queue.wait_and_pop_for(std::chrono::milliseconds(50)));
+    ASSERT_GE(std::chrono::steady_clock::now() - before, std::chrono::milliseconds(50));
+}
+
+TEST_F(CompactThreadSafeQueueFixture, TestShrinksBackWhenDrained)
+{
+    const std::size_t empty = m_queue.footprint();
+    ASSERT_LE(empty, 64u);
+
+    for (int i = 0; i < 100; i++)
+        m_queue.put(std::make_shared<int>(i));
+    ASSERT_GT(m_queue.footprint(), empty);
+
+    while (!m_queue.empty())
+        m_queue.wait_and_pop();
+    ASSERT_EQ(empty, m_queue.footprint());
+}
+
+TEST_F(CompactThreadSafeQueueFixture, TestManyProducers)
+{
+    const int                producers    = 4;
+    const int                per_producer = 10000;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++)
+    {
+        threads.emplace_back(
+            [&, p]()
+            {
+                for (int i = 0; i < per_producer; i++)
+                    m_queue.put(std::make_shared<int>(p * per_producer + i));
+            });
+    }
+
+    // Elements of each producer come out in the order it put them
+    std::vector<int> last(producers, -1);
+    for (int i = 0; i < producers * per_producer; i++)
+    {
+        int value    = *m_queue.wait_and_pop();
+        int producer = value / per_producer;
+        ASSERT_LT(last[producer], value);
+        last[producer] = value;
+    }
+    for (auto& thread : threads)
+        thread.join();
+    ASSERT_TRUE(m_queue.empty());
+}
+
+TEST(CompactThreadSafeQueue, TestThrowingElementLeavesTheQueueUnchanged)
+{
+    using FragileQueue = CompactThreadSafeQueue<Fragile>;
+    FragileQueue queue;
+    // The failing put comes when a new segment is needed, then within a segment
+    for (int i = 0; i < int(FragileQueue::SEGMENT_CAPACITY); i++)
+        queue.put(Fragile{i});
+    ASSERT_THROW(queue.put(Fragile{-1, true}), std::runtime_error);
+    queue.put(Fragile{int(FragileQueue::SEGMENT_CAPACITY)});
+    ASSERT_THROW(queue.put(Fragile{-1, true}), std::runtime_error);
+    ASSERT_THROW(queue.put_prioritized(Fragile{-1, true}), std::runtime_error);
+    ASSERT_EQ(std::size_t(FragileQueue::SEGMENT_CAPACITY + 1), queue.size());
+
+    // Not left locked
+    for (int i = 0; i <= int(FragileQueue::SEGMENT_CAPACITY); i++)
+        ASSERT_EQ(i, queue.wait_and_pop().value);
+    ASSERT_TRUE(queue.empty());
+}
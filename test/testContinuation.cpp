@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "StateManager/StateManager.hpp"
+
+namespace
+{
+class Work : public Event<Work>
+{
+};
+class Ping : public Event<Ping>
+{
+};
+class Reply : public IEvent
+{
+   public:
+    explicit Reply(int value) : value{value}
+    {
+    }
+    int value;
+};
+
+using Trace = std::vector<std::string>;
+
+class HandlerState
+{
+   public:
+    int on_entry()
+    {
+        return 0;
+    }
+    int on_exit()
+    {
+        return 0;
+    }
+    int process_event(IEvent_ptr event)
+    {
+        return m_handler ? m_handler(event) : -1;
+    }
+
+    std::function<int(const IEvent_ptr&)> m_handler;
+};
+using HandlerState_ptr = std::shared_ptr<HandlerState>;
+
+// Appends to the trace when destroyed, to tell a cancelled continuation from a leaked one
+struct Guard
+{
+    Trace&      trace;
+    std::string name;
+    ~Guard()
+    {
+        trace.push_back(name);
+    }
+};
+}  // namespace
+
+// root -> busy, idle. The mailbox is a plain deque drained by the test
+class ContinuationFixture : public ::testing::Test
+{
+   protected:
+    ContinuationFixture()
+    {
+        tree<HandlerState_ptr> states;
+        m_root = states.set_head(std::make_shared<HandlerState>());
+        m_busy = states.append_child(m_root, std::make_shared<HandlerState>());
+        m_idle = states.append_child(m_root, std::make_shared<HandlerState>());
+        m_sm   = std::make_unique<StateManager<HandlerState_ptr>>(std::move(states), m_busy);
+        m_sm->setMailbox([this](IEvent_ptr event) { m_mailbox.push_back(event); });
+        m_root.node->data->m_handler = [this](const IEvent_ptr& event)
+        {
+            m_trace.push_back(typeid(*event) == typeid(Ping) ? "ping" : "other");
+            return 0;
+        };
+        m_sm->init();
+    }
+
+    void drain()
+    {
+        while (!m_mailbox.empty())
+        {
+            IEvent_ptr event = m_mailbox.front();
+            m_mailbox.pop_front();
+            m_sm->processEvent(event);
+        }
+    }
+
+    tree<HandlerState_ptr>::iterator                m_root, m_busy, m_idle;
+    std::unique_ptr<StateManager<HandlerState_ptr>> m_sm;
+    std::deque<IEvent_ptr>                          m_mailbox;
+    Trace                                           m_trace;
+};
+
+TEST_F(ContinuationFixture, TestYieldLetsQueuedEventsThrough)
+{
+    auto work = [this]() -> Continuation
+    {
+        m_trace.push_back("first half");
+        co_await m_sm->yield();
+        m_trace.push_back("second half");
+    };
+    m_busy.node->data->m_handler = [&](const IEvent_ptr& event)
+    {
+        if (typeid(*event) != typeid(Work))
+            return -1;
+        m_sm->spawn(m_busy, work());
+        return 0;
+    };
+
+    m_mailbox.push_back(std::make_shared<Ping>());  // Already queued when the work yields
+    m_sm->processEvent(std::make_shared<Work>());
+    ASSERT_EQ(1u, m_sm->continuations());
+    drain();
+
+    ASSERT_EQ((Trace{"first half", "ping", "second half"}), m_trace);
+    ASSERT_EQ(0u, m_sm->continuations());
+}
+
+TEST_F(ContinuationFixture, TestYieldWithoutMailboxThrows)
+{
+    m_sm->setMailbox(nullptr);
+    auto work = [this]() -> Continuation { co_await m_sm->yield(); };
+    ASSERT_THROW(m_sm->spawn(m_busy, work()), std::logic_error);
+    ASSERT_EQ(0u, m_sm->continuations());
+}
+
+TEST_F(ContinuationFixture, TestExitCancelsContinuation)
+{
+    auto work = [this]() -> Continuation
+    {
+        Guard guard{m_trace, "cancelled"};
+        co_await m_sm->yield();
+        m_trace.push_back("resumed");
+    };
+    m_sm->spawn(m_busy, work());
+    ASSERT_EQ(1u, m_sm->continuations());
+
+    m_sm->transitionTo(m_idle);
+    ASSERT_EQ(0u, m_sm->continuations());
+    ASSERT_EQ((Trace{"cancelled"}), m_trace);
+
+    // The resume event still in the mailbox is dropped, not dispatched to the states
+    drain();
+    ASSERT_EQ((Trace{"cancelled"}), m_trace);
+}
+
+TEST_F(ContinuationFixture, TestNextEventResumesInTheSameStep)
+{
+    auto work = [this]() -> Continuation
+    {
+        auto reply = co_await m_sm->nextEvent<Reply>();
+        m_trace.push_back("reply " + std::to_string(reply->value));
+        m_sm->requestTransition(m_idle);
+    };
+    m_sm->spawn(m_busy, work());
+
+    m_sm->processEvent(std::make_shared<Ping>());
+    ASSERT_EQ(m_busy, m_sm->currentState());
+    m_sm->processEvent(std::make_shared<Reply>(7));
+
+    // Consumed by the continuation only, whose transition is applied at the end of the step
+    ASSERT_EQ((Trace{"ping", "reply 7"}), m_trace);
+    ASSERT_EQ(m_idle, m_sm->currentState());
+    ASSERT_EQ(0u, m_sm->continuations());
+}
+
+TEST_F(ContinuationFixture, TestResumeWhenArmed)
+{
+    IEvent_ptr armed;
+    auto       work = [&]() -> Continuation
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            co_await m_sm->resumeWhen([&](IEvent_ptr resume) { armed = resume; });
+            m_trace.push_back("tick");
+        }
+    };
+    m_sm->spawn(m_busy, work());
+
+    for (int i = 0; i < 3; i++)
+    {
+        ASSERT_NE(nullptr, armed);
+        m_sm->processEvent(std::exchange(armed, nullptr));
+    }
+    ASSERT_EQ((Trace{"tick", "tick", "tick"}), m_trace);
+    ASSERT_EQ(0u, m_sm->continuations());
+}
@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CoroutineExecutor/CoroutineExecutor.hpp"
+#include "IState/IState.hpp"
+#include "StateManager/StateManager.hpp"
+
+namespace
+{
+class Toggle : public IEvent
+{
+};
+
+class CoActor;
+
+class CoSuperState : public IState<CoActor>
+{
+   public:
+    CoSuperState(CoActor* actor, std::string name) : IState<CoActor>(actor), m_name{name}
+    {
+    }
+    virtual int on_entry() override;
+    virtual int on_exit() override;
+    virtual int process_event(IEvent_ptr event) override;
+
+    std::string m_name;
+};
+
+class CoActor
+{
+   public:
+    using CoSuperState_ptr = std::shared_ptr<CoSuperState>;
+
+    CoActor(EventLoop& loop) : m_mailbox{loop}
+    {
+        tree<CoSuperState_ptr> tree;
+        tree.set_head(std::make_shared<CoSuperState>(this, "root"));
+        m_on  = tree.append_child(tree.begin(), std::make_shared<CoSuperState>(this, "on"));
+        m_off = tree.append_child(tree.begin(), std::make_shared<CoSuperState>(this, "off"));
+        m_end = tree.end();
+
+        m_next_state    = m_end;
+        m_state_manager = std::make_shared<StateManager<CoSuperState_ptr>>(std::move(tree), m_off);
+    }
+
+    void start()
+    {
+        m_task = run();
+        m_mailbox.loop().start(m_task);
+    }
+
+    void callback_IEvent(IEvent_ptr event)
+    {
+        m_mailbox.put(event);
+    }
+
+    std::shared_ptr<StateManager<CoSuperState_ptr>> m_state_manager;
+    tree<CoSuperState_ptr>::iterator                m_on, m_off, m_end, m_next_state;
+    std::vector<std::string>                        m_trace;
+    int                                             m_processed{0};
+
+   private:
+    Task run()
+    {
+        m_state_manager->init();
+        while (true)
+        {
+            IEvent_ptr current_event = co_await m_mailbox.pop();
+            m_state_manager->processEvent(current_event);
+
+            if (m_next_state != m_end)
+            {
+                m_state_manager->transitionTo(m_next_state);
+                m_next_state = m_end;
+            }
+            m_processed++;
+        }
+    }
+
+    Mailbox m_mailbox;
+    Task    m_task;
+};
+
+int CoSuperState::on_entry()
+{
+    m_actor->m_trace.push_back("entry " + m_name);
+    return 0;
+}
+int CoSuperState::on_exit()
+{
+    m_actor->m_trace.push_back("exit " + m_name);
+    return 0;
+}
+int CoSuperState::process_event(IEvent_ptr event)
+{
+    (void) event;
+    if (m_name == "root")
+        return 0;
+    m_actor->m_next_state = (m_name == "on") ? m_actor->m_off : m_actor->m_on;
+    return 0;
+}
+}  // namespace
+
+// Fixture definition
+class CoroutineExecutorFixture : public ::testing::Test
+{
+   protected:
+    void runFor(std::chrono::milliseconds duration)
+    {
+        std::thread stopper(
+            [&]()
+            {
+                std::this_thread::sleep_for(duration);
+                m_loop.stop();
+            });
+        m_loop.run();
+        stopper.join();
+    }
+
+    EventLoop m_loop;
+};
+
+TEST_F(CoroutineExecutorFixture, TestRunToCompletionOrder)
+{
+    CoActor actor(m_loop);
+    actor.start();
+    actor.callback_IEvent(std::make_shared<Toggle>());
+    actor.callback_IEvent(std::make_shared<Toggle>());
+
+    runFor(std::chrono::milliseconds(50));
+
+    std::vector<std::string> expected{"entry off", "exit off", "entry on", "exit on", "entry off"};
+    ASSERT_EQ(expected, actor.m_trace);
+    ASSERT_EQ(2, actor.m_processed);
+}
+
+TEST_F(CoroutineExecutorFixture, TestPostFromOtherThreads)
+{
+    CoActor actor(m_loop);
+    actor.start();
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 4; p++)
+    {
+        producers.emplace_back(
+            [&]()
+            {
+                for (int i = 0; i < 250; i++)
+                    actor.callback_IEvent(std::make_shared<Toggle>());
+            });
+    }
+
+    std::thread loop([&]() { m_loop.run(); });
+    for (auto& producer : producers)
+        producer.join();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    m_loop.stop();
+    loop.join();
+
+    ASSERT_EQ(1000, actor.m_processed);
+}
+
+TEST_F(CoroutineExecutorFixture, TestManyActorsOnOneThread)
+{
+    std::vector<std::unique_ptr<CoActor>> actors;
+    for (int i = 0; i < 1000; i++)
+    {
+        actors.emplace_back(std::make_unique<CoActor>(m_loop));
+        actors.back()->start();
+        for (int k = 0; k < 3; k++)
+            actors.back()->callback_IEvent(std::make_shared<Toggle>());
+    }
+
+    runFor(std::chrono::milliseconds(100));
+
+    for (auto& actor : actors)
+    {
+        ASSERT_EQ(3, actor->m_processed);
+        ASSERT_EQ(actor->m_on, actor->m_state_manager->currentState());
+    }
+}
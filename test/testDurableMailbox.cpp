@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "DurableMailbox/DurableMailbox.hpp"
+
+namespace
+{
+class Tick : public IEvent
+{
+   public:
+    Tick(uint32_t count) : count{count}
+    {
+    }
+    uint32_t count;
+};
+class Other : public IEvent
+{
+};
+
+Snapshot::EventCodec tickCodec()
+{
+    Snapshot::EventCodec codec;
+    codec.encode = [](const IEvent_ptr& event, std::vector<uint8_t>& blob)
+    {
+        auto tick = std::dynamic_pointer_cast<Tick>(event);
+        if (!tick)
+            return false;
+        auto* bytes = reinterpret_cast<const uint8_t*>(&tick->count);
+        blob.insert(blob.end(), bytes, bytes + sizeof(tick->count));
+        return true;
+    };
+    codec.decode = [](const uint8_t* data, std::size_t size) -> IEvent_ptr
+    {
+        uint32_t count;
+        if (size != sizeof(count))
+            return nullptr;
+        std::memcpy(&count, data, sizeof(count));
+        return std::make_shared<Tick>(count);
+    };
+    return codec;
+}
+
+uint32_t countOf(const IEvent_ptr& event)
+{
+    return std::static_pointer_cast<Tick>(event)->count;
+}
+
+// One Tick record: 16 bytes of record header and 4 bytes of payload padded to 8
+constexpr std::size_t TICK_RECORD = 24;
+}  // namespace
+
+class DurableMailboxFixture : public ::testing::Test
+{
+   protected:
+    // One file per test and process, as ctest runs the tests in parallel processes
+    DurableMailboxFixture()
+        : m_path{testing::TempDir() + "durable_mailbox_"
+                 + testing::UnitTest::GetInstance()->current_test_info()->name() + "_"
+                 + std::to_string(getpid()) + ".bin"}
+    {
+        std::remove(m_path.c_str());
+    }
+
+    ~DurableMailboxFixture()
+    {
+        std::remove(m_path.c_str());
+    }
+
+    std::unique_ptr<DurableMailbox> open(std::size_t capacity = 4096)
+    {
+        return std::make_unique<DurableMailbox>(m_path, capacity, tickCodec());
+    }
+
+    std::string m_path;
+};
+
+TEST_F(DurableMailboxFixture, TestUnacknowledgedEventsAreRecovered)
+{
+    {
+        auto mailbox = open();
+        ASSERT_TRUE(mailbox->valid());
+        ASSERT_EQ(0u, mailbox->recovered());
+        for (uint32_t i = 0; i < 4; i++)
+            ASSERT_TRUE(mailbox->put(std::make_shared<Tick>(i)));
+        ASSERT_EQ(0u, countOf(mailbox->wait_and_pop()));
+        mailbox->acknowledge();
+        // Popped but not processed to completion: delivered again
+        ASSERT_EQ(1u, countOf(mailbox->wait_and_pop()));
+    }
+
+    auto mailbox = open();
+    ASSERT_EQ(3u, mailbox->recovered());
+    for (uint32_t i = 1; i < 4; i++)
+        ASSERT_EQ(i, countOf(mailbox->wait_and_pop()));
+    ASSERT_EQ(nullptr, mailbox->wait_and_pop_for(std::chrono::milliseconds(1)));
+}
+
+TEST_F(DurableMailboxFixture, TestRingWrapsAround)
+{
+    {
+        // Room for a few records only, with a gap at the end of the ring: the positions wrap
+        // many times, over WRAP markers
+        auto mailbox = open(5 * TICK_RECORD + 8);
+        for (uint32_t i = 0; i < 100; i++)
+        {
+            ASSERT_TRUE(mailbox->put(std::make_shared<Tick>(i)));
+            ASSERT_EQ(i, countOf(mailbox->wait_and_pop()));
+            mailbox->acknowledge();
+        }
+        ASSERT_TRUE(mailbox->put(std::make_shared<Tick>(100)));
+        ASSERT_TRUE(mailbox->put(std::make_shared<Tick>(101)));
+    }
+
+    auto mailbox = open(5 * TICK_RECORD + 8);
+    ASSERT_EQ(2u, mailbox->recovered());
+    ASSERT_EQ(100u, countOf(mailbox->wait_and_pop()));
+    ASSERT_EQ(101u, countOf(mailbox->wait_and_pop()));
+}
+
+TEST_F(DurableMailboxFixture, TestAcknowledgementsResumeAcrossRestarts)
+{
+    // Each session acknowledges what the previous one left, through the wrapping ring
+    const std::size_t capacity = 5 * TICK_RECORD + 8;
+    for (uint32_t session = 0; session < 20; session++)
+    {
+        auto mailbox = open(capacity);
+        ASSERT_TRUE(mailbox->valid());
+        ASSERT_EQ(session ? 2u : 0u, mailbox->recovered());
+        if (session)
+        {
+            ASSERT_EQ(2 * session - 2, countOf(mailbox->wait_and_pop()));
+            mailbox->acknowledge();
+            ASSERT_EQ(2 * session - 1, countOf(mailbox->wait_and_pop()));
+            mailbox->acknowledge();
+        }
+        ASSERT_TRUE(mailbox->put(std::make_shared<Tick>(2 * session)));
+        ASSERT_TRUE(mailbox->put(std::make_shared<Tick>(2 * session + 1)));
+    }
+}
+
+TEST_F(DurableMailboxFixture, TestRecoveryStopsAtTornRecord)
+{
+    {
+        auto mailbox = open();
+        for (uint32_t i = 0; i < 3; i++)
+            mailbox->put(std::make_shared<Tick>(i));
+    }
+    // Damage the payload of the second record, after the 4096 bytes of the file header
+    FILE* file = std::fopen(m_path.c_str(), "r+b");
+    ASSERT_NE(nullptr, file);
+    std::fseek(file, 4096 + TICK_RECORD + 16, SEEK_SET);
+    std::fputc(0x55, file);
+    std::fclose(file);
+
+    auto mailbox = open();
+    ASSERT_EQ(1u, mailbox->recovered());
+    ASSERT_EQ(0u, countOf(mailbox->wait_and_pop()));
+}
+
+TEST_F(DurableMailboxFixture, TestFullRingWaitsForAcknowledgement)
+{
+    auto mailbox =
+        std::make_unique<DurableMailbox>(m_path, 2 * TICK_RECORD, tickCodec(),
+                                         std::chrono::milliseconds{0});  // msync on every put
+    ASSERT_TRUE(mailbox->put(std::make_shared<Tick>(0)));
+    ASSERT_TRUE(mailbox->put(std::make_shared<Tick>(1)));
+    ASSERT_FALSE(mailbox->put(std::make_shared<Other>()));  // Refused by the codec
+
+    std::atomic_bool put{false};
+    std::thread      producer(
+        [&]()
+        {
+            mailbox->put(std::make_shared<Tick>(2));
+            put = true;
+        });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_FALSE(put);
+
+    ASSERT_EQ(0u, countOf(mailbox->wait_and_pop()));
+    mailbox->acknowledge();
+    producer.join();
+    ASSERT_TRUE(put);
+    ASSERT_EQ(1u, countOf(mailbox->wait_and_pop()));
+    ASSERT_EQ(2u, countOf(mailbox->wait_and_pop()));
+}
+
+TEST_F(DurableMailboxFixture, TestMismatchingFileIsLeftUntouched)
+{
+    {
+        auto mailbox = open();
+        ASSERT_TRUE(mailbox->put(std::make_shared<Tick>(7)));
+        // The file is locked while a mailbox has it open
+        ASSERT_FALSE(open()->valid());
+    }
+
+    // Another capacity, then a codec that cannot decode the record: neither wipes it
+    ASSERT_FALSE(open(8192)->valid());
+    Snapshot::EventCodec refusing = tickCodec();
+    refusing.decode               = [](const uint8_t*, std::size_t) { return IEvent_ptr{}; };
+    ASSERT_FALSE(DurableMailbox(m_path, 4096, refusing).valid());
+
+    auto mailbox = open();
+    ASSERT_TRUE(mailbox->valid());
+    ASSERT_EQ(1u, mailbox->recovered());
+    ASSERT_EQ(7u, countOf(mailbox->wait_and_pop()));
+}
@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "IEvent/InlineEvent.hpp"
+#include "StateManager/StateManager.hpp"
+#include "ThreadSafeQueue/InlineEventQueue.hpp"
+
+namespace
+{
+struct DoToasting
+{
+    uint64_t timeout;
+};
+
+struct DoBaking
+{
+    float temperature;
+};
+
+// Too large to be stored inline
+struct Bulk
+{
+    std::array<uint8_t, 200> data;
+};
+
+// Counts live instances, to check the envelope's copies and destruction
+struct Tracked
+{
+    Tracked(int& live) : live{&live}
+    {
+        (*this->live)++;
+    }
+    Tracked(const Tracked& other) : live{other.live}
+    {
+        (*live)++;
+    }
+    ~Tracked()
+    {
+        (*live)--;
+    }
+    int* live;
+};
+
+// Fails to copy once armed
+struct FailingCopy
+{
+    FailingCopy() = default;
+    FailingCopy(const FailingCopy& other) : fail{other.fail}
+    {
+        if (fail)
+            throw std::runtime_error("copy failed");
+    }
+    FailingCopy(FailingCopy&&) noexcept = default;
+    bool fail{false};
+};
+
+// Handles DoToasting itself, anything else is unhandled
+class InlineState
+{
+   public:
+    InlineState(std::vector<uint64_t>& handled) : m_handled{handled}
+    {
+    }
+    int on_entry()
+    {
+        return 0;
+    }
+    int on_exit()
+    {
+        return 0;
+    }
+    int process_event(IEvent_ptr)
+    {
+        return -1;
+    }
+    int process_inline(const InlineEvent& event)
+    {
+        if (const auto* toasting = event.get<DoToasting>())
+        {
+            m_handled.push_back(toasting->timeout);
+            return 0;
+        }
+        return -1;
+    }
+
+   private:
+    std::vector<uint64_t>& m_handled;
+};
+}  // namespace
+
+TEST(InlineEventTest, TestPayloadStoredInline)
+{
+    InlineEvent event(DoToasting{60000});
+    ASSERT_EQ(eventId<DoToasting>(), event.id());
+    ASSERT_NE(eventId<DoToasting>(), eventId<DoBaking>());
+    ASSERT_EQ(typeid(DoToasting).hash_code(), event.typeHash());
+    ASSERT_TRUE(event.is<DoToasting>());
+    ASSERT_EQ(nullptr, event.get<DoBaking>());
+    ASSERT_EQ(60000u, event.get<DoToasting>()->timeout);
+    ASSERT_TRUE(InlineEvent::fits_inline<DoToasting>);
+}
+
+TEST(InlineEventTest, TestLargePayloadFallsBackToHeap)
+{
+    ASSERT_FALSE(InlineEvent::fits_inline<Bulk>);
+    Bulk bulk;
+    bulk.data.fill(7);
+    InlineEvent event(bulk);
+    InlineEvent copy = event;
+    InlineEvent moved(std::move(event));
+    ASSERT_TRUE(event.empty());
+    ASSERT_EQ(7, copy.get<Bulk>()->data[199]);
+    ASSERT_EQ(7, moved.get<Bulk>()->data[0]);
+    ASSERT_NE(copy.get<Bulk>(), moved.get<Bulk>());
+}
+
+TEST(InlineEventTest, TestCopiesAreDestroyed)
+{
+    int live = 0;
+    {
+        InlineEvent event{Tracked(live)};
+        InlineEvent copy = event;
+        ASSERT_EQ(2, live);
+        copy = InlineEvent(DoBaking{140});
+        ASSERT_EQ(1, live);
+    }
+    ASSERT_EQ(0, live);
+}
+
+TEST(InlineEventTest, TestFailedCopyLeavesNothingToDestroy)
+{
+    FailingCopy armed;
+    armed.fail = true;
+    InlineEvent event{std::move(armed)};
+    ASSERT_THROW(InlineEvent{event}, std::runtime_error);
+
+    InlineEvent target{DoBaking{140}};
+    ASSERT_THROW(target = event, std::runtime_error);
+    ASSERT_TRUE(target.is<DoBaking>());
+    ASSERT_TRUE(event.is<FailingCopy>());
+}
+
+TEST(InlineEventTest, TestQueueIsFifoAcrossGrowth)
+{
+    InlineEventQueue queue(4);
+    for (uint64_t round = 0; round < 3; round++)
+    {
+        // Leaves the ring wrapped around before it has to grow
+        for (uint64_t i = 0; i < 3; i++)
+            queue.put(InlineEvent(DoToasting{i}));
+        for (uint64_t i = 0; i < 3; i++)
+            ASSERT_EQ(i, queue.wait_and_pop().get<DoToasting>()->timeout);
+    }
+    for (uint64_t i = 0; i < 10; i++)
+        queue.put(InlineEvent(DoToasting{i}));
+    ASSERT_EQ(10u, queue.size());
+    ASSERT_EQ(16u, queue.capacity());
+    for (uint64_t i = 0; i < 10; i++)
+        ASSERT_EQ(i, queue.wait_and_pop().get<DoToasting>()->timeout);
+    ASSERT_TRUE(queue.wait_and_pop_for(std::chrono::milliseconds(1)).empty());
+}
+
+TEST(InlineEventTest, TestStateManagerDispatchesInlineEvents)
+{
+    using State_ptr = std::shared_ptr<InlineState>;
+    std::vector<uint64_t> handled;
+    tree<State_ptr>       states;
+    auto root  = states.set_head(std::make_shared<InlineState>(handled));
+    auto idle  = states.append_child(root, std::make_shared<InlineState>(handled));
+    auto other = states.append_child(root, std::make_shared<InlineState>(handled));
+    StateManager<State_ptr> sm(std::move(states), idle);
+    sm.addTransition<DoBaking>(root, other);
+    sm.init();
+
+    sm.processEvent(InlineEvent(DoToasting{5}));
+    ASSERT_EQ(std::vector<uint64_t>{5}, handled);
+    ASSERT_EQ(idle, sm.currentState());
+
+    // Bubbles to the root, where the table has a row for the payload type
+    sm.processEvent(InlineEvent(DoBaking{140}));
+    ASSERT_EQ(other, sm.currentState());
+}
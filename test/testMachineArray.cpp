@@ -0,0 +1,256 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "IState/IState.hpp"
+#include "MachineArray/MachineArray.hpp"
+
+namespace
+{
+class DoorOpened : public IEvent
+{
+};
+class DoorClosed : public IEvent
+{
+};
+class DoToasting : public IEvent
+{
+};
+class DoBaking : public IEvent
+{
+};
+class Jam : public IEvent
+{
+};
+class Crumbs : public Event<Crumbs>
+{
+};
+
+enum class StateValue
+{
+    ROOT,
+    HEATING,
+    DOOR_OPEN,
+    TOASTING,
+    BAKING
+};
+
+class Fleet;
+
+// The handlers of one toaster, shared by the whole fleet
+class ToasterState : public IState<Fleet>
+{
+   public:
+    using IState<Fleet>::IState;
+    int process_event(IEvent_ptr event) override
+    {
+        calls++;
+        if (typeid(*event) == typeid(Jam))
+            throw std::runtime_error("jammed");
+        return -1;
+    }
+
+    std::atomic<int> calls{0};  // By every instance
+};
+using ToasterState_ptr = std::shared_ptr<ToasterState>;
+
+class Heating : public ToasterState
+{
+   public:
+    using ToasterState::ToasterState;
+    int on_entry() override;
+    int on_exit() override;
+};
+
+class DoorOpen : public ToasterState
+{
+   public:
+    using ToasterState::ToasterState;
+    int process_event(IEvent_ptr event) override;
+};
+
+// Per-toaster data as arrays indexed by the instance being processed
+class Fleet
+{
+   public:
+    Fleet(std::size_t toasters, std::size_t workers)
+        : m_heater_on(toasters, 0), m_heatings(toasters, 0), m_threads(toasters)
+    {
+        tree<ToasterState_ptr> tree;
+        m_states[StateValue::ROOT] = tree.set_head(std::make_shared<ToasterState>(this));
+        m_states[StateValue::HEATING] =
+            tree.append_child(m_states[StateValue::ROOT], std::make_shared<Heating>(this));
+        m_states[StateValue::DOOR_OPEN] =
+            tree.append_child(m_states[StateValue::ROOT], std::make_shared<DoorOpen>(this));
+        m_states[StateValue::TOASTING] =
+            tree.append_child(m_states[StateValue::HEATING], std::make_shared<ToasterState>(this));
+        m_states[StateValue::BAKING] =
+            tree.append_child(m_states[StateValue::HEATING], std::make_shared<ToasterState>(this));
+
+        m_machines = std::make_unique<MachineArray<ToasterState_ptr>>(
+            std::move(tree), m_states[StateValue::HEATING], toasters, workers);
+        m_machines->addTransition<DoorOpened>(m_states[StateValue::HEATING],
+                                              m_states[StateValue::DOOR_OPEN]);
+        m_machines->addTransition<DoToasting>(m_states[StateValue::HEATING],
+                                              m_states[StateValue::TOASTING]);
+        m_machines->addTransition<DoBaking>(m_states[StateValue::HEATING],
+                                            m_states[StateValue::BAKING]);
+        m_heating = m_machines->stateIndex(m_states[StateValue::HEATING]);
+        m_machines->init();
+    }
+
+    StateValue stateOf(std::size_t toaster) const
+    {
+        auto current = m_machines->currentState(toaster);
+        for (auto& [value, state] : m_states)
+        {
+            if (state == current)
+                return value;
+        }
+        return StateValue::ROOT;
+    }
+
+    std::unique_ptr<MachineArray<ToasterState_ptr>>        m_machines;
+    std::map<StateValue, tree<ToasterState_ptr>::iterator> m_states;
+    std::size_t                                            m_heating;  // Index of HEATING
+    std::vector<uint8_t>                                   m_heater_on;  // Not packed like bools
+    std::vector<int>                                       m_heatings;
+    std::vector<std::thread::id>                           m_threads;
+};
+
+int Heating::on_entry()
+{
+    std::size_t toaster           = MachineArray<ToasterState_ptr>::instance();
+    m_actor->m_heater_on[toaster] = 1;
+    m_actor->m_heatings[toaster]++;
+    m_actor->m_threads[toaster] = std::this_thread::get_id();
+    return 0;
+}
+
+int Heating::on_exit()
+{
+    m_actor->m_heater_on[MachineArray<ToasterState_ptr>::instance()] = 0;
+    return 0;
+}
+
+int DoorOpen::process_event(IEvent_ptr event)
+{
+    if (typeid(*event) != typeid(DoorClosed))
+        return -1;
+    // Resumes toasting or baking, whichever this toaster was doing
+    return m_actor->m_machines->requestTransitionToHistory(m_actor->m_heating);
+}
+}  // namespace
+
+TEST(MachineArray, TestInstancesEvolveIndependently)
+{
+    Fleet fleet(4, 2);
+    ASSERT_EQ((std::vector<int>{1, 1, 1, 1}), fleet.m_heatings);
+
+    fleet.m_machines->post(1, std::make_shared<DoorOpened>());
+    fleet.m_machines->post(2, std::make_shared<DoBaking>());
+    ASSERT_EQ(2u, fleet.m_machines->process());
+
+    ASSERT_EQ(StateValue::HEATING, fleet.stateOf(0));
+    ASSERT_EQ(StateValue::DOOR_OPEN, fleet.stateOf(1));
+    ASSERT_EQ(StateValue::BAKING, fleet.stateOf(2));
+    ASSERT_EQ(StateValue::HEATING, fleet.stateOf(3));
+    ASSERT_EQ((std::vector<uint8_t>{1, 0, 1, 1}), fleet.m_heater_on);
+}
+
+TEST(MachineArray, TestHistoryIsPerInstance)
+{
+    Fleet fleet(2, 1);
+    fleet.m_machines->post(0, std::make_shared<DoToasting>());
+    fleet.m_machines->post(1, std::make_shared<DoBaking>());
+    fleet.m_machines->process();
+
+    fleet.m_machines->broadcast(std::make_shared<DoorOpened>());
+    fleet.m_machines->process();
+    ASSERT_EQ(StateValue::DOOR_OPEN, fleet.stateOf(0));
+    ASSERT_EQ(StateValue::DOOR_OPEN, fleet.stateOf(1));
+
+    fleet.m_machines->broadcast(std::make_shared<DoorClosed>());
+    fleet.m_machines->process();
+    ASSERT_EQ(StateValue::TOASTING, fleet.stateOf(0));
+    ASSERT_EQ(StateValue::BAKING, fleet.stateOf(1));
+    ASSERT_EQ((std::vector<int>{2, 2}), fleet.m_heatings);
+}
+
+TEST(MachineArray, TestEventsOfABatchAreSpreadOverWorkers)
+{
+    const std::size_t toasters = 1000;
+    Fleet             fleet(toasters, 4);
+    auto              entered_on = fleet.m_threads;
+    ASSERT_EQ(4u, std::set<std::thread::id>(entered_on.begin(), entered_on.end()).size());
+
+    for (int round = 0; round < 10; round++)
+    {
+        fleet.m_machines->broadcast(std::make_shared<DoorOpened>());
+        fleet.m_machines->broadcast(std::make_shared<DoorClosed>());
+        ASSERT_EQ(2 * toasters, fleet.m_machines->process());
+    }
+    for (std::size_t toaster = 0; toaster < toasters; toaster++)
+    {
+        ASSERT_EQ(StateValue::HEATING, fleet.stateOf(toaster));
+        ASSERT_EQ(11, fleet.m_heatings[toaster]);
+    }
+    // An instance always goes to the same worker
+    ASSERT_EQ(entered_on, fleet.m_threads);
+}
+
+TEST(MachineArray, TestThrowingHandlerWaitsForEveryWorker)
+{
+    // Instance 0 runs on the calling thread, instance 1 on the other worker
+    for (std::size_t jammed : {0, 1})
+    {
+        Fleet fleet(4, 2);
+        fleet.m_machines->post(jammed, std::make_shared<Jam>());
+        fleet.m_machines->broadcast(std::make_shared<DoorOpened>());
+        ASSERT_THROW(fleet.m_machines->process(), std::runtime_error);
+        // The other worker went on, the events left to the jammed one were dropped
+        for (std::size_t toaster = 0; toaster < 4; toaster++)
+        {
+            ASSERT_EQ((toaster % 2 == jammed) ? StateValue::HEATING : StateValue::DOOR_OPEN,
+                      fleet.stateOf(toaster));
+        }
+        ASSERT_EQ(0u, fleet.m_machines->process());
+
+        fleet.m_machines->broadcast(std::make_shared<DoorClosed>());
+        ASSERT_EQ(4u, fleet.m_machines->process());
+        for (std::size_t toaster = 0; toaster < 4; toaster++)
+            ASSERT_EQ(StateValue::HEATING, fleet.stateOf(toaster));
+    }
+}
+
+TEST(MachineArray, TestEventSkipsDeclaredNonHandlers)
+{
+    Fleet fleet(4, 2);
+    auto& machines = *fleet.m_machines;
+    machines.declareHandled<>(fleet.m_states[StateValue::TOASTING]);
+    // Its table rows still count as declared
+    machines.declareHandled<>(fleet.m_states[StateValue::HEATING]);
+
+    machines.broadcast(std::make_shared<DoToasting>());
+    machines.broadcast(std::make_shared<Crumbs>());
+    ASSERT_EQ(8u, machines.process());
+    for (std::size_t toaster = 0; toaster < 4; toaster++)
+        ASSERT_EQ(StateValue::TOASTING, fleet.stateOf(toaster));
+    ASSERT_EQ(0, fleet.m_states[StateValue::TOASTING].node->data->calls);
+    ASSERT_EQ(0, fleet.m_states[StateValue::HEATING].node->data->calls);
+    ASSERT_EQ(4, fleet.m_states[StateValue::ROOT].node->data->calls);
+}
+
+TEST(MachineArray, TestStateOfAnotherTreeIsRejected)
+{
+    Fleet                  fleet(1, 1);
+    tree<ToasterState_ptr> other;
+    auto                   head = other.set_head(std::make_shared<ToasterState>(nullptr));
+    ASSERT_THROW(fleet.m_machines->stateIndex(head), std::out_of_range);
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "ThreadSafeQueue/PaddedThreadSafeQueue.hpp"
+
+namespace
+{
+struct Flags
+{
+    CachePadded<std::atomic_bool> stop{false};
+    CachePadded<int>              counter{0};
+};
+}  // namespace
+
+TEST(PaddedThreadSafeQueueTest, TestFifoAndPrioritized)
+{
+    PaddedThreadSafeQueue<std::shared_ptr<int>> queue;
+    queue.put(std::make_shared<int>(1));
+    queue.put(std::make_shared<int>(2));
+    queue.put_prioritized(std::make_shared<int>(0));
+    ASSERT_EQ(3u, queue.size());
+    ASSERT_EQ(3u, queue.snapshot().size());
+
+    for (int i = 0; i < 3; i++)
+        ASSERT_EQ(i, *queue.wait_and_pop());
+    ASSERT_TRUE(queue.empty());
+    ASSERT_EQ(0u, queue.size());
+}
+
+TEST(PaddedThreadSafeQueueTest, TestWaitAndPopForTimeout)
+{
+    PaddedThreadSafeQueue<std::shared_ptr<int>> queue;
+    auto                                        before = std::chrono::steady_clock::now();
+    ASSERT_EQ(nullptr, queue.wait_and_pop_for(std::chrono::milliseconds(50)));
+    ASSERT_GE(std::chrono::steady_clock::now() - before, std::chrono::milliseconds(50));
+}
+
+TEST(PaddedThreadSafeQueueTest, TestManyProducersKeepTheirOrder)
+{
+    constexpr int              PRODUCERS = 4;
+    constexpr int              EVENTS    = 2000;
+    PaddedThreadSafeQueue<int> queue;
+    std::vector<std::thread>   producers;
+    for (int p = 0; p < PRODUCERS; p++)
+    {
+        producers.emplace_back(
+            [&queue, p]()
+            {
+                for (int i = 0; i < EVENTS; i++)
+                    queue.put(p * EVENTS + i);
+            });
+    }
+
+    std::vector<int> next(PRODUCERS, 0);
+    for (int i = 0; i < PRODUCERS * EVENTS; i++)
+    {
+        int value = queue.wait_and_pop();
+        ASSERT_EQ(next[value / EVENTS]++, value % EVENTS);
+    }
+    for (auto& producer : producers)
+        producer.join();
+    ASSERT_TRUE(queue.empty());
+}
+
+TEST(PaddedThreadSafeQueueTest, TestPaddedFieldsDoNotShareCacheLines)
+{
+    ASSERT_EQ(CACHE_LINE, alignof(PaddedThreadSafeQueue<int>));
+    ASSERT_EQ(0u, sizeof(PaddedThreadSafeQueue<int>) % CACHE_LINE);
+
+    auto flags   = std::make_unique<Flags>();
+    auto stop    = reinterpret_cast<std::uintptr_t>(&*flags->stop);
+    auto counter = reinterpret_cast<std::uintptr_t>(&*flags->counter);
+    ASSERT_NE(stop / CACHE_LINE, counter / CACHE_LINE);
+    ASSERT_TRUE(isolatedLayout<CachePadded<char>>);
+}
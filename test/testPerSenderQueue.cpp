@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "ThreadSafeQueue/PerSenderQueue.hpp"
+
+TEST(PerSenderQueueTest, TestPrioritizedGoFirst)
+{
+    PerSenderQueue<std::shared_ptr<int>> queue;
+    queue.put(std::make_shared<int>(1));
+    queue.put(std::make_shared<int>(2));
+    queue.put_prioritized(std::make_shared<int>(0));
+    // The last prioritized goes first, as in SimplestThreadSafeQueue
+    queue.put_prioritized(std::make_shared<int>(-1));
+    ASSERT_EQ(4u, queue.size());
+    ASSERT_EQ(4u, queue.snapshot().size());
+    ASSERT_EQ(1u, queue.senders());
+
+    for (int i = -1; i < 3; i++)
+        ASSERT_EQ(i, *queue.wait_and_pop());
+    ASSERT_TRUE(queue.empty());
+}
+
+TEST(PerSenderQueueTest, TestWaitAndPopForTimeout)
+{
+    PerSenderQueue<std::shared_ptr<int>> queue;
+    auto                                 before = std::chrono::steady_clock::now();
+    ASSERT_EQ(nullptr, queue.wait_and_pop_for(std::chrono::milliseconds(50)));
+    ASSERT_GE(std::chrono::steady_clock::now() - before, std::chrono::milliseconds(50));
+}
+
+TEST(PerSenderQueueTest, TestSendersAreServedInTurn)
+{
+    PerSenderQueue<int> queue;
+    // Many segments' worth from this thread, then a few from another one
+    const int EVENTS = 3 * PerSenderQueue<int>::SEGMENT_CAPACITY;
+    for (int i = 0; i < EVENTS; i++)
+        queue.put(i);
+    std::thread(
+        [&queue]()
+        {
+            queue.put(-1);
+            queue.put(-2);
+        })
+        .join();
+    ASSERT_EQ(2u, queue.senders());
+
+    std::vector<int> expected{0, -1, 1, -2, 2};
+    for (int value : expected)
+        ASSERT_EQ(value, queue.wait_and_pop());
+
+    std::vector<int> left = queue.snapshot();
+    ASSERT_EQ(std::size_t(EVENTS - 3), left.size());
+    for (int i = 0; i < EVENTS - 3; i++)
+        ASSERT_EQ(i + 3, left[i]);
+
+    queue.clear();
+    ASSERT_TRUE(queue.empty());
+    // The lanes are kept, and their drained segments reused
+    for (int i = 0; i < EVENTS; i++)
+        queue.put(i);
+    for (int i = 0; i < EVENTS; i++)
+        ASSERT_EQ(i, queue.wait_and_pop());
+}
+
+TEST(PerSenderQueueTest, TestManyProducersKeepTheirOrder)
+{
+    constexpr int            PRODUCERS = 8;
+    constexpr int            EVENTS    = 5000;
+    PerSenderQueue<int>      queue;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; p++)
+    {
+        producers.emplace_back(
+            [&queue, p]()
+            {
+                for (int i = 0; i < EVENTS; i++)
+                    queue.put(p * EVENTS + i);
+            });
+    }
+
+    std::vector<int> next(PRODUCERS, 0);
+    for (int i = 0; i < PRODUCERS * EVENTS; i++)
+    {
+        int value = queue.wait_and_pop();
+        ASSERT_EQ(next[value / EVENTS]++, value % EVENTS);
+    }
+    for (auto& producer : producers)
+        producer.join();
+    ASSERT_TRUE(queue.empty());
+    // The lanes of the exited producers are dropped once drained, by the next pop at the latest
+    ASSERT_FALSE(queue.try_pop(next[0]));
+    ASSERT_EQ(0u, queue.senders());
+}
+
+TEST(PerSenderQueueTest, TestLaneOfExitedProducerIsDroppedOnceDrained)
+{
+    PerSenderQueue<int> queue;
+    std::thread(
+        [&queue]()
+        {
+            for (int i = 0; i < 3; i++)
+                queue.put(i);
+        })
+        .join();
+    ASSERT_EQ(1u, queue.senders());
+    for (int i = 0; i < 3; i++)
+        ASSERT_EQ(i, queue.wait_and_pop());
+    ASSERT_EQ(0u, queue.size());
+    ASSERT_TRUE(queue.empty());
+    int element;
+    ASSERT_FALSE(queue.try_pop(element));
+    ASSERT_EQ(0u, queue.senders());
+}
+
+TEST(PerSenderQueueTest, TestMakeMailbox)
+{
+    auto total      = makeMailbox<std::shared_ptr<int>>(Ordering::Total);
+    auto per_sender = makeMailbox<std::shared_ptr<int>>(Ordering::PerSender);
+    ASSERT_NE(nullptr, dynamic_cast<SimplestThreadSafeQueue<std::shared_ptr<int>>*>(total.get()));
+    ASSERT_NE(nullptr, dynamic_cast<PerSenderQueue<std::shared_ptr<int>>*>(per_sender.get()));
+
+    // A queue created where a destroyed one lived does not get its lanes
+    for (int i = 0; i < 3; i++)
+    {
+        auto queue = makeMailbox<std::shared_ptr<int>>(Ordering::PerSender);
+        queue->put(std::make_shared<int>(i));
+        ASSERT_EQ(1u, queue->size());
+        ASSERT_EQ(i, *queue->wait_and_pop());
+    }
+}
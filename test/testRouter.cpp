@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "CoroutineExecutor/CoroutineExecutor.hpp"
+#include "Router/Router.hpp"
+
+namespace
+{
+class Keyed : public IEvent
+{
+   public:
+    Keyed(uint64_t key) : key{key}
+    {
+    }
+    uint64_t key;
+};
+
+// Records what it receives, its queue depth is set by the test
+class FakeActor
+{
+   public:
+    void callback_IEvent(IEvent_ptr event)
+    {
+        received.push_back(event);
+    }
+    std::size_t queueDepth() const
+    {
+        return depth;
+    }
+
+    std::vector<IEvent_ptr> received;
+    std::size_t             depth{0};
+};
+
+// Hosted on an EventLoop: its depth is read by the router from the sending thread
+class LoopActor
+{
+   public:
+    explicit LoopActor(EventLoop& loop) : m_mailbox{loop}
+    {
+    }
+    void callback_IEvent(IEvent_ptr event)
+    {
+        m_mailbox.put(std::move(event));
+    }
+    std::size_t queueDepth() const
+    {
+        return m_mailbox.size();
+    }
+
+   private:
+    Mailbox m_mailbox;
+};
+}  // namespace
+
+// Fixture definition
+class RouterFixture : public ::testing::Test
+{
+   protected:
+    RouterFixture() : m_actors(4)
+    {
+        for (auto& actor : m_actors)
+            m_pool.push_back(&actor);
+    }
+
+    std::vector<FakeActor>  m_actors;
+    std::vector<FakeActor*> m_pool;
+};
+
+TEST_F(RouterFixture, TestRoundRobin)
+{
+    Router<FakeActor> router(m_pool, RoutingPolicy::RoundRobin);
+    for (int i = 0; i < 8; i++)
+        router.callback_IEvent(std::make_shared<Keyed>(0));
+    for (auto& actor : m_actors)
+        ASSERT_EQ(2u, actor.received.size());
+}
+
+TEST_F(RouterFixture, TestLeastLoaded)
+{
+    Router<FakeActor> router(m_pool, RoutingPolicy::LeastLoaded);
+    m_actors[0].depth = 5;
+    m_actors[1].depth = 3;
+    m_actors[2].depth = 1;
+    m_actors[3].depth = 4;
+    for (int i = 0; i < 4; i++)
+        ASSERT_EQ(2u, router.select(nullptr));
+
+    // Ties are spread over the idle routees
+    for (auto& actor : m_actors)
+        actor.depth = 0;
+    std::set<std::size_t> chosen;
+    for (int i = 0; i < 4; i++)
+        chosen.insert(router.select(nullptr));
+    ASSERT_EQ(4u, chosen.size());
+}
+
+TEST_F(RouterFixture, TestConsistentHash)
+{
+    Router<FakeActor> router(m_pool, RoutingPolicy::ConsistentHash,
+                             [](const IEvent_ptr& event)
+                             { return std::static_pointer_cast<Keyed>(event)->key; });
+
+    std::map<uint64_t, std::size_t> owner;
+    std::vector<int>                load(m_actors.size(), 0);
+    for (uint64_t key = 0; key < 1000; key++)
+    {
+        owner[key] = router.select(std::make_shared<Keyed>(key));
+        load[owner[key]]++;
+    }
+    for (uint64_t key = 0; key < 1000; key++)
+        ASSERT_EQ(owner[key], router.select(std::make_shared<Keyed>(key)));
+    for (int count : load)
+        ASSERT_GT(count, 100);
+}
+
+TEST_F(RouterFixture, TestInvalidPoolsAreRejected)
+{
+    ASSERT_THROW(Router<FakeActor>({}, RoutingPolicy::RoundRobin), std::invalid_argument);
+    ASSERT_THROW(Router<FakeActor>(m_pool, RoutingPolicy::ConsistentHash), std::invalid_argument);
+}
+
+TEST(Router, TestLeastLoadedReadsEventLoopMailboxes)
+{
+    EventLoop               loop;
+    std::deque<LoopActor>   actors;  // Not movable
+    std::vector<LoopActor*> pool;
+    for (int i = 0; i < 3; i++)
+        pool.push_back(&actors.emplace_back(loop));
+    std::thread loop_thread([&]() { loop.run(); });
+
+    auto depth = [&]()
+    {
+        std::size_t total = 0;
+        for (auto& actor : actors)
+            total += actor.queueDepth();
+        return total;
+    };
+    Router<LoopActor> router(pool, RoutingPolicy::LeastLoaded);
+    for (std::size_t i = 1; i <= 6; i++)
+    {
+        router.callback_IEvent(std::make_shared<Keyed>(i));
+        // Delivered by the loop thread, nobody pops
+        while (depth() != i)
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    loop.stop();
+    loop_thread.join();
+
+    for (auto& actor : actors)
+        ASSERT_EQ(2u, actor.queueDepth());
+}
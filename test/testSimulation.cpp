@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Ask/Ask.hpp"
+#include "IState/IState.hpp"
+#include "Simulation/Simulation.hpp"
+#include "StateManager/StateManager.hpp"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+class DoToasting : public IEvent
+{
+   public:
+    explicit DoToasting(long timeout) : timeout{timeout}
+    {
+    }
+    long timeout;  // ms
+};
+class Timeout : public IEvent
+{
+};
+
+// Not handled by the toaster
+class GetCrumbs : public Request<int>
+{
+};
+
+class SimToaster;
+
+class ToasterState : public IState<SimToaster>
+{
+   public:
+    using IState<SimToaster>::IState;
+};
+
+class Toasting : public ToasterState
+{
+   public:
+    using ToasterState::ToasterState;
+    virtual int on_entry() override;
+    virtual int on_exit() override;
+};
+
+/* Toaster actor hosted on the simulation's loop, its toasting timer armed on the virtual clock */
+class SimToaster
+{
+   public:
+    using State_ptr = std::shared_ptr<ToasterState>;
+
+    SimToaster(Simulation& simulation)
+        : m_simulation{simulation},
+          m_mailbox{simulation.loop()},
+          m_timer{simulation.clock(), 0, [this]() { m_mailbox.put(std::make_shared<Timeout>()); }}
+    {
+        tree<State_ptr> states;
+        auto            root = states.set_head(std::make_shared<ToasterState>(this));
+        m_heating            = states.append_child(root, std::make_shared<ToasterState>(this));
+        m_toasting           = states.append_child(m_heating, std::make_shared<Toasting>(this));
+        m_state_manager = std::make_unique<StateManager<State_ptr>>(std::move(states), m_heating);
+
+        m_state_manager->addTransition<DoToasting>(
+            m_heating, m_toasting, [this](const IEvent_ptr& event)
+            { m_toasting_time = std::static_pointer_cast<DoToasting>(event)->timeout; });
+        m_state_manager->addTransition<Timeout>(
+            m_toasting, m_heating,
+            [this](const IEvent_ptr&) { m_pop_ups.push_back(m_simulation.clock().now()); });
+    }
+
+    void start()
+    {
+        m_task = run();
+        m_mailbox.loop().start(m_task);
+    }
+
+    void callback_IEvent(IEvent_ptr event)
+    {
+        m_mailbox.put(event);
+    }
+
+    Simulation&                              m_simulation;
+    Mailbox                                  m_mailbox;
+    DeadlineTimer                            m_timer;
+    long                                     m_toasting_time{0};
+    std::vector<Clock::t_time>               m_pop_ups;
+    std::unique_ptr<StateManager<State_ptr>> m_state_manager;
+    tree<State_ptr>::iterator                m_heating, m_toasting;
+
+   private:
+    Task run()
+    {
+        m_state_manager->init();
+        while (true)
+        {
+            IEvent_ptr current_event = co_await m_mailbox.pop();
+            m_state_manager->processEvent(current_event);
+        }
+    }
+
+    Task m_task;
+};
+
+int Toasting::on_entry()
+{
+    m_actor->m_timer.start(m_actor->m_toasting_time, false);
+    return 0;
+}
+
+int Toasting::on_exit()
+{
+    m_actor->m_timer.stop();
+    return 0;
+}
+}  // namespace
+
+TEST(Simulation, TestOneHourToastingInVirtualTime)
+{
+    Simulation simulation;
+    SimToaster toaster(simulation);
+    toaster.start();
+
+    auto begin = std::chrono::steady_clock::now();
+    toaster.callback_IEvent(std::make_shared<DoToasting>(3600 * 1000));
+    ASSERT_EQ(1u, simulation.run());
+    auto elapsed = std::chrono::steady_clock::now() - begin;
+
+    ASSERT_EQ((std::vector<Clock::t_time>{1h}), toaster.m_pop_ups);
+    ASSERT_EQ(toaster.m_heating, toaster.m_state_manager->currentState());
+    ASSERT_EQ(Clock::t_time{1h}, simulation.clock().now());
+    ASSERT_LT(elapsed, 1s);
+}
+
+TEST(Simulation, TestTimerStoppedOnExit)
+{
+    Simulation simulation;
+    SimToaster toaster(simulation);
+    toaster.start();
+
+    toaster.callback_IEvent(std::make_shared<DoToasting>(60 * 1000));
+    simulation.runFor(30s);
+    ASSERT_EQ(1u, simulation.clock().pending());
+
+    // Leaving Toasting early stops its timer
+    toaster.callback_IEvent(std::make_shared<Timeout>());
+    simulation.run();
+    ASSERT_EQ(0u, simulation.clock().pending());
+    ASSERT_EQ((std::vector<Clock::t_time>{30s}), toaster.m_pop_ups);
+}
+
+TEST(Simulation, TestAskTimesOutInVirtualTime)
+{
+    Simulation simulation;
+    SimToaster toaster(simulation);
+    toaster.start();
+    Mailbox replies(simulation.loop());
+
+    auto future = ask(
+        simulation.clock(), [&](IEvent_ptr event) { toaster.callback_IEvent(event); },
+        std::make_shared<GetCrumbs>(), std::chrono::milliseconds(10 * 60 * 1000));
+    future.then_post([&](IEvent_ptr event) { replies.put(event); });
+
+    simulation.runFor(9min);
+    ASSERT_EQ(AskStatus::pending, future.status());
+    ASSERT_EQ(1u, simulation.run());
+    ASSERT_EQ(AskStatus::timeout, future.status());
+    ASSERT_EQ(Clock::t_time{10min}, simulation.clock().now());
+    ASSERT_EQ((std::vector<IEvent_ptr>{future.request()}), replies.snapshot());
+}
+
+TEST(Simulation, TestReplyCancelsAskTimeout)
+{
+    Simulation simulation;
+    auto       future = ask(
+        simulation.clock(), [](IEvent_ptr) {}, std::make_shared<GetCrumbs>(),
+        std::chrono::milliseconds(1000));
+    ASSERT_EQ(1u, simulation.clock().pending());
+
+    ASSERT_TRUE(future.request()->reply(3));
+    ASSERT_EQ(0u, simulation.clock().pending());
+    ASSERT_EQ(0u, simulation.run());
+    ASSERT_EQ(3, future.get().value());
+}
+
+TEST(Simulation, TestCyclicTimersInterleaveDeterministically)
+{
+    Simulation               simulation;
+    std::vector<std::string> trace;
+    DeadlineTimer            fast(simulation.clock(), 10, [&]() { trace.push_back("fast"); }, true);
+    DeadlineTimer            slow(simulation.clock(), 25, [&]() { trace.push_back("slow"); }, true);
+    fast.start();
+    slow.start();
+
+    // Both are due at 50ms: 'slow' was scheduled first (at 25ms, 'fast' at 40ms)
+    ASSERT_EQ(7u, simulation.runFor(50ms));
+    ASSERT_EQ((std::vector<std::string>{"fast", "fast", "slow", "fast", "fast", "slow", "fast"}),
+              trace);
+    ASSERT_EQ(Clock::t_time{50ms}, simulation.clock().now());
+
+    fast.stop();
+    slow.stop();
+    ASSERT_EQ(0u, simulation.run());
+}
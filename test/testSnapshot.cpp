@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Snapshot/Snapshot.hpp"
+#include "ThreadSafeQueue/ThreadSafeQueue.hpp"
+
+namespace
+{
+class Tick : public IEvent
+{
+   public:
+    Tick(uint32_t count) : count{count}
+    {
+    }
+    uint32_t count;
+};
+
+// Counts its entry/exit actions
+class CountingState
+{
+   public:
+    int on_entry()
+    {
+        entries++;
+        return 0;
+    }
+    int on_exit()
+    {
+        exits++;
+        return 0;
+    }
+    int process_event(IEvent_ptr event)
+    {
+        (void) event;
+        return -1;
+    }
+
+    int entries{0};
+    int exits{0};
+};
+
+using CountingState_ptr = std::shared_ptr<CountingState>;
+using t_iterator        = tree<CountingState_ptr>::iterator;
+
+Snapshot::EventCodec tickCodec()
+{
+    Snapshot::EventCodec codec;
+    codec.encode = [](const IEvent_ptr& event, std::vector<uint8_t>& blob)
+    {
+        auto tick = std::dynamic_pointer_cast<Tick>(event);
+        if (!tick)
+            return false;
+        auto* bytes = reinterpret_cast<const uint8_t*>(&tick->count);
+        blob.insert(blob.end(), bytes, bytes + sizeof(tick->count));
+        return true;
+    };
+    codec.decode = [](const uint8_t* data, std::size_t size) -> IEvent_ptr
+    {
+        uint32_t count;
+        if (size != sizeof(count))
+            return nullptr;
+        std::memcpy(&count, data, sizeof(count));
+        return std::make_shared<Tick>(count);
+    };
+    return codec;
+}
+}  // namespace
+
+// Fixture definition
+class SnapshotFixture : public ::testing::Test
+{
+   protected:
+    /**
+     *  root
+     *  ├── A
+     *  │   ├── B
+     *  │   └── C
+     *  └── D
+     */
+    std::unique_ptr<StateManager<CountingState_ptr>> makeManager()
+    {
+        tree<CountingState_ptr> tree;
+        m_states.clear();
+        m_states.push_back(tree.set_head(std::make_shared<CountingState>()));
+        m_states.push_back(tree.append_child(m_states[0], std::make_shared<CountingState>()));
+        m_states.push_back(tree.append_child(m_states[1], std::make_shared<CountingState>()));
+        m_states.push_back(tree.append_child(m_states[1], std::make_shared<CountingState>()));
+        m_states.push_back(tree.append_child(m_states[0], std::make_shared<CountingState>()));
+        auto initial = m_states[2];
+        return std::make_unique<StateManager<CountingState_ptr>>(std::move(tree), initial);
+    }
+
+    int entries()
+    {
+        int total = 0;
+        for (auto& state : m_states)
+            total += state.node->data->entries;
+        return total;
+    }
+
+    std::vector<t_iterator> m_states;
+};
+
+TEST_F(SnapshotFixture, TestRestoreConfigurationWithoutEntryActions)
+{
+    auto original = makeManager();
+    original->init();
+    original->transitionTo(m_states[3]);  // C
+    original->transitionTo(m_states[4]);  // D
+    auto blob = Snapshot::checkpoint(*original, {}, tickCodec());
+
+    auto                    restored = makeManager();
+    std::vector<IEvent_ptr> pending;
+    ASSERT_TRUE(Snapshot::restore(*restored, blob.data(), blob.size(), tickCodec(), pending));
+    ASSERT_EQ(0, entries());
+    ASSERT_EQ(4u, restored->stateIndex(restored->currentState()));
+    ASSERT_TRUE(pending.empty());
+
+    // History survives the restart
+    ASSERT_EQ(m_states[3], restored->history(m_states[1], History::Shallow));
+}
+
+TEST_F(SnapshotFixture, TestPendingEventsRoundTrip)
+{
+    SimplestThreadSafeQueue<IEvent_ptr> queue;
+    queue.put(std::make_shared<Tick>(1));
+    queue.put(std::make_shared<Tick>(2));
+
+    auto original = makeManager();
+    auto blob     = Snapshot::checkpoint(*original, queue.snapshot(), tickCodec());
+
+    auto                    restored = makeManager();
+    std::vector<IEvent_ptr> pending;
+    ASSERT_TRUE(Snapshot::restore(*restored, blob.data(), blob.size(), tickCodec(), pending));
+    ASSERT_EQ(2u, pending.size());
+    ASSERT_EQ(1u, std::static_pointer_cast<Tick>(pending[0])->count);
+    ASSERT_EQ(2u, std::static_pointer_cast<Tick>(pending[1])->count);
+}
+
+TEST_F(SnapshotFixture, TestInvalidBlobIsRejected)
+{
+    auto original = makeManager();
+    original->transitionTo(m_states[4]);
+    auto blob = Snapshot::checkpoint(*original, {std::make_shared<Tick>(7)}, tickCodec());
+
+    auto                    restored = makeManager();
+    std::vector<IEvent_ptr> pending;
+    for (std::size_t size = 0; size < blob.size(); size++)
+    {
+        ASSERT_FALSE(Snapshot::restore(*restored, blob.data(), size, tickCodec(), pending));
+    }
+    blob[0] ^= 0xFF;
+    ASSERT_FALSE(Snapshot::restore(*restored, blob.data(), blob.size(), tickCodec(), pending));
+    ASSERT_TRUE(pending.empty());
+    ASSERT_EQ(2u, restored->stateIndex(restored->currentState()));
+}
+
+TEST_F(SnapshotFixture, TestRestoreFromMappedFile)
+{
+    auto original = makeManager();
+    original->transitionTo(m_states[3]);
+    std::string path = testing::TempDir() + "snapshot_test.bin";
+    ASSERT_TRUE(Snapshot::writeFile(path, Snapshot::checkpoint(*original, {}, tickCodec())));
+
+    {
+        Snapshot::MappedFile    file(path);
+        auto                    restored = makeManager();
+        std::vector<IEvent_ptr> pending;
+        ASSERT_TRUE(file.valid());
+        ASSERT_TRUE(Snapshot::restore(*restored, file.data(), file.size(), tickCodec(), pending));
+        ASSERT_EQ(3u, restored->stateIndex(restored->currentState()));
+    }
+    std::remove(path.c_str());
+}
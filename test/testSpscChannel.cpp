@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "ThreadSafeQueue/SpscChannel.hpp"
+
+TEST(SpscChannel, TestFifoAndFull)
+{
+    SpscChannel<int> channel(4);
+    ASSERT_EQ(4u, channel.capacity());
+    for (int i = 0; i < 4; i++)
+        ASSERT_TRUE(channel.try_push(i));
+    ASSERT_FALSE(channel.try_push(4));
+    ASSERT_EQ(4u, channel.size());
+
+    int value;
+    for (int i = 0; i < 4; i++)
+    {
+        ASSERT_TRUE(channel.try_pop(value));
+        ASSERT_EQ(i, value);
+    }
+    ASSERT_FALSE(channel.try_pop(value));
+}
+
+TEST(SpscChannel, TestBatchPublish)
+{
+    SpscChannel<int> channel(8);
+    int              value;
+    for (int round = 0; round < 5; round++)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            int element = round * 3 + i;
+            ASSERT_TRUE(channel.write(element));
+        }
+        // Nothing visible before publish()
+        ASSERT_FALSE(channel.try_pop(value));
+        channel.publish();
+        for (int i = 0; i < 3; i++)
+        {
+            ASSERT_TRUE(channel.try_pop(value));
+            ASSERT_EQ(round * 3 + i, value);
+        }
+    }
+}
+
+TEST(SpscChannel, TestProducerThread)
+{
+    SpscChannel<std::shared_ptr<int>> channel(16);
+    const int                         count = 100000;
+    std::thread                       producer(
+        [&]()
+        {
+            for (int i = 0; i < count; i++)
+                channel.push(std::make_shared<int>(i));
+        });
+
+    std::shared_ptr<int> value;
+    for (int i = 0; i < count; i++)
+    {
+        while (!channel.try_pop(value))
+            std::this_thread::yield();
+        ASSERT_EQ(i, *value);
+    }
+    producer.join();
+}
+
+TEST(SpscChannel, TestInboxWaitsOnEverySource)
+{
+    Inbox<std::shared_ptr<int>> inbox;
+    auto&                       first  = inbox.connect(8);
+    auto&                       second = inbox.connect(8);
+    const int                   count  = 20000;
+
+    std::vector<std::thread> producers;
+    producers.emplace_back(
+        [&]()
+        {
+            for (int i = 0; i < count; i++)
+                first.push(std::make_shared<int>(i));
+        });
+    producers.emplace_back(
+        [&]()
+        {
+            for (int i = 0; i < count; i++)
+                second.push(std::make_shared<int>(count + i));
+        });
+    producers.emplace_back(
+        [&]()
+        {
+            for (int i = 0; i < count; i++)
+                inbox.put(std::make_shared<int>(2 * count + i));
+        });
+
+    // Elements of each source come out in order
+    std::vector<int> last{-1, count - 1, 2 * count - 1};
+    for (int i = 0; i < 3 * count; i++)
+    {
+        int value  = *inbox.wait_and_pop();
+        int source = value / count;
+        ASSERT_EQ(last[source] + 1, value);
+        last[source] = value;
+    }
+    for (auto& producer : producers)
+        producer.join();
+    ASSERT_EQ(nullptr, inbox.wait_and_pop_for(std::chrono::milliseconds(10)));
+}
@@ -0,0 +1,507 @@
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "StateManager/StateManager.hpp"
+
+namespace
+{
+class EvtA : public IEvent
+{
+};
+class EvtB : public IEvent
+{
+};
+class EvtC : public IEvent
+{
+};
+// With a dense event id
+class EvtR : public Event<EvtR>
+{
+};
+
+using Trace = std::vector<std::string>;
+
+// Records entry/exit actions and handled events into a shared trace
+class TraceState
+{
+   public:
+    TraceState(const std::string& name, Trace& trace) : m_name{name}, m_trace{trace}
+    {
+    }
+    int on_entry()
+    {
+        m_trace.push_back("+" + m_name);
+        return 0;
+    }
+    int on_exit()
+    {
+        m_trace.push_back("-" + m_name);
+        return 0;
+    }
+    int process_event(IEvent_ptr event)
+    {
+        m_calls++;
+        auto handler = m_handlers.find(event->getTypeHash());
+        if (handler == m_handlers.end())
+            return -1;
+        m_trace.push_back(m_name + ":handled");
+        if (handler->second)
+            handler->second();
+        return 0;
+    }
+
+    template <class E>
+    void handles(std::function<void()> action = nullptr)
+    {
+        m_handlers[typeid(E).hash_code()] = action;
+    }
+
+    // Number of process_event() calls
+    int calls() const
+    {
+        return m_calls;
+    }
+
+   private:
+    std::string                                  m_name;
+    Trace&                                       m_trace;
+    std::map<std::size_t, std::function<void()>> m_handlers;
+    int                                          m_calls{0};
+};
+
+using TraceState_ptr = std::shared_ptr<TraceState>;
+using t_iterator     = tree<TraceState_ptr>::iterator;
+}  // namespace
+
+// Fixture definition
+class StateManagerFixture : public ::testing::Test
+{
+   protected:
+    void setRoot()
+    {
+        m_state["root"] = std::make_shared<TraceState>("root", m_trace);
+        m_s["root"]     = m_tree.set_head(m_state["root"]);
+    }
+
+    t_iterator add(const std::string& name, t_iterator parent)
+    {
+        auto state    = std::make_shared<TraceState>(name, m_trace);
+        m_s[name]     = m_tree.append_child(parent, state);
+        m_state[name] = state;
+        return m_s[name];
+    }
+
+    /**
+     *  root
+     *  ├── A
+     *  │   ├── B
+     *  │   │   └── D
+     *  │   └── C
+     *  └── E
+     */
+    void buildHierarchy()
+    {
+        setRoot();
+        add("A", m_tree.begin());
+        add("B", m_s["A"]);
+        add("D", m_s["B"]);
+        add("C", m_s["A"]);
+        add("E", m_tree.begin());
+    }
+
+    /**
+     *  root
+     *  ├── Working (orthogonal)
+     *  │   ├── Heater (region)
+     *  │   │   ├── HeaterOff
+     *  │   │   └── HeaterOn
+     *  │   └── Lamp (region)
+     *  │       ├── LampOff
+     *  │       └── LampOn
+     *  └── Fault
+     */
+    void buildRegions()
+    {
+        setRoot();
+        add("Working", m_tree.begin());
+        add("Heater", m_s["Working"]);
+        add("HeaterOff", m_s["Heater"]);
+        add("HeaterOn", m_s["Heater"]);
+        add("Lamp", m_s["Working"]);
+        add("LampOff", m_s["Lamp"]);
+        add("LampOn", m_s["Lamp"]);
+        add("Fault", m_tree.begin());
+    }
+
+    void makeManager(const std::string& initial)
+    {
+        auto initial_state = m_s[initial];
+        m_sm = std::make_unique<StateManager<TraceState_ptr>>(std::move(m_tree), initial_state);
+    }
+
+    void transitionOn(const std::string& state, const std::string& target)
+    {
+        m_state[state]->handles<EvtA>([this, target]() { m_sm->requestTransition(m_s[target]); });
+    }
+
+    Trace                                         m_trace;
+    tree<TraceState_ptr>                          m_tree;
+    std::map<std::string, t_iterator>             m_s;
+    std::map<std::string, TraceState_ptr>         m_state;
+    std::unique_ptr<StateManager<TraceState_ptr>> m_sm;
+};
+
+TEST_F(StateManagerFixture, TestTransitionToSibling)
+{
+    buildHierarchy();
+    makeManager("D");
+    m_sm->transitionTo(m_s["C"]);
+    ASSERT_EQ((Trace{"-D", "-B", "+C"}), m_trace);
+    ASSERT_EQ(m_s["C"], m_sm->currentState());
+}
+
+TEST_F(StateManagerFixture, TestTransitionWithoutCommonAncestor)
+{
+    buildHierarchy();
+    makeManager("D");
+    m_sm->transitionTo(m_s["E"]);
+    ASSERT_EQ((Trace{"-D", "-B", "-A", "+E"}), m_trace);
+}
+
+TEST_F(StateManagerFixture, TestTransitionToAncestorAndDescendant)
+{
+    buildHierarchy();
+    makeManager("D");
+    m_sm->transitionTo(m_s["A"]);
+    ASSERT_EQ((Trace{"-D", "-B"}), m_trace);
+
+    m_trace.clear();
+    m_sm->transitionTo(m_s["D"]);
+    ASSERT_EQ((Trace{"+B", "+D"}), m_trace);
+}
+
+TEST_F(StateManagerFixture, TestSelfTransition)
+{
+    buildHierarchy();
+    makeManager("D");
+    m_sm->transitionTo(m_s["D"]);
+    ASSERT_EQ((Trace{"-D", "+D"}), m_trace);
+}
+
+TEST_F(StateManagerFixture, TestTransitionsByStateIndex)
+{
+    buildHierarchy();
+    makeManager("D");
+    std::size_t c = m_sm->stateIndex(m_s["C"]);
+    std::size_t a = m_sm->stateIndex(m_s["A"]);
+    m_sm->transitionTo(c);
+    ASSERT_EQ(m_s["C"], m_sm->currentState());
+    m_sm->transitionTo(m_s["E"]);
+
+    m_trace.clear();
+    m_sm->transitionToHistory(a, History::Shallow);
+    ASSERT_EQ((Trace{"-E", "+A", "+C"}), m_trace);
+    ASSERT_EQ(0, m_sm->requestTransition(c));
+    ASSERT_EQ((Trace{"-E", "+A", "+C", "-C", "+C"}), m_trace);
+}
+
+TEST_F(StateManagerFixture, TestEventBubblesToHandlingAncestor)
+{
+    buildHierarchy();
+    m_state["A"]->handles<EvtA>();
+    m_state["root"]->handles<EvtB>();
+    makeManager("D");
+
+    m_sm->processEvent(std::make_shared<EvtA>());
+    ASSERT_EQ((Trace{"A:handled"}), m_trace);
+
+    m_trace.clear();
+    m_sm->processEvent(std::make_shared<EvtB>());
+    ASSERT_EQ((Trace{"root:handled"}), m_trace);
+}
+
+TEST_F(StateManagerFixture, TestRequestTransitionFromHandler)
+{
+    buildHierarchy();
+    transitionOn("A", "E");
+    makeManager("D");
+
+    m_sm->processEvent(std::make_shared<EvtA>());
+    ASSERT_EQ((Trace{"A:handled", "-D", "-B", "-A", "+E"}), m_trace);
+    ASSERT_EQ(m_s["E"], m_sm->currentState());
+}
+
+TEST_F(StateManagerFixture, TestInitEntersEveryRegion)
+{
+    buildRegions();
+    makeManager("HeaterOff");
+    m_sm->setOrthogonal(m_s["Working"]);
+    m_sm->init();
+
+    ASSERT_EQ((Trace{"+HeaterOff", "+Lamp"}), m_trace);
+    ASSERT_EQ((std::vector<t_iterator>{m_s["HeaterOff"], m_s["Lamp"]}), m_sm->activeStates());
+}
+
+TEST_F(StateManagerFixture, TestEnteringOrthogonalStateEntersRegions)
+{
+    buildRegions();
+    makeManager("Fault");
+    m_sm->setOrthogonal(m_s["Working"]);
+    m_sm->init();
+
+    m_trace.clear();
+    m_sm->transitionTo(m_s["HeaterOn"]);
+    ASSERT_EQ((Trace{"-Fault", "+Working", "+Heater", "+HeaterOn", "+Lamp"}), m_trace);
+    ASSERT_EQ((std::vector<t_iterator>{m_s["HeaterOn"], m_s["Lamp"]}), m_sm->activeStates());
+    ASSERT_TRUE(m_sm->isActive(m_s["Working"]));
+    ASSERT_FALSE(m_sm->isActive(m_s["Fault"]));
+}
+
+TEST_F(StateManagerFixture, TestOneEventTransitionsEveryRegion)
+{
+    buildRegions();
+    transitionOn("HeaterOn", "HeaterOff");
+    transitionOn("LampOff", "LampOn");
+    m_state["Working"]->handles<EvtA>();
+    makeManager("Fault");
+    m_sm->setOrthogonal(m_s["Working"]);
+    m_sm->init();
+    m_sm->transitionTo(m_s["HeaterOn"]);
+    m_sm->transitionTo(m_s["LampOff"]);
+
+    m_trace.clear();
+    m_sm->processEvent(std::make_shared<EvtA>());
+    ASSERT_EQ((Trace{"HeaterOn:handled", "LampOff:handled", "-HeaterOn", "+HeaterOff", "-LampOff",
+                     "+LampOn"}),
+              m_trace);
+    ASSERT_EQ((std::vector<t_iterator>{m_s["HeaterOff"], m_s["LampOn"]}), m_sm->activeStates());
+}
+
+TEST_F(StateManagerFixture, TestUnhandledByRegionsReachesOrthogonalState)
+{
+    buildRegions();
+    m_state["HeaterOn"]->handles<EvtB>();
+    m_state["Working"]->handles<EvtB>([this]() { m_sm->requestTransition(m_s["Fault"]); });
+    m_state["Working"]->handles<EvtC>([this]() { m_sm->requestTransition(m_s["Fault"]); });
+    makeManager("HeaterOn");
+    m_sm->setOrthogonal(m_s["Working"]);
+    m_sm->init();
+
+    // Handled by one region: the orthogonal state does not see it
+    m_trace.clear();
+    m_sm->processEvent(std::make_shared<EvtB>());
+    ASSERT_EQ((Trace{"HeaterOn:handled"}), m_trace);
+
+    // Handled by none of the regions: bubbles to the orthogonal state, which exits every region
+    m_trace.clear();
+    m_sm->processEvent(std::make_shared<EvtC>());
+    ASSERT_EQ((Trace{"Working:handled", "-HeaterOn", "-Lamp", "-Heater", "-Working", "+Fault"}),
+              m_trace);
+    ASSERT_EQ((std::vector<t_iterator>{m_s["Fault"]}), m_sm->activeStates());
+}
+
+TEST_F(StateManagerFixture, TestShallowHistory)
+{
+    buildHierarchy();
+    makeManager("D");
+    m_sm->transitionTo(m_s["E"]);
+
+    m_trace.clear();
+    m_sm->transitionToHistory(m_s["A"], History::Shallow);
+    ASSERT_EQ((Trace{"-E", "+A", "+B"}), m_trace);
+    ASSERT_EQ(m_s["B"], m_sm->currentState());
+}
+
+TEST_F(StateManagerFixture, TestDeepHistory)
+{
+    buildHierarchy();
+    makeManager("D");
+    m_sm->transitionTo(m_s["E"]);
+
+    m_trace.clear();
+    m_sm->transitionToHistory(m_s["A"], History::Deep);
+    ASSERT_EQ((Trace{"-E", "+A", "+B", "+D"}), m_trace);
+    ASSERT_EQ(m_s["D"], m_sm->currentState());
+}
+
+TEST_F(StateManagerFixture, TestHistoryWithoutPreviousVisit)
+{
+    buildHierarchy();
+    makeManager("D");
+    ASSERT_EQ(m_s["E"], m_sm->history(m_s["E"], History::Deep));
+
+    m_sm->transitionToHistory(m_s["E"], History::Deep);
+    ASSERT_EQ(m_s["E"], m_sm->currentState());
+}
+
+TEST_F(StateManagerFixture, TestHistoryForgottenWhenExitedWithoutActiveChild)
+{
+    buildHierarchy();
+    makeManager("D");
+    m_sm->transitionTo(m_s["B"]);
+    m_sm->transitionTo(m_s["E"]);
+
+    m_trace.clear();
+    m_sm->transitionToHistory(m_s["B"], History::Deep);
+    ASSERT_EQ((Trace{"-E", "+A", "+B"}), m_trace);
+}
+
+TEST_F(StateManagerFixture, TestRequestTransitionToHistoryFromHandler)
+{
+    buildHierarchy();
+    m_state["E"]->handles<EvtA>([this]() { m_sm->requestTransitionToHistory(m_s["A"]); });
+    makeManager("C");
+    m_sm->transitionTo(m_s["E"]);
+
+    m_trace.clear();
+    m_sm->processEvent(std::make_shared<EvtA>());
+    ASSERT_EQ((Trace{"E:handled", "-E", "+A", "+C"}), m_trace);
+}
+
+TEST_F(StateManagerFixture, TestDeepHistoryRestoresEveryRegion)
+{
+    buildRegions();
+    makeManager("Fault");
+    m_sm->setOrthogonal(m_s["Working"]);
+    m_sm->init();
+    m_sm->transitionTo(m_s["HeaterOn"]);
+    m_sm->transitionTo(m_s["LampOn"]);
+    m_sm->transitionTo(m_s["Fault"]);
+
+    m_trace.clear();
+    m_sm->transitionToHistory(m_s["Working"], History::Deep);
+    ASSERT_EQ((Trace{"-Fault", "+Working", "+Heater", "+HeaterOn", "+Lamp", "+LampOn"}), m_trace);
+    ASSERT_EQ((std::vector<t_iterator>{m_s["HeaterOn"], m_s["LampOn"]}), m_sm->activeStates());
+}
+
+TEST_F(StateManagerFixture, TestTransitionActionRunsAtCommonAncestor)
+{
+    buildHierarchy();
+    makeManager("D");
+    m_sm->transitionTo(m_s["C"], [this](const IEvent_ptr&) { m_trace.push_back("action"); });
+    ASSERT_EQ((Trace{"-D", "-B", "action", "+C"}), m_trace);
+
+    m_trace.clear();
+    m_sm->transitionTo(m_s["C"], [this](const IEvent_ptr&) { m_trace.push_back("action"); });
+    ASSERT_EQ((Trace{"-C", "action", "+C"}), m_trace);
+}
+
+TEST_F(StateManagerFixture, TestRequestTransitionWithActionFromHandler)
+{
+    buildHierarchy();
+    IEvent_ptr seen;
+    m_state["B"]->handles<EvtA>(
+        [this, &seen]()
+        {
+            m_sm->requestTransition(m_s["E"],
+                                    [this, &seen](const IEvent_ptr& event)
+                                    {
+                                        seen = event;
+                                        m_trace.push_back("action");
+                                    });
+        });
+    makeManager("D");
+
+    auto event = std::make_shared<EvtA>();
+    m_sm->processEvent(event);
+    ASSERT_EQ((Trace{"B:handled", "-D", "-B", "-A", "action", "+E"}), m_trace);
+    ASSERT_EQ(event, seen);
+}
+
+TEST_F(StateManagerFixture, TestTransitionTable)
+{
+    buildHierarchy();
+    bool allowed = false;
+    m_state["A"]->handles<EvtA>();
+    makeManager("D");
+    m_sm->addTransition<EvtA>(
+        m_s["A"], m_s["E"], [this](const IEvent_ptr&) { m_trace.push_back("action"); },
+        [&allowed](const IEvent_ptr&) { return allowed; });
+
+    // Guard rejects the event: the state's own handler gets it
+    m_sm->processEvent(std::make_shared<EvtA>());
+    ASSERT_EQ((Trace{"A:handled"}), m_trace);
+    ASSERT_EQ(m_s["D"], m_sm->currentState());
+
+    m_trace.clear();
+    allowed = true;
+    m_sm->processEvent(std::make_shared<EvtA>());
+    ASSERT_EQ((Trace{"-D", "-B", "-A", "action", "+E"}), m_trace);
+    ASSERT_EQ(m_s["E"], m_sm->currentState());
+}
+
+TEST_F(StateManagerFixture, TestTransitionTableInRegion)
+{
+    buildRegions();
+    makeManager("HeaterOff");
+    m_sm->setOrthogonal(m_s["Working"]);
+    m_sm->addTransition<EvtA>(m_s["LampOff"], m_s["LampOn"],
+                              [this](const IEvent_ptr&) { m_trace.push_back("action"); });
+    m_sm->init();
+    m_sm->transitionTo(m_s["LampOff"]);
+
+    m_trace.clear();
+    m_sm->processEvent(std::make_shared<EvtA>());
+    ASSERT_EQ((Trace{"-LampOff", "action", "+LampOn"}), m_trace);
+    ASSERT_EQ((std::vector<t_iterator>{m_s["HeaterOff"], m_s["LampOn"]}), m_sm->activeStates());
+}
+
+TEST_F(StateManagerFixture, TestEventSkipsDeclaredNonHandlers)
+{
+    buildHierarchy();
+    m_state["root"]->handles<EvtR>();
+    makeManager("D");
+    m_sm->declareHandled<>(m_s["D"]);
+    m_sm->declareHandled<EvtB>(m_s["A"]);
+
+    // B has no declaration, so it still gets the event
+    m_sm->processEvent(std::make_shared<EvtR>());
+    ASSERT_EQ((Trace{"root:handled"}), m_trace);
+    ASSERT_EQ(0, m_state["D"]->calls());
+    ASSERT_EQ(1, m_state["B"]->calls());
+    ASSERT_EQ(0, m_state["A"]->calls());
+    ASSERT_EQ(1, m_state["root"]->calls());
+
+    // Same again, from the cached route
+    m_sm->processEvent(std::make_shared<EvtR>());
+    ASSERT_EQ(0, m_state["D"]->calls());
+    ASSERT_EQ(2, m_state["root"]->calls());
+}
+
+TEST_F(StateManagerFixture, TestEventWithoutIdVisitsEveryState)
+{
+    buildHierarchy();
+    m_state["root"]->handles<EvtA>();
+    makeManager("D");
+    m_sm->declareHandled<>(m_s["D"]);
+    m_sm->declareHandled<>(m_s["A"]);
+
+    m_sm->processEvent(std::make_shared<EvtA>());
+    ASSERT_EQ((Trace{"root:handled"}), m_trace);
+    ASSERT_EQ(1, m_state["D"]->calls());
+    ASSERT_EQ(1, m_state["A"]->calls());
+}
+
+TEST_F(StateManagerFixture, TestDeclaredStateKeepsTableRows)
+{
+    buildHierarchy();
+    makeManager("D");
+    for (auto name : {"root", "A", "B", "D"})
+        m_sm->declareHandled<>(m_s[name]);
+
+    // Nobody handles it: no state is called at all
+    m_sm->processEvent(std::make_shared<EvtR>());
+    ASSERT_TRUE(m_trace.empty());
+    ASSERT_EQ(0, m_state["root"]->calls());
+
+    // Declared after the route was cached
+    m_sm->addTransition<EvtR>(m_s["A"], m_s["E"]);
+    m_sm->processEvent(std::make_shared<EvtR>());
+    ASSERT_EQ((Trace{"-D", "-B", "-A", "+E"}), m_trace);
+    ASSERT_EQ(0, m_state["A"]->calls());
+}
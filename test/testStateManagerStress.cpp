@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "StateManagerStress.hpp"
+
+using namespace Stress;
+
+TEST(StateManagerStress, TestModelOfSimpleTransitions)
+{
+    //  0
+    //  ├── 1
+    //  │   ├── 3
+    //  │   └── 4
+    //  └── 2
+    std::vector<uint32_t> parent{NO_NODE, 0, 0, 1, 1};
+    ASSERT_EQ((Trace{-4, -2, ACTION, 3}), expectedTrace(parent, 3, 2));
+    ASSERT_EQ((Trace{-4, ACTION, 5}), expectedTrace(parent, 3, 4));
+    ASSERT_EQ((Trace{-4, ACTION}), expectedTrace(parent, 3, 1));
+    ASSERT_EQ((Trace{ACTION, 4}), expectedTrace(parent, 1, 3));
+    ASSERT_EQ((Trace{-4, ACTION, 4}), expectedTrace(parent, 3, 3));
+    ASSERT_EQ((Trace{ACTION, 2, 5}), expectedTrace(parent, 0, 4));
+}
+
+TEST(StateManagerStress, TestRandomTransitionsMatchModel)
+{
+    for (unsigned seed = 1; seed <= 100; seed++)
+    {
+        std::mt19937 rng(seed);
+        Machine      machine(rng, 1 + seed % 6, 1 + seed % 4);
+        for (int i = 0; i < 200; i++)
+        {
+            uint32_t from   = machine.current();
+            uint32_t target = machine.randomNode(rng);
+            ASSERT_TRUE(machine.step(target, rng() % 2))
+                << "seed " << seed << ", step " << i << ": " << from << " -> " << target;
+        }
+    }
+}
@@ -0,0 +1,264 @@
+#include <gtest/gtest.h>
+
+#include <deque>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "StateManager/StateManager.hpp"
+#include "Supervisor/Supervisor.hpp"
+#include "ThreadSafeQueue/ThreadSafeQueue.hpp"
+
+namespace
+{
+class Move : public IEvent
+{
+};
+class Boom : public IEvent
+{
+};
+class Done : public IEvent
+{
+};
+
+class FaultyState
+{
+   public:
+    int on_entry()
+    {
+        if (m_failing_entry)
+            throw std::runtime_error("failed entry");
+        m_entries++;
+        return 0;
+    }
+    int on_exit()
+    {
+        return 0;
+    }
+    int process_event(IEvent_ptr event)
+    {
+        if (typeid(*event) == typeid(Boom))
+            throw std::runtime_error("boom");
+        return -1;
+    }
+
+    int  m_entries{0};
+    bool m_failing_entry{false};
+};
+using FaultyState_ptr = std::shared_ptr<FaultyState>;
+
+// root -> idle, busy. Move goes from idle to busy, Boom throws in any state
+class FaultyActor
+{
+   public:
+    FaultyActor()
+    {
+        tree<FaultyState_ptr> states;
+        auto                  root = states.set_head(std::make_shared<FaultyState>());
+        m_idle = states.append_child(root, std::make_shared<FaultyState>());
+        m_busy = states.append_child(root, std::make_shared<FaultyState>());
+        m_sm   = std::make_unique<StateManager<FaultyState_ptr>>(std::move(states), m_idle);
+        m_sm->addTransition<Move>(m_idle, m_busy);
+        m_sm->init();
+    }
+
+    // Direct calls stand for the actor's run loop
+    bool step(Supervisor::Child* child, IEvent_ptr event)
+    {
+        return child->step(*event, [&]() { m_sm->processEvent(event); });
+    }
+
+    void restart()
+    {
+        m_sm->restart(m_idle);
+    }
+
+    tree<FaultyState_ptr>::iterator                m_idle, m_busy;
+    std::unique_ptr<StateManager<FaultyState_ptr>> m_sm;
+};
+}  // namespace
+
+TEST(Supervisor, TestOneForOneRestartsOnTheActorThread)
+{
+    Supervisor  supervisor;
+    FaultyActor actor;
+    auto*       child = supervisor.supervise("actor", [&]() { actor.restart(); });
+
+    SimplestThreadSafeQueue<IEvent_ptr> mailbox;
+    std::vector<std::thread::id>        threads;
+
+    mailbox.put(std::make_shared<Move>());
+    mailbox.put(std::make_shared<Boom>());
+    mailbox.put(std::make_shared<Move>());  // Still delivered after the restart
+    mailbox.put(std::make_shared<Done>());
+    std::thread run_loop(
+        [&]()
+        {
+            IEvent_ptr event;
+            do
+            {
+                event = mailbox.wait_and_pop();
+                actor.step(child, event);
+                threads.push_back(std::this_thread::get_id());
+            } while (typeid(*event) != typeid(Done));
+        });
+    auto id = run_loop.get_id();
+    run_loop.join();
+
+    ASSERT_EQ((std::vector<std::thread::id>(4, id)), threads);
+    ASSERT_EQ(1u, child->restarts());
+    ASSERT_EQ(1u, supervisor.restarts());
+    ASSERT_EQ(actor.m_busy, actor.m_sm->currentState());
+    ASSERT_EQ(2, actor.m_idle.node->data->m_entries);  // init() and the restart
+    ASSERT_EQ(2, actor.m_busy.node->data->m_entries);
+}
+
+TEST(Supervisor, TestOneForAllRestartsSiblingsBeforeTheirNextStep)
+{
+    Supervisor  supervisor(Supervisor::Strategy::OneForAll);
+    FaultyActor a, b;
+    auto*       child_a = supervisor.supervise("a", [&]() { a.restart(); });
+    auto*       child_b = supervisor.supervise("b", [&]() { b.restart(); });
+
+    ASSERT_TRUE(b.step(child_b, std::make_shared<Move>()));
+    ASSERT_FALSE(a.step(child_a, std::make_shared<Boom>()));
+    ASSERT_EQ(1u, child_a->restarts());
+    ASSERT_EQ(0u, child_b->restarts());
+    ASSERT_EQ(b.m_busy, b.m_sm->currentState());
+
+    ASSERT_TRUE(b.step(child_b, std::make_shared<Done>()));
+    ASSERT_EQ(1u, child_b->restarts());
+    ASSERT_EQ(b.m_idle, b.m_sm->currentState());
+}
+
+TEST(Supervisor, TestTooManyRestartsEscalate)
+{
+    VirtualClock                     clock;
+    std::vector<Supervisor::Failure> escalated;
+    Supervisor                       supervisor(
+        Supervisor::Strategy::OneForOne, {2, std::chrono::seconds{1}},
+        [&](const Supervisor::Failure& failure) { escalated.push_back(failure); }, &clock);
+    FaultyActor actor;
+    auto*       child = supervisor.supervise("actor", [&]() { actor.restart(); });
+
+    actor.step(child, std::make_shared<Boom>());
+    clock.advanceBy(std::chrono::milliseconds{600});
+    actor.step(child, std::make_shared<Boom>());
+    ASSERT_TRUE(escalated.empty());
+    ASSERT_EQ(2u, child->restarts());
+
+    // The first restart is still within the period
+    actor.step(child, std::make_shared<Boom>());
+    ASSERT_EQ(1u, escalated.size());
+    ASSERT_EQ("actor", escalated[0].child);
+    ASSERT_EQ("boom", escalated[0].what);
+    ASSERT_NE(std::string::npos, escalated[0].event.find("Boom"));
+    ASSERT_EQ(2u, child->restarts());
+
+    // A supervisor that gave up starts counting afresh
+    clock.advanceBy(std::chrono::seconds{2});
+    actor.step(child, std::make_shared<Boom>());
+    ASSERT_EQ(1u, escalated.size());
+    ASSERT_EQ(3u, child->restarts());
+}
+
+TEST(Supervisor, TestNestedSupervisorRestartsAsOneChild)
+{
+    std::vector<Supervisor::Failure> escalated;
+    Supervisor                       root(Supervisor::Strategy::OneForOne,
+                                          Supervisor::DEFAULT_INTENSITY,
+                                          [&](const Supervisor::Failure& failure)
+                                          { escalated.push_back(failure); });
+    Supervisor  nested(root, "nested", Supervisor::Strategy::OneForOne,
+                       {1, std::chrono::hours{1}});
+    FaultyActor a, b;
+    auto*       child_a = nested.supervise("a", [&]() { a.restart(); });
+    auto*       child_b = nested.supervise("b", [&]() { b.restart(); });
+
+    b.step(child_b, std::make_shared<Move>());
+    a.step(child_a, std::make_shared<Boom>());
+    ASSERT_EQ(1u, nested.restarts());
+    ASSERT_EQ(0u, root.restarts());
+    ASSERT_EQ(0u, child_b->restarts());
+
+    // Over the nested intensity: the root restarts the whole subtree
+    a.step(child_a, std::make_shared<Boom>());
+    ASSERT_EQ(1u, root.restarts());
+    ASSERT_EQ(2u, child_a->restarts());
+    ASSERT_EQ(b.m_busy, b.m_sm->currentState());
+    b.step(child_b, std::make_shared<Done>());
+    ASSERT_EQ(1u, child_b->restarts());
+    ASSERT_EQ(b.m_idle, b.m_sm->currentState());
+    ASSERT_TRUE(escalated.empty());
+}
+
+TEST(Supervisor, TestRestartDestroysContinuations)
+{
+    Supervisor  supervisor;
+    FaultyActor actor;
+    auto*       child = supervisor.supervise("actor", [&]() { actor.restart(); });
+
+    std::deque<IEvent_ptr> mailbox;
+    actor.m_sm->setMailbox([&](IEvent_ptr event) { mailbox.push_back(event); });
+
+    auto failing = [&]() -> Continuation
+    {
+        co_await actor.m_sm->yield();
+        throw std::runtime_error("failed continuation");
+    };
+    auto waiting = [&]() -> Continuation { co_await actor.m_sm->nextEvent<Done>(); };
+    actor.m_sm->spawn(actor.m_idle, waiting());
+    actor.m_sm->spawn(actor.m_idle, failing());
+    ASSERT_EQ(2u, actor.m_sm->continuations());
+
+    ASSERT_FALSE(actor.step(child, mailbox.front()));
+    ASSERT_EQ(1u, child->restarts());
+    ASSERT_EQ(0u, actor.m_sm->continuations());
+    ASSERT_EQ(actor.m_idle, actor.m_sm->currentState());
+}
+
+TEST(Supervisor, TestFailedRestartIsAFailure)
+{
+    Supervisor  supervisor(Supervisor::Strategy::OneForOne, {10, std::chrono::hours{1}});
+    FaultyActor actor;
+    auto*       child = supervisor.supervise("actor", [&]() { actor.restart(); });
+
+    actor.m_idle.node->data->m_failing_entry = true;
+    ASSERT_FALSE(actor.step(child, std::make_shared<Boom>()));
+    ASSERT_EQ(2u, supervisor.restarts());  // After the step, then after the failed restart
+
+    // The restart is tried again before the next step
+    actor.m_idle.node->data->m_failing_entry = false;
+    ASSERT_TRUE(actor.step(child, std::make_shared<Move>()));
+    ASSERT_EQ(2u, child->restarts());
+    ASSERT_EQ(actor.m_busy, actor.m_sm->currentState());
+}
+
+TEST(Supervisor, TestFailedStepWithoutRestartLeavesTheStateManagerUsable)
+{
+    std::vector<Supervisor::Failure> escalated;
+    Supervisor                       supervisor(
+        Supervisor::Strategy::OneForOne, {0, std::chrono::seconds{1}},
+        [&](const Supervisor::Failure& failure) { escalated.push_back(failure); });
+    FaultyActor actor;
+    auto*       child = supervisor.supervise("actor", [&]() { actor.restart(); });
+
+    std::deque<IEvent_ptr> mailbox;
+    actor.m_sm->setMailbox([&](IEvent_ptr event) { mailbox.push_back(event); });
+    auto failing = [&]() -> Continuation
+    {
+        co_await actor.m_sm->yield();
+        throw std::runtime_error("failed continuation");
+    };
+    actor.m_sm->spawn(actor.m_idle, failing());
+
+    ASSERT_FALSE(actor.step(child, mailbox.front()));
+    ASSERT_EQ(1u, escalated.size());
+    ASSERT_EQ(0u, child->restarts());
+    ASSERT_EQ(0u, actor.m_sm->continuations());
+
+    ASSERT_TRUE(actor.step(child, std::make_shared<Move>()));
+    ASSERT_EQ(actor.m_busy, actor.m_sm->currentState());
+}
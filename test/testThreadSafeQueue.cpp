@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+
+#include "ThreadSafeQueue/ThreadSafeQueue.hpp"
+
+// Fixture definition
+class ThreadSafeQueueFixture : public ::testing::Test
+{
+   protected:
+    ThreadSafeQueueFixture()
+    {
+        // You can do set-up work for each test here.
+    }
+
+    ~ThreadSafeQueueFixture()
+    {
+        // You can do clean-up work that doesn't throw exceptions here.
+    }
+
+    SimplestThreadSafeQueue<std::shared_ptr<int>> m_queue;
+};
+
+TEST_F(ThreadSafeQueueFixture, TestFifoOrder)
+{
+    m_queue.put(std::make_shared<int>(1));
+    m_queue.put(std::make_shared<int>(2));
+    m_queue.put(std::make_shared<int>(3));
+    ASSERT_EQ(3u, m_queue.size());
+
+    ASSERT_EQ(1, *m_queue.wait_and_pop());
+    ASSERT_EQ(2, *m_queue.wait_and_pop());
+    ASSERT_EQ(3, *m_queue.wait_and_pop());
+    ASSERT_TRUE(m_queue.empty());
+}
+
+TEST_F(ThreadSafeQueueFixture, TestPutPrioritized)
+{
+    m_queue.put(std::make_shared<int>(1));
+    m_queue.put_prioritized(std::make_shared<int>(2));
+
+    ASSERT_EQ(2, *m_queue.wait_and_pop());
+    ASSERT_EQ(1, *m_queue.wait_and_pop());
+}
+
+TEST_F(ThreadSafeQueueFixture, TestWaitAndPopForTimeout)
+{
+    auto before = std::chrono::steady_clock::now();
+    ASSERT_EQ(nullptr, m_queue.wait_and_pop_for(std::chrono::milliseconds(50)));
+    ASSERT_GE(std::chrono::steady_clock::now() - before, std::chrono::milliseconds(50));
+}
+
+TEST_F(ThreadSafeQueueFixture, TestWaitAndPopFromOtherThread)
+{
+    std::thread producer(
+        [&]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            m_queue.put(std::make_shared<int>(42));
+        });
+
+    ASSERT_EQ(42, *m_queue.wait_and_pop());
+    producer.join();
+}
+
+TEST_F(ThreadSafeQueueFixture, TestClear)
+{
+    m_queue.put(std::make_shared<int>(1));
+    m_queue.put(std::make_shared<int>(2));
+    ASSERT_FALSE(m_queue.empty());
+
+    m_queue.clear();
+    ASSERT_TRUE(m_queue.empty());
+}
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "StateManager/StateManager.hpp"
+#include "Topic/Topic.hpp"
+
+namespace
+{
+class Start : public Event<Start>
+{
+};
+class Stop : public Event<Stop>
+{
+};
+class Untyped : public IEvent
+{
+};
+
+class QuietState
+{
+   public:
+    int on_entry()
+    {
+        return 0;
+    }
+    int on_exit()
+    {
+        return 0;
+    }
+    int process_event(IEvent_ptr)
+    {
+        return 0;
+    }
+};
+using QuietState_ptr = std::shared_ptr<QuietState>;
+}  // namespace
+
+TEST(TopicTest, TestFilterAcceptsOnlyItsTypes)
+{
+    EventFilter filter = EventFilter::of<Start>();
+    ASSERT_TRUE(filter.accepts<Start>());
+    ASSERT_FALSE(filter.accepts<Stop>());
+    // Events without a dense id cannot be told apart
+    ASSERT_TRUE(filter.accepts(0));
+
+    filter.add(eventId<Stop>());
+    filter.remove(eventId<Start>());
+    ASSERT_FALSE(filter.accepts<Start>());
+    ASSERT_TRUE(filter.accepts<Stop>());
+    ASSERT_TRUE(EventFilter::all().accepts<Start>());
+}
+
+TEST(TopicTest, TestPublishSkipsFilteredSubscriptions)
+{
+    Topic                   topic;
+    std::vector<IEvent_ptr> starts, everything;
+    auto                    only_start = topic.subscribe([&](IEvent_ptr event)
+                                                         { starts.push_back(event); },
+                                                         EventFilter::of<Start>());
+    topic.subscribe([&](IEvent_ptr event) { everything.push_back(event); });
+
+    ASSERT_EQ(2u, topic.publish(std::make_shared<Start>()));
+    ASSERT_EQ(1u, topic.publish(std::make_shared<Stop>()));
+    ASSERT_EQ(2u, topic.publish(std::make_shared<Untyped>()));
+    ASSERT_EQ(2u, starts.size());
+    ASSERT_EQ(3u, everything.size());
+    ASSERT_EQ(1u, only_start->filtered());
+    ASSERT_EQ(1u, topic.filtered());
+
+    topic.unsubscribe(only_start);
+    ASSERT_EQ(1u, topic.size());
+    ASSERT_EQ(1u, topic.publish(std::make_shared<Start>()));
+    ASSERT_EQ(2u, starts.size());
+}
+
+TEST(TopicTest, TestSubscriptionFollowsStateConfiguration)
+{
+    tree<QuietState_ptr> states;
+    auto                 root    = states.set_head(std::make_shared<QuietState>());
+    auto                 idle    = states.append_child(root, std::make_shared<QuietState>());
+    auto                 running = states.append_child(root, std::make_shared<QuietState>());
+
+    StateManager<QuietState_ptr> manager(std::move(states), idle);
+    manager.declareHandled<>(root);
+    manager.addTransition<Start>(idle, running);
+    manager.addTransition<Stop>(running, idle);
+    manager.declareHandled<>(idle);
+    manager.declareHandled<>(running);
+
+    Topic topic;
+    int   received     = 0;
+    auto  subscription = topic.subscribe([&](IEvent_ptr event)
+                                        {
+                                            received++;
+                                            manager.processEvent(event);
+                                        });
+    Topic::follow(subscription, manager);
+    manager.init();
+
+    // Idle only takes Start
+    topic.publish(std::make_shared<Stop>());
+    ASSERT_EQ(0, received);
+    topic.publish(std::make_shared<Start>());
+    ASSERT_EQ(running, manager.currentState());
+    // Running only takes Stop
+    topic.publish(std::make_shared<Start>());
+    topic.publish(std::make_shared<Stop>());
+    ASSERT_EQ(idle, manager.currentState());
+    ASSERT_EQ(2, received);
+    ASSERT_EQ(2u, topic.filtered());
+}
+
+TEST(TopicTest, TestManySubscriptionsFollowOneManager)
+{
+    tree<QuietState_ptr> states;
+    auto                 root    = states.set_head(std::make_shared<QuietState>());
+    auto                 idle    = states.append_child(root, std::make_shared<QuietState>());
+    auto                 running = states.append_child(root, std::make_shared<QuietState>());
+
+    StateManager<QuietState_ptr> manager(std::move(states), idle);
+    manager.addTransition<Start>(idle, running);
+    manager.addTransition<Stop>(running, idle);
+    manager.declareHandled<>(root);
+    manager.declareHandled<>(idle);
+    manager.declareHandled<>(running);
+    manager.init();
+
+    Topic topic;
+    auto  first    = topic.subscribe([](IEvent_ptr) {});
+    auto  second   = topic.subscribe([](IEvent_ptr) {});
+    auto  id       = Topic::follow(first, manager);
+    int   notified = 0;
+    manager.onConfigurationChange(
+        [&]()
+        {
+            // Removing a listener while they are called
+            if (++notified == 1)
+                manager.removeConfigurationListener(id);
+        });
+    Topic::follow(second, manager);
+
+    manager.transitionTo(running);
+    ASSERT_TRUE(first->filter().accepts<Stop>());
+    ASSERT_TRUE(second->filter().accepts<Stop>());
+
+    // 'first' stopped following
+    manager.transitionTo(idle);
+    ASSERT_EQ(2, notified);
+    ASSERT_TRUE(first->filter().accepts<Stop>());
+    ASSERT_FALSE(second->filter().accepts<Stop>());
+    ASSERT_TRUE(second->filter().accepts<Start>());
+}
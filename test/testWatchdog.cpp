@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "IEvent/IEvent.hpp"
+#include "Watchdog/Watchdog.hpp"
+
+namespace
+{
+class Tick : public IEvent
+{
+};
+
+class SlowState
+{
+};
+}  // namespace
+
+TEST(Watchdog, TestStalledStepReportedOnce)
+{
+    std::mutex                   mutex;
+    std::vector<Watchdog::Stall> stalls;
+    Watchdog                     watchdog(
+        std::chrono::milliseconds(20),
+        [&](const Watchdog::Stall& stall)
+        {
+            std::scoped_lock<std::mutex> lock(mutex);
+            stalls.push_back(stall);
+        },
+        std::chrono::milliseconds(5));
+    Watchdog::Probe* probe = watchdog.watch("ActorFoo");
+
+    {
+        IEvent_ptr     event = std::make_shared<Tick>();
+        Watchdog::Step step(probe, SlowState{}, *event);
+        std::this_thread::sleep_for(std::chrono::milliseconds(80));
+    }
+    watchdog.check();
+
+    std::scoped_lock<std::mutex> lock(mutex);
+    ASSERT_EQ(1u, stalls.size());
+    ASSERT_EQ(1u, watchdog.stalls());
+    ASSERT_EQ("ActorFoo", stalls[0].actor);
+    ASSERT_NE(std::string::npos, stalls[0].state.find("SlowState"));
+    ASSERT_NE(std::string::npos, stalls[0].event.find("Tick"));
+    ASSERT_GT(stalls[0].elapsed, std::chrono::milliseconds(20));
+}
+
+TEST(Watchdog, TestHistogramOfFastSteps)
+{
+    Watchdog         watchdog(std::chrono::milliseconds(50));
+    Watchdog::Probe* probe = watchdog.watch("ActorBar");
+    Tick             event;
+    for (int i = 0; i < 100; i++)
+        Watchdog::Step step(probe, SlowState{}, event);
+    {
+        Watchdog::Step step(probe, SlowState{}, event);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    watchdog.check();
+
+    auto histogram = watchdog.histogram();
+    ASSERT_EQ(101u, std::accumulate(histogram.begin(), histogram.end(), uint64_t(0)));
+    // The 2ms step lands in [1024, 2048) us or above
+    ASSERT_EQ(1u, std::accumulate(histogram.begin() + 11, histogram.end(), uint64_t(0)));
+    ASSERT_EQ(0u, watchdog.stalls());
+}
+
+TEST(Watchdog, TestStepWithoutProbe)
+{
+    Tick           event;
+    Watchdog::Step step(nullptr, SlowState{}, event);
+}
+
+TEST(Watchdog, TestReportMayUseTheWatchdog)
+{
+    Watchdog* self  = nullptr;
+    uint64_t  steps = 0;
+    Watchdog  watchdog(
+        std::chrono::milliseconds(1),
+        [&](const Watchdog::Stall&)
+        {
+            // Would deadlock if reported with the Watchdog's lock held
+            auto histogram = self->histogram();
+            steps          = std::accumulate(histogram.begin(), histogram.end(), uint64_t(0));
+        },
+        std::chrono::hours(1));
+    self                   = &watchdog;
+    Watchdog::Probe* probe = watchdog.watch("ActorBaz");
+
+    Tick           event;
+    Watchdog::Step step(probe, SlowState{}, event);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    watchdog.check();
+    ASSERT_EQ(1u, watchdog.stalls());
+    ASSERT_EQ(0u, steps);
+}
+
+TEST(Watchdog, TestNonPositiveBudgetIsRejected)
+{
+    ASSERT_THROW(Watchdog(std::chrono::nanoseconds{0}), std::invalid_argument);
+    ASSERT_THROW(Watchdog(std::chrono::milliseconds{-1}), std::invalid_argument);
+    // A tiny budget polls no faster than MIN_PERIOD
+    Watchdog watchdog(std::chrono::nanoseconds{1});
+    ASSERT_EQ(0u, watchdog.stalls());
+}